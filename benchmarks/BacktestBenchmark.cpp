@@ -0,0 +1,147 @@
+/**
+ * @file BacktestBenchmark.cpp
+ * @brief Measures how the parallel backtest scales with threads
+ *
+ * Captures MockOkxFeed streams of several instruments over several days to
+ * a temporary journal, with a single snapshot per instrument at the start as
+ * a connection that stays up would record, then backtests it with 1, 2, 4...
+ * threads up to the hardware thread count. Prints throughput and speedup per
+ * thread count. Checks that every report is identical to the single-threaded
+ * one, and that each frame was processed once, with no warm-up, however far
+ * the days are from the snapshot.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "MockOkxFeed.h"
+#include "core/BacktestRunner.h"
+#include "core/CaptureJournal.h"
+#include "core/JournalReader.h"
+#include <QTemporaryDir>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int INSTRUMENTS = 4;
+constexpr int DAYS = 4;
+constexpr int UPDATES_PER_DAY = 25000;
+constexpr int64_t FIRST_DAY_NS = 19723LL * 86400LL * 1000000000LL;  // 2024-01-01
+constexpr int64_t DAY_NS = 86400LL * 1000000000LL;
+constexpr uint64_t FRAMES = uint64_t(INSTRUMENTS) * (DAYS * UPDATES_PER_DAY + 1);
+
+/// Gives a MockOkxFeed frame another instrument
+std::string renamed(std::string frame, const std::string& symbol) {
+    static const std::string original = "BTC-USDT-SWAP";
+    frame.replace(frame.find(original), original.size(), symbol);
+    return frame;
+}
+
+bool sameStatistic(const RunningStatistic& a, const RunningStatistic& b) {
+    return a.count() == b.count() && a.mean() == b.mean() && a.variance() == b.variance() &&
+           a.min() == b.min() && a.max() == b.max();
+}
+
+bool sameCosts(const BacktestCosts& a, const BacktestCosts& b) {
+    return a.samples == b.samples && a.unfilled == b.unfilled &&
+           sameStatistic(a.slippage, b.slippage) && sameStatistic(a.marketImpact, b.marketImpact) &&
+           sameStatistic(a.modelImpact, b.modelImpact) && sameStatistic(a.fees, b.fees) &&
+           sameStatistic(a.totalCost, b.totalCost);
+}
+
+bool sameReport(const BacktestReport& a, const BacktestReport& b) {
+    if (a.runs.size() != b.runs.size() || a.frames != b.frames ||
+        a.warmupFrames != b.warmupFrames || !sameCosts(a.total, b.total)) {
+        return false;
+    }
+    for (size_t i = 0; i < a.runs.size(); ++i) {
+        if (a.runs[i].instrument != b.runs[i].instrument || a.runs[i].day != b.runs[i].day ||
+            a.runs[i].frames != b.runs[i].frames || !sameCosts(a.runs[i].costs, b.runs[i].costs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 1;
+    }
+
+    {
+        CaptureConfig config;
+        config.directory = directory.path();
+        config.maxFileBytes = 64LL * 1024 * 1024;
+        CaptureJournal journal(config);
+
+        std::vector<std::unique_ptr<MockOkxFeed>> feeds;
+        std::vector<std::string> symbols;
+        for (int i = 0; i < INSTRUMENTS; ++i) {
+            feeds.push_back(std::make_unique<MockOkxFeed>(100 + i));
+            symbols.push_back("SYM" + std::to_string(i) + "-USDT-SWAP");
+        }
+
+        int64_t spacingNs = DAY_NS / (UPDATES_PER_DAY * INSTRUMENTS + INSTRUMENTS);
+        for (int day = 0; day < DAYS; ++day) {
+            int64_t receiveTimeNs = FIRST_DAY_NS + day * DAY_NS;
+            for (int update = day == 0 ? -1 : 0; update < UPDATES_PER_DAY; ++update) {
+                for (int i = 0; i < INSTRUMENTS; ++i) {
+                    std::string frame = update < 0 ? feeds[i]->snapshot() : feeds[i]->nextUpdate();
+                    while (!journal.append(renamed(frame, symbols[i]), receiveTimeNs)) {
+                        std::this_thread::yield();
+                    }
+                    receiveTimeNs += spacingNs;
+                }
+            }
+        }
+    }
+
+    QStringList files = JournalReader::listFiles(directory.path());
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Journal: " << files.size() << " file(s), " << INSTRUMENTS << " instruments x "
+              << DAYS << " days" << std::endl;
+
+    BacktestConfig config;
+    config.sampleIntervalNs = 0;
+    BacktestReport baseline;
+    bool identical = true;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+        config.threadCount = threads;
+        BacktestRunner runner(config);
+        BacktestReport report = runner.run(files);
+        if (threads == 1) {
+            baseline = report;
+        } else {
+            identical = identical && sameReport(report, baseline);
+        }
+        std::cout << "  " << threads << " thread(s): " << report.runs.size() << " runs, "
+                  << report.frames << " frames (" << report.warmupFrames << " warm-up) in " << report.elapsedSeconds * 1e3 << " ms ("
+                  << static_cast<long>(report.framesPerSecond) << " frames/s, plan "
+                  << report.planSeconds * 1e3 << " ms), speedup "
+                  << baseline.elapsedSeconds / report.elapsedSeconds << "x, "
+                  << report.failedRuns << " failed" << std::endl;
+        if (threads == hardwareThreads) {
+            break;
+        }
+    }
+
+    std::cout << "Samples: " << baseline.total.samples << ", mean slippage "
+              << baseline.total.slippage.mean() * 1e4 << " bps, mean total cost "
+              << baseline.total.totalCost.mean() << std::endl;
+    bool readOnce = baseline.frames == FRAMES && baseline.warmupFrames == 0;
+    std::cout << "Reports identical across thread counts: " << (identical ? "yes" : "NO")
+              << ", each frame processed once: " << (readOnce ? "yes" : "NO") << std::endl;
+    return identical && readOnce && baseline.failedRuns == 0 ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file BookStoreBenchmark.cpp
+ * @brief Measures book store scan speed by depth and checks that books round trip
+ *
+ * Writes synthetic books of 0 to 400 levels per side, some one-sided or
+ * empty, into small blocks so that many books sit on a block boundary, once
+ * keeping every level and once with a writer limited to MAX_DEPTH levels.
+ * Scans both stores at several depths, printing books per second, and
+ * checks every scanned book against the top levels and times that were
+ * written. Also checks a time-range scan across a block boundary, and that
+ * index entries pointing before the first block or far past the last are
+ * rejected. Fails on any mismatch.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BookStore.h"
+#include "core/InstrumentRegistry.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int BOOKS = 20000;
+constexpr int MAX_LEVELS = 400;                             // Reaches every depth band
+constexpr std::size_t BLOCK_ROWS = 100;
+constexpr std::size_t MAX_DEPTH = 15;                       // Of the depth-limited writer
+constexpr int64_t SPACING_NS = 100000000;                   // 10 books a second
+constexpr int64_t FIRST_NS = 19723LL * 86400LL * 1000000000LL;  // 2024-01-01
+constexpr std::size_t DEPTHS[] = {0, 10, 15, 50, SIZE_MAX};
+
+std::vector<OrderBook> makeBooks() {
+    std::mt19937 random(19);
+    std::uniform_int_distribution<int> levelCount(0, MAX_LEVELS);
+    std::uniform_int_distribution<Ticks> gap(1, 3);
+    std::uniform_int_distribution<Lots> lots(1, 100000);
+    std::uniform_int_distribution<int64_t> latency(0, 5000000);
+
+    OrderBook book;
+    book.instrument = InstrumentRegistry::instance().intern("BENCH", "STORE-USDT");
+    book.spec = {FixedPointScale(0.1), FixedPointScale(0.001)};
+
+    std::vector<OrderBook> books;
+    books.reserve(BOOKS);
+    Ticks bidTicks = 500000;
+    for (int i = 0; i < BOOKS; ++i) {
+        bidTicks += static_cast<Ticks>(random() % 5) - 2;
+        // One-sided books at the first and last row of each block, and some empty ones
+        std::size_t asks = i % BLOCK_ROWS == 0 || i % 37 == 0 ? 0 : levelCount(random);
+        std::size_t bids = i % BLOCK_ROWS == BLOCK_ROWS - 1 || i % 37 == 0 ? 0 : levelCount(random);
+
+        book.asks.resize(asks);
+        Ticks price = bidTicks;
+        for (OrderBookLevel& level : book.asks) {
+            price += gap(random);
+            level = {price, lots(random)};
+        }
+        book.bids.resize(bids);
+        price = bidTicks + 1;
+        for (OrderBookLevel& level : book.bids) {
+            price -= gap(random);
+            level = {price, lots(random)};
+        }
+        book.exchangeTimeNs = FIRST_NS + i * SPACING_NS;
+        book.receiveTimeNs = book.exchangeTimeNs + latency(random);
+        books.push_back(book);
+    }
+    return books;
+}
+
+void writeStore(const QString& path, const std::vector<OrderBook>& books, std::size_t maxDepth) {
+    BookStoreWriter writer(path, maxDepth, BLOCK_ROWS);
+    for (const OrderBook& book : books) {
+        writer.append(book);
+    }
+    writer.close();
+}
+
+bool sameSide(const std::vector<OrderBookLevel>& read, const std::vector<OrderBookLevel>& written,
+              std::size_t levels) {
+    if (read.size() != std::min(written.size(), levels)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < read.size(); ++i) {
+        if (read[i].priceTicks != written[i].priceTicks ||
+            read[i].quantityLots != written[i].quantityLots) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameBook(const OrderBook& read, const OrderBook& written, std::size_t levels) {
+    return read.instrument == written.instrument && read.spec == written.spec &&
+           read.exchangeTimeNs == written.exchangeTimeNs &&
+           read.receiveTimeNs == written.receiveTimeNs &&
+           sameSide(read.asks, written.asks, levels) && sameSide(read.bids, written.bids, levels);
+}
+
+/**
+ * @brief Scans a store at each depth, printing throughput and counting mismatched books
+ */
+std::size_t checkStore(const QString& path, const std::vector<OrderBook>& books,
+                       std::size_t maxDepth) {
+    BookStoreReader store(path);
+    std::cout << (maxDepth == SIZE_MAX ? std::string("Every level")
+                                       : "Top " + std::to_string(maxDepth) + " levels")
+              << ": " << store.rowCount() << " books in " << store.blockCount() << " blocks, "
+              << QFileInfo(path).size() << " bytes" << std::endl;
+
+    std::size_t mismatches = store.rowCount() == books.size() ? 0 : 1;
+    for (std::size_t depth : DEPTHS) {
+        std::size_t levels = std::min(depth, maxDepth);
+        std::size_t row = 0;
+        std::size_t depthMismatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        store.scan(INT64_MIN, INT64_MAX, depth, [&](const OrderBook& book) {
+            if (row >= books.size() || !sameBook(book, books[row], levels)) {
+                ++depthMismatches;
+            }
+            ++row;
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        depthMismatches += row == books.size() ? 0 : 1;
+        mismatches += depthMismatches;
+        std::cout << "  depth " << (depth == SIZE_MAX ? std::string("all") : std::to_string(depth))
+                  << ": " << static_cast<long>(row / seconds) << " books/s, " << depthMismatches
+                  << " mismatched" << std::endl;
+    }
+
+    // A range that starts and ends inside blocks, crossing a boundary
+    const std::size_t first = BLOCK_ROWS - 5;
+    const std::size_t last = 2 * BLOCK_ROWS + 5;
+    std::size_t row = first;
+    store.scan(books[first].exchangeTimeNs, books[last].exchangeTimeNs, 10,
+               [&](const OrderBook& book) {
+        if (row >= last || !sameBook(book, books[row], std::min<std::size_t>(10, maxDepth))) {
+            ++mismatches;
+        }
+        ++row;
+    });
+    if (row != last) {
+        ++mismatches;
+    }
+    return mismatches;
+}
+
+/**
+ * @brief Whether scanning fails once the first index entry's block offset is replaced
+ *
+ * The footer's first field is the index offset, and an index entry's first
+ * field is its block offset.
+ */
+bool rejectsBlockOffset(const QString& path, const QString& copyPath, uint64_t offset) {
+    QFile source(path);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray bytes = source.readAll();
+    uint64_t indexOffset = 0;
+    std::memcpy(&indexOffset, bytes.constData() + bytes.size() - 32, sizeof(indexOffset));
+    std::memcpy(bytes.data() + indexOffset, &offset, sizeof(offset));
+
+    QFile copy(copyPath);
+    if (!copy.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        copy.write(bytes.constData(), bytes.size()) != bytes.size()) {
+        return false;
+    }
+    copy.close();
+
+    BookStoreReader store(copyPath);
+    try {
+        store.scan(INT64_MIN, INT64_MAX, SIZE_MAX, [](const OrderBook&) {});
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 1;
+    }
+    QString fullPath = directory.filePath("full.books");
+    QString topPath = directory.filePath("top.books");
+
+    std::vector<OrderBook> books = makeBooks();
+    writeStore(fullPath, books, 0);
+    writeStore(topPath, books, MAX_DEPTH);
+
+    std::size_t mismatches = checkStore(fullPath, books, SIZE_MAX) +
+                             checkStore(topPath, books, MAX_DEPTH);
+
+    QString corruptPath = directory.filePath("corrupt.books");
+    bool rejected = rejectsBlockOffset(fullPath, corruptPath, 0) &&
+                    rejectsBlockOffset(fullPath, corruptPath, UINT64_MAX - 8);
+    std::cout << "Mismatched books: " << mismatches << ", corrupt block offsets rejected: "
+              << (rejected ? "yes" : "NO") << std::endl;
+    return mismatches == 0 && rejected ? 0 : 1;
+}
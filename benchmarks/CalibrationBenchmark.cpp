@@ -0,0 +1,126 @@
+/**
+ * @file CalibrationBenchmark.cpp
+ * @brief Measures impact calibration throughput on 400-level books
+ *
+ * Writes a book store of synthetic 400-level books ten times a second: a
+ * random-walk mid with a one-tick spread and about one unit per level.
+ * Then calibrates it with 1, 2, 4... threads up to the hardware thread
+ * count. Prints books per second, the time a full day of such books would
+ * take, and the fitted sweep slope next to the one the synthetic depth
+ * implies. Fails unless the slope is within SLOPE_TOLERANCE of it and every
+ * thread count gives the same parameters.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BookStore.h"
+#include "core/InstrumentRegistry.h"
+#include "models/ImpactCalibrator.h"
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int BOOKS = 100000;
+constexpr int LEVELS = 400;
+constexpr int64_t SPACING_NS = 100000000;                   // 10 books a second
+constexpr int64_t FIRST_NS = 19723LL * 86400LL * 1000000000LL;  // 2024-01-01
+constexpr double TICK = 0.1;
+constexpr double LOT = 0.001;
+constexpr Lots LEVEL_LOTS = 1000;                           // One unit per level
+constexpr double SLOPE_TOLERANCE = 0.01;                    // Relative, on the sweep slope
+
+bool sameParameters(const ImpactCalibration& a, const ImpactCalibration& b) {
+    return a.parameters.volatility == b.parameters.volatility &&
+           a.parameters.permanentImpact == b.parameters.permanentImpact &&
+           a.parameters.temporaryImpact == b.parameters.temporaryImpact &&
+           a.spreadCost == b.spreadCost && a.books == b.books && a.sweeps == b.sweeps;
+}
+
+} // namespace
+
+int main() {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::cerr << "Cannot create a temporary directory" << std::endl;
+        return 1;
+    }
+    QString path = directory.filePath("calibration.books");
+
+    {
+        BookStoreWriter writer(path);
+        std::mt19937 random(11);
+        std::uniform_int_distribution<Lots> touchLots(LEVEL_LOTS / 2, LEVEL_LOTS * 3 / 2);
+        OrderBook book;
+        book.instrument = InstrumentRegistry::instance().intern("BENCH", "CAL-USDT");
+        book.spec = {FixedPointScale(TICK), FixedPointScale(LOT)};
+        book.asks.resize(LEVELS);
+        book.bids.resize(LEVELS);
+
+        Ticks bidTicks = 500000;  // 50000.0
+        for (int i = 0; i < BOOKS; ++i) {
+            int move = static_cast<int>(random() % 5);
+            bidTicks += move == 0 ? -1 : move == 1 ? 1 : 0;
+            for (int level = 0; level < LEVELS; ++level) {
+                book.bids[level] = {bidTicks - level, LEVEL_LOTS};
+                book.asks[level] = {bidTicks + 1 + level, LEVEL_LOTS};
+            }
+            book.bids[0].quantityLots = touchLots(random);
+            book.asks[0].quantityLots = touchLots(random);
+            book.exchangeTimeNs = FIRST_NS + i * SPACING_NS;
+            book.receiveTimeNs = book.exchangeTimeNs;
+            writer.append(book);
+        }
+        writer.close();
+    }
+
+    BookStoreReader store(path);
+    std::cout << store.rowCount() << " books of " << LEVELS << " levels in "
+              << store.blockCount() << " blocks" << std::endl;
+
+    CalibrationConfig config;
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    ImpactCalibration baseline;
+    bool identical = true;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+        config.threadCount = threads;
+        ImpactCalibration result = ImpactCalibrator(config).calibrate(store);
+        if (threads == 1) {
+            baseline = result;
+        } else {
+            identical = identical && sameParameters(result, baseline);
+        }
+        double booksPerSecond = result.books / result.elapsedSeconds;
+        std::cout << "  " << threads << " thread(s): " << static_cast<long>(booksPerSecond)
+                  << " books/s, " << result.sweeps << " sweeps, a day of books in "
+                  << 864000.0 / booksPerSecond << " s, speedup "
+                  << baseline.elapsedSeconds / result.elapsedSeconds << "x" << std::endl;
+        if (threads == hardwareThreads) {
+            break;
+        }
+    }
+
+    // A quantity q fills q / unit levels at one tick each: slope TICK / 2 per unit
+    double fittedSlope = baseline.parameters.temporaryImpact *
+                         static_cast<double>(config.timeUnitNs) / config.tradeIntervalNs;
+    double impliedSlope = TICK / 2.0;
+    bool slopeMatches = std::abs(fittedSlope - impliedSlope) <= SLOPE_TOLERANCE * impliedSlope;
+    std::cout << "Sweep slope " << fittedSlope << " (depth implies " << impliedSlope
+              << (slopeMatches ? "" : ", OFF BY TOO MUCH") << "), spread cost "
+              << baseline.spreadCost << ", R2 " << baseline.temporaryRSquared << std::endl;
+    std::cout << "Volatility " << baseline.relativeVolatility << " per day ("
+              << baseline.parameters.volatility << " absolute), permanent impact "
+              << baseline.parameters.permanentImpact << ", R2 " << baseline.permanentRSquared
+              << std::endl;
+    std::cout << "Parameters identical across thread counts: " << (identical ? "yes" : "NO")
+              << std::endl;
+    return identical && slopeMatches ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file FeeScheduleBenchmark.cpp
+ * @brief Compares per-order and batched fee evaluation over a mixed basket
+ *
+ * Loads the shipped fee configuration and prices a basket of orders spread
+ * over every exchange, product and tier, once through FeeCalculator, which
+ * must select each order's tier by name and volume, and once through
+ * FeeSchedule::calculateFees() on pre-resolved queries. Prints the cost per
+ * order of both and checks that the fees agree.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/FeeCalculator.h"
+#include "core/FeeSchedule.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int BASKET = 10000;
+constexpr int REPEATS = 200;
+
+/// An order as a per-order caller holds it: names and a volume
+struct NamedOrder {
+    std::string exchange;
+    std::string product;
+    double volume;
+    double size;
+    bool isMaker;
+};
+
+double nanosecondsPerOrder(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(elapsed) / (static_cast<double>(BASKET) * REPEATS);
+}
+
+} // namespace
+
+int main() {
+    auto schedule = std::make_shared<const FeeSchedule>(FeeSchedule::loadFile(GOQUANT_FEE_CONFIG));
+
+    std::mt19937 random(7);
+    std::vector<NamedOrder> named;
+    std::vector<FeeQuery> queries;
+    named.reserve(BASKET);
+    queries.reserve(BASKET);
+    for (int i = 0; i < BASKET; ++i) {
+        auto id = static_cast<FeeScheduleId>(random() % schedule->scheduleCount());
+        auto tier = static_cast<std::uint32_t>(random() % schedule->tierCount(id));
+        double size = 100.0 + random() % 100000;
+        bool isMaker = random() % 2 == 0;
+        named.push_back({schedule->exchange(id), schedule->product(id),
+                         schedule->minVolume(id, tier), size, isMaker});
+        queries.push_back({id, tier, size, isMaker});
+    }
+
+    std::vector<double> perOrder(BASKET);
+    FeeCalculator calculator(schedule);
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        for (int i = 0; i < BASKET; ++i) {
+            const NamedOrder& order = named[i];
+            calculator.setFeeTier(order.exchange, order.volume, order.product);
+            perOrder[i] = calculator.calculateFees(order.size, order.isMaker);
+        }
+    }
+    double perOrderNs = nanosecondsPerOrder(start);
+
+    std::vector<double> batched(BASKET);
+    start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        schedule->calculateFees(queries.data(), queries.size(), batched.data());
+    }
+    double batchedNs = nanosecondsPerOrder(start);
+
+    bool matches = true;
+    for (int i = 0; i < BASKET; ++i) {
+        matches = matches && perOrder[i] == batched[i];
+    }
+
+    std::cout << "Basket of " << BASKET << " orders over " << schedule->scheduleCount()
+              << " schedules" << std::endl;
+    std::cout << "  FeeCalculator per order: " << perOrderNs << " ns/order" << std::endl;
+    std::cout << "  FeeSchedule batch:       " << batchedNs << " ns/order ("
+              << perOrderNs / batchedNs << "x)" << std::endl;
+    std::cout << "Fees match: " << (matches ? "yes" : "NO") << std::endl;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file FrontierBenchmark.cpp
+ * @brief Measures how the efficient-frontier sweep scales with threads
+ *
+ * Evaluates a grid of risk aversions, horizons and order sizes the way it
+ * was done before EfficientFrontier: one AlmgrenChriss per point, its
+ * optimal trajectory summed into expected cost and variance, plus
+ * calculateTotalCost. Then sweeps the same grid with EfficientFrontier on
+ * 1, 2, 4... threads up to the hardware thread count. Prints points per
+ * second and speedup.
+ *
+ * Checks that every sweep matches the point-by-point values, that all
+ * thread counts give identical results, and that sampled points match the
+ * Almgren-Chriss closed form evaluated independently here.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "models/EfficientFrontier.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int RISK_AVERSIONS = 256;
+constexpr int HORIZONS = 16;
+constexpr int SIZES = 64;
+constexpr int STEPS = 200;
+constexpr double PRICE = 100.0;
+constexpr std::size_t REFERENCE_STRIDE = 997;   // Closed-form check of every n-th point
+constexpr double TOLERANCE = 1e-9;              // Relative, for differently ordered sums
+
+/// @p count values from @p low to @p high, evenly spaced in log scale
+std::vector<double> logSpace(double low, double high, int count) {
+    std::vector<double> values(count);
+    for (int i = 0; i < count; ++i) {
+        values[i] = low * std::pow(high / low, static_cast<double>(i) / (count - 1));
+    }
+    return values;
+}
+
+/// True if @p a and @p b agree to @p tolerance relative to the larger
+bool close(double a, double b, double tolerance) {
+    return std::abs(a - b) <= tolerance * std::max(std::abs(a), std::abs(b));
+}
+
+/**
+ * @brief Expected cost and variance of selling @p size, from the paper's formulas
+ *
+ * x_j = X sinh(kappa (T - t_j)) / sinh(kappa T), with kappa solving
+ * 2 (cosh(kappa tau) - 1) = kappa~^2 tau^2, then
+ * E = gamma X^2 / 2 + (eta~ / tau) sum n_j^2 and V = sigma^2 tau sum x_j^2.
+ */
+FrontierPoint closedForm(const AlmgrenChriss::Parameters& params, double size, int steps) {
+    double tau = params.timeHorizon / steps;
+    double adjustedImpact = params.temporaryImpact - 0.5 * params.permanentImpact * tau;
+    double kappaTilde2 = params.riskAversion * params.volatility * params.volatility /
+                         adjustedImpact;
+    double kappa = std::acosh(1.0 + 0.5 * kappaTilde2 * tau * tau) / tau;
+
+    FrontierPoint point{};
+    point.expectedCost = 0.5 * params.permanentImpact * size * size;
+    double previous = size;
+    for (int j = 1; j <= steps; ++j) {
+        double holding = size * std::sinh(kappa * (params.timeHorizon - j * tau)) /
+                         std::sinh(kappa * params.timeHorizon);
+        double trade = previous - holding;
+        point.expectedCost += adjustedImpact / tau * trade * trade;
+        point.variance += params.volatility * params.volatility * tau * holding * holding;
+        previous = holding;
+    }
+    return point;
+}
+
+} // namespace
+
+int main() {
+    FrontierGrid grid;
+    grid.model = {0.3, 2.5e-7, 2.5e-6, 1e-6, 1.0};
+    grid.riskAversions = logSpace(1e-8, 1e-3, RISK_AVERSIONS);
+    grid.timeHorizons = logSpace(0.25, 5.0, HORIZONS);
+    grid.orderSizes = logSpace(1e3, 1e6, SIZES);
+    grid.numSteps = STEPS;
+    const double points = static_cast<double>(RISK_AVERSIONS) * HORIZONS * SIZES;
+
+    // Point by point: a model and a trajectory per grid point
+    std::vector<FrontierPoint> expected;
+    expected.reserve(static_cast<std::size_t>(points));
+    double totalCosts = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (double horizon : grid.timeHorizons) {
+        for (double size : grid.orderSizes) {
+            for (double riskAversion : grid.riskAversions) {
+                AlmgrenChriss::Parameters params = grid.model;
+                params.timeHorizon = horizon;
+                params.riskAversion = riskAversion;
+                AlmgrenChriss model(params);
+                std::vector<double> holdings = model.calculateOptimalTrajectory(size, 0.0, STEPS);
+                totalCosts += model.calculateTotalCost(size, PRICE, horizon);
+
+                double tau = horizon / STEPS;
+                double adjustedImpact = params.temporaryImpact - 0.5 * params.permanentImpact * tau;
+                FrontierPoint point{};
+                point.expectedCost = 0.5 * params.permanentImpact * size * size;
+                for (int j = 1; j <= STEPS; ++j) {
+                    double trade = holdings[j - 1] - holdings[j];
+                    point.expectedCost += adjustedImpact / tau * trade * trade;
+                    point.variance += params.volatility * params.volatility * tau *
+                                      holdings[j] * holdings[j];
+                }
+                expected.push_back(point);
+            }
+        }
+    }
+    double serialSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << RISK_AVERSIONS << " risk aversions x " << HORIZONS << " horizons x " << SIZES
+              << " sizes, " << STEPS << " steps" << std::endl;
+    std::cout << "  point by point: " << static_cast<long>(points / serialSeconds)
+              << " points/s (total cost checksum " << totalCosts << ")" << std::endl;
+
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    bool matches = true;
+    bool identical = true;
+    FrontierResult baseline;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+        EfficientFrontier frontier(threads);
+        FrontierResult result = frontier.compute(grid);
+        for (std::size_t i = 0; i < result.points.size(); ++i) {
+            matches = matches &&
+                      close(result.points[i].expectedCost, expected[i].expectedCost, TOLERANCE) &&
+                      close(result.points[i].variance, expected[i].variance, TOLERANCE);
+        }
+        if (threads == 1) {
+            baseline = result;
+        } else {
+            for (std::size_t i = 0; i < result.points.size(); ++i) {
+                identical = identical &&
+                            result.points[i].expectedCost == baseline.points[i].expectedCost &&
+                            result.points[i].variance == baseline.points[i].variance;
+            }
+        }
+        std::cout << "  frontier, " << threads << " thread(s): "
+                  << static_cast<long>(points / result.elapsedSeconds) << " points/s, "
+                  << serialSeconds / result.elapsedSeconds << "x point by point, speedup "
+                  << baseline.elapsedSeconds / result.elapsedSeconds << "x" << std::endl;
+        if (threads == hardwareThreads) {
+            break;
+        }
+    }
+
+    // Independent check against the closed form, on a spread of points
+    double worstError = 0.0;
+    std::size_t references = 0;
+    for (std::size_t i = 0; i < baseline.points.size(); i += REFERENCE_STRIDE) {
+        const FrontierPoint& point = baseline.points[i];
+        AlmgrenChriss::Parameters params = grid.model;
+        params.timeHorizon = point.timeHorizon;
+        params.riskAversion = point.riskAversion;
+        FrontierPoint reference = closedForm(params, point.orderSize, STEPS);
+        worstError = std::max({worstError,
+            std::abs(point.expectedCost - reference.expectedCost) / reference.expectedCost,
+            std::abs(point.variance - reference.variance) / reference.variance});
+        ++references;
+    }
+    bool referenceMatches = worstError <= 1e-6;
+
+    std::cout << "Matches point by point: " << (matches ? "yes" : "NO") << std::endl;
+    std::cout << "Identical across thread counts: " << (identical ? "yes" : "NO") << std::endl;
+    std::cout << "Closed form, " << references << " points: worst relative error " << worstError
+              << (referenceMatches ? "" : " (TOO LARGE)") << std::endl;
+    return matches && identical && referenceMatches ? 0 : 1;
+}
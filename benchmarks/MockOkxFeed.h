@@ -0,0 +1,136 @@
+/**
+ * @file MockOkxFeed.h
+ * @brief In-process stand-in for the OKX books channel
+ *
+ * Generates a sequenced L2 stream in the native OKX envelope, with seqId,
+ * prevSeqId and checksum fields computed from the generator's own book, so
+ * that gap detection, checksum verification and resync can be exercised
+ * deterministically without a network connection.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/BookChecksum.h"
+#include "core/OrderBook.h"
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace GoQuant {
+
+/**
+ * @brief Deterministic generator of sequenced OKX book frames
+ *
+ * The generator owns the "exchange" book. snapshot() serves it in full at
+ * the current seqId, as the exchange does on subscription; nextUpdate()
+ * changes a few levels and advances the sequence. Dropping a returned
+ * update reproduces a gap; passing corruptChecksum reproduces a book that
+ * diverged without a visible gap.
+ */
+class MockOkxFeed {
+public:
+    /**
+     * @brief Constructs a feed with a @p depth level book on each side
+     *
+     * @param seed Random seed, for reproducible streams
+     * @param depth Initial levels per side
+     * @param spec Tick and lot scales used to print prices and sizes
+     */
+    explicit MockOkxFeed(std::uint32_t seed, int depth = 400,
+                         const InstrumentSpec& spec = {FixedPointScale(0.1), FixedPointScale(0.01)})
+        : m_random(seed)
+    {
+        m_book.spec = spec;
+        for (int i = 0; i < depth; ++i) {
+            m_book.asks.push_back({MID_TICKS + 1 + i, randomSize()});
+            m_book.bids.push_back({MID_TICKS - i, randomSize()});
+        }
+    }
+
+    /// The exchange-side book after the last generated frame
+    const OrderBook& book() const { return m_book; }
+
+    /// seqId of the last generated frame
+    std::int64_t sequence() const { return m_seqId; }
+
+    /**
+     * @brief Returns a full snapshot of the current book at the current seqId
+     */
+    std::string snapshot() const {
+        std::string frame = header("snapshot", -1);
+        appendLevels(frame, m_book.asks);
+        frame += "],\"bids\":[";
+        appendLevels(frame, m_book.bids);
+        return finish(frame, bookChecksum(m_book));
+    }
+
+    /**
+     * @brief Changes a few levels and returns the corresponding update
+     *
+     * @param corruptChecksum Send a checksum that does not match the book
+     */
+    std::string nextUpdate(bool corruptChecksum = false) {
+        std::int64_t previous = m_seqId;
+        m_seqId += 1 + static_cast<std::int64_t>(m_random() % 3);
+
+        std::vector<OrderBookLevel> asks;
+        std::vector<OrderBookLevel> bids;
+        for (int i = 0; i < 3; ++i) {
+            OrderBookLevel ask{MID_TICKS + 1 + static_cast<Ticks>(m_random() % 60), randomChange()};
+            OrderBookLevel bid{MID_TICKS - static_cast<Ticks>(m_random() % 60), randomChange()};
+            applyLevelDelta(m_book.asks, ask, true);
+            applyLevelDelta(m_book.bids, bid, false);
+            asks.push_back(ask);
+            bids.push_back(bid);
+        }
+
+        std::string frame = header("update", previous);
+        appendLevels(frame, asks);
+        frame += "],\"bids\":[";
+        appendLevels(frame, bids);
+        std::int32_t checksum = bookChecksum(m_book);
+        return finish(frame, corruptChecksum ? checksum ^ 0x5A5A5A5A : checksum);
+    }
+
+private:
+    static constexpr Ticks MID_TICKS = 954450;  ///< 95445.0 at a 0.1 tick
+
+    std::mt19937 m_random;
+    OrderBook m_book;
+    std::int64_t m_seqId = 1000;
+
+    Lots randomSize() { return 1 + static_cast<Lots>(m_random() % 2000); }
+
+    /// New size of a changed level; one in four removes it
+    Lots randomChange() { return m_random() % 4 == 0 ? 0 : randomSize(); }
+
+    std::string header(const char* action, std::int64_t prevSeqId) const {
+        return std::string("{\"arg\":{\"channel\":\"books\",\"instId\":\"BTC-USDT-SWAP\"},"
+                           "\"action\":\"") + action + "\",\"data\":[{\"prevSeqId\":" +
+               std::to_string(prevSeqId) + ",\"seqId\":" + std::to_string(m_seqId) +
+               ",\"asks\":[";
+    }
+
+    void appendLevels(std::string& frame, const std::vector<OrderBookLevel>& levels) const {
+        char buffer[FixedPointScale::MAX_FORMAT_LENGTH];
+        for (size_t i = 0; i < levels.size(); ++i) {
+            frame += i ? ",[\"" : "[\"";
+            frame.append(buffer, m_book.spec.price.format(levels[i].priceTicks, buffer));
+            frame += "\",\"";
+            frame.append(buffer, m_book.spec.quantity.format(levels[i].quantityLots, buffer));
+            frame += "\",\"0\",\"1\"]";
+        }
+    }
+
+    std::string finish(std::string& frame, std::int32_t checksum) const {
+        frame += "],\"checksum\":" + std::to_string(checksum) + ",\"ts\":\"" +
+                 std::to_string(1700000000000LL + m_seqId) + "\"}]}";
+        return frame;
+    }
+};
+
+} // namespace GoQuant
@@ -0,0 +1,88 @@
+/**
+ * @file OrderBookManagerBenchmark.cpp
+ * @brief Measures OrderBookManager throughput as the shard count grows
+ *
+ * Feeds OKX-style update frames for 64 instruments through managers with
+ * 1, 2, 4, ... shards up to the number of hardware threads, and prints the
+ * aggregate and per-shard rates of each run.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/OrderBookManager.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int INSTRUMENTS = 64;
+constexpr int FRAMES = 400000;
+
+std::string makeFrame(int instrument, int sequence, bool snapshot) {
+    std::string frame = "{\"arg\":{\"channel\":\"books\",\"instId\":\"SYM" +
+                        std::to_string(instrument) + "-USDT-SWAP\"},\"action\":\"" +
+                        (snapshot ? "snapshot" : "update") + "\",\"data\":[{\"asks\":[";
+    int levels = snapshot ? 400 : 4;
+    for (int i = 0; i < levels; ++i) {
+        int price = snapshot ? 10000 + i : 10000 + (sequence * 7 + i * 13) % 400;
+        frame += (i ? ",[\"" : "[\"") + std::to_string(price) + ".5\",\"" +
+                 std::to_string(1 + (sequence + i) % 9) + "\",\"0\",\"1\"]";
+    }
+    frame += "],\"bids\":[";
+    for (int i = 0; i < levels; ++i) {
+        int price = snapshot ? 9999 - i : 9999 - (sequence * 5 + i * 11) % 400;
+        frame += (i ? ",[\"" : "[\"") + std::to_string(price) + ".5\",\"" +
+                 std::to_string(1 + (sequence + i) % 7) + "\",\"0\",\"1\"]";
+    }
+    frame += "],\"ts\":\"" + std::to_string(1700000000000LL + sequence) + "\"}]}";
+    return frame;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::string> updates;
+    for (int i = 0; i < 1024; ++i) {
+        updates.push_back(makeFrame(i % INSTRUMENTS, i, false));
+    }
+
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Instruments: " << INSTRUMENTS << ", frames per run: " << FRAMES << std::endl;
+
+    for (unsigned shards = 1; shards <= cpus; shards *= 2) {
+        OrderBookManager manager(shards);
+        for (int i = 0; i < INSTRUMENTS; ++i) {
+            manager.addInstrument("OKX", "SYM" + std::to_string(i) + "-USDT-SWAP");
+        }
+        manager.start();
+        for (int i = 0; i < INSTRUMENTS; ++i) {
+            manager.submit(makeFrame(i, 0, true));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FRAMES; ++i) {
+            manager.submit(updates[i & 1023]);
+        }
+        manager.stop();
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::cout << shards << " shard(s): " << static_cast<long>(FRAMES / seconds)
+                  << " frames/s aggregate" << std::endl;
+        for (const ShardStats& stats : manager.shardStats()) {
+            std::cout << "  shard " << stats.shard << " (cpu " << stats.cpu
+                      << (stats.pinned ? ", pinned" : ", unpinned") << "): "
+                      << static_cast<long>(stats.messagesPerSecond) << " frames/s, "
+                      << static_cast<int>(stats.utilization * 100) << "% busy, "
+                      << "queue high water " << stats.queueHighWater << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file OrderBookParserBenchmark.cpp
+ * @brief Compares the streaming L2 parser with the nlohmann::json DOM path
+ *
+ * Builds a synthetic 400-level BTC-USDT-SWAP frame and measures the cost per
+ * message of the original path (QString round-trip excluded: DOM parse plus
+ * std::stod per field) against OrderBookParser writing into a reused book.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/InstrumentRegistry.h"
+#include "core/OrderBookParser.h"
+#include "core/Timestamp.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int LEVELS_PER_SIDE = 400;
+constexpr int ITERATIONS = 20000;
+
+std::string buildFrame() {
+    std::string frame = "{\"timestamp\":\"2024-03-20T10:00:00Z\",\"exchange\":\"OKX\","
+                        "\"symbol\":\"BTC-USDT-SWAP\",\"asks\":[";
+    char buffer[64];
+    for (int i = 0; i < LEVELS_PER_SIDE; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s[\"%.1f\",\"%.2f\"]",
+                      i ? "," : "", 95445.5 + i * 0.1, 1.0 + (i % 17) * 0.37);
+        frame += buffer;
+    }
+    frame += "],\"bids\":[";
+    for (int i = 0; i < LEVELS_PER_SIDE; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s[\"%.1f\",\"%.2f\"]",
+                      i ? "," : "", 95445.4 - i * 0.1, 1.0 + (i % 13) * 0.41);
+        frame += buffer;
+    }
+    frame += "]}";
+    return frame;
+}
+
+void parseWithDom(const std::string& frame, const InstrumentSpec& spec, OrderBook& book) {
+    auto data = nlohmann::json::parse(frame);
+    parseTimestamp(data["timestamp"].get_ref<const std::string&>(), book.exchangeTimeNs);
+    book.instrument = InstrumentRegistry::instance().intern(
+        data["exchange"].get_ref<const std::string&>(), data["symbol"].get_ref<const std::string&>());
+
+    book.asks.clear();
+    for (const auto& ask : data["asks"]) {
+        book.asks.push_back({spec.price.fromDouble(std::stod(ask[0].get<std::string>())),
+                             spec.quantity.fromDouble(std::stod(ask[1].get<std::string>()))});
+    }
+    book.bids.clear();
+    for (const auto& bid : data["bids"]) {
+        book.bids.push_back({spec.price.fromDouble(std::stod(bid[0].get<std::string>())),
+                             spec.quantity.fromDouble(std::stod(bid[1].get<std::string>()))});
+    }
+}
+
+template <typename Fn>
+double measureNanosPerMessage(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+} // namespace
+
+int main() {
+    const std::string frame = buildFrame();
+    OrderBook domBook;
+    OrderBook streamBook;
+    OrderBookParser parser;
+    const InstrumentSpec spec{FixedPointScale(0.1), FixedPointScale(0.01)};
+
+    double checksum = 0.0;
+    double domNanos = measureNanosPerMessage([&]() {
+        parseWithDom(frame, spec, domBook);
+        checksum += domBook.quantity(domBook.asks.back());
+    });
+    double streamNanos = measureNanosPerMessage([&]() {
+        parser.parse(frame, spec, streamBook);
+        checksum += streamBook.quantity(streamBook.asks.back());
+    });
+
+    std::cout << "Frame size:        " << frame.size() << " bytes, "
+              << LEVELS_PER_SIDE << " levels per side" << std::endl;
+    std::cout << "nlohmann DOM+stod: " << domNanos << " ns/msg" << std::endl;
+    std::cout << "OrderBookParser:   " << streamNanos << " ns/msg" << std::endl;
+    std::cout << "Speedup:           " << domNanos / streamNanos << "x" << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file TrajectoryBenchmark.cpp
+ * @brief Measures Almgren-Chriss schedule throughput with and without profile caching
+ *
+ * Sweeps a grid of parameter sets and order sizes the way a parameter study
+ * does, building the full holdings and trades of every schedule. Once the
+ * profile of every schedule is computed from scratch, once through a
+ * TrajectoryEngine that computes each parameter set's profile once. Prints
+ * schedules per second of both and checks that the holdings agree and end
+ * at the target.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "models/TrajectoryEngine.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace GoQuant;
+
+namespace {
+
+constexpr int STEPS = 100;
+constexpr int SIZES = 200;
+const double VOLATILITIES[] = {0.1, 0.2, 0.4, 0.8};
+const double RISK_AVERSIONS[] = {1e-7, 1e-6, 1e-5, 1e-4};
+const double TEMPORARY_IMPACTS[] = {1e-6, 5e-6, 2.5e-5};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    std::vector<AlmgrenChriss::Parameters> grid;
+    for (double volatility : VOLATILITIES) {
+        for (double riskAversion : RISK_AVERSIONS) {
+            for (double temporaryImpact : TEMPORARY_IMPACTS) {
+                grid.push_back({volatility, 2.5e-7, temporaryImpact, riskAversion, 1.0});
+            }
+        }
+    }
+    const std::size_t schedules = grid.size() * SIZES;
+
+    std::vector<double> holdings(STEPS + 1);
+    std::vector<double> trades(STEPS);
+    std::vector<double> uncachedEnds;
+    uncachedEnds.reserve(schedules);
+    auto start = std::chrono::steady_clock::now();
+    for (const AlmgrenChriss::Parameters& params : grid) {
+        for (int size = 1; size <= SIZES; ++size) {
+            auto profile = TrajectoryEngine::computeProfile(params, STEPS);
+            TrajectoryEngine::fillSchedule(*profile, size * 1000.0, 0.0,
+                                           holdings.data(), trades.data());
+            uncachedEnds.push_back(holdings[STEPS / 2]);
+        }
+    }
+    double uncachedSeconds = secondsSince(start);
+
+    TrajectoryEngine engine;
+    bool matches = true;
+    std::size_t index = 0;
+    start = std::chrono::steady_clock::now();
+    for (const AlmgrenChriss::Parameters& params : grid) {
+        for (int size = 1; size <= SIZES; ++size) {
+            auto profile = engine.profile(params, STEPS);
+            TrajectoryEngine::fillSchedule(*profile, size * 1000.0, 0.0,
+                                           holdings.data(), trades.data());
+            matches = matches && holdings[STEPS / 2] == uncachedEnds[index++] &&
+                      holdings[STEPS] == 0.0;
+        }
+    }
+    double cachedSeconds = secondsSince(start);
+
+    std::cout << schedules << " schedules of " << STEPS << " steps over " << grid.size()
+              << " parameter sets" << std::endl;
+    std::cout << "  profile per schedule: " << schedules / uncachedSeconds
+              << " schedules/s" << std::endl;
+    std::cout << "  cached profiles:      " << schedules / cachedSeconds << " schedules/s ("
+              << uncachedSeconds / cachedSeconds << "x, " << engine.cacheMisses()
+              << " profiles computed)" << std::endl;
+    std::cout << "Schedules match: " << (matches ? "yes" : "NO") << std::endl;
+    return matches ? 0 : 1;
+}
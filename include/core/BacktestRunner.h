@@ -0,0 +1,209 @@
+/**
+ * @file BacktestRunner.h
+ * @brief Header file for the BacktestRunner class
+ *
+ * This file defines the parallel backtest over captured journals: its
+ * configuration, the cost statistics of each (instrument, day) run and the
+ * merged report.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/FeeSchedule.h"
+#include "core/InstrumentRegistry.h"
+#include "models/AlmgrenChriss.h"
+#include "utils/RunningStatistic.h"
+#include <QStringList>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GoQuant {
+
+class WorkStealingPool;
+
+/**
+ * @brief What a backtest simulates on each sampled book
+ */
+struct BacktestConfig {
+    double orderQuantity = 1.0;            ///< Simulated market order, in base currency
+    bool isBuy = true;                     ///< Side of the simulated order
+    int64_t sampleIntervalNs = 1000000000; ///< Least receive-time spacing of sampled books; 0 samples every version
+    AlmgrenChriss::Parameters impactModel{0.02, 0.1, 0.1, 1e-6, 1.0};  ///< Almgren-Chriss parameters
+    std::shared_ptr<const FeeSchedule> feeSchedule;  ///< Fee tiers; null for FeeSchedule::builtIn()
+    std::string feeExchange = "OKX";       ///< Exchange whose fee tiers apply
+    std::string feeProduct = FeeSchedule::DEFAULT_PRODUCT;  ///< Product type whose fee tiers apply
+    double tradingVolume = 0.0;            ///< 30-day volume in USD selecting the fee tier
+    bool trackVolume = false;              ///< Simulated fills move the fee tier; tradingVolume seeds the window
+    InstrumentId instrument = UNKNOWN_INSTRUMENT;  ///< Only this instrument; UNKNOWN_INSTRUMENT for all
+    std::size_t threadCount = 0;           ///< Worker threads; 0 for one per hardware thread
+};
+
+/**
+ * @brief Execution cost statistics over a set of sampled books
+ *
+ * Costs in quote currency are for the whole configured order.
+ */
+struct BacktestCosts {
+    uint64_t samples = 0;             ///< Books evaluated
+    uint64_t unfilled = 0;            ///< Samples whose order exceeded visible depth; not in the statistics
+    RunningStatistic slippage;        ///< Slippage against the mid, as a fraction
+    RunningStatistic marketImpact;    ///< Book market impact, as a fraction of the mid
+    RunningStatistic modelImpact;     ///< Almgren-Chriss impact cost, quote currency
+    RunningStatistic fees;            ///< Taker fee, quote currency
+    RunningStatistic totalCost;       ///< Slippage cost plus fee, quote currency
+
+    /**
+     * @brief Adds the samples of @p other
+     */
+    void merge(const BacktestCosts& other);
+};
+
+/**
+ * @brief Result of the run of one instrument over one UTC day
+ */
+struct BacktestRunResult {
+    InstrumentId instrument = UNKNOWN_INSTRUMENT;  ///< Instrument replayed
+    int64_t day = 0;                   ///< UTC day, in days since the epoch
+    std::size_t files = 0;             ///< Journal files read
+    uint64_t frames = 0;               ///< Frames of the day processed
+    uint64_t warmupFrames = 0;         ///< Earlier frames processed only to rebuild the book
+    uint64_t failedFrames = 0;         ///< Frames the processor rejected
+    uint64_t unsyncedFrames = 0;       ///< Frames of the day seen while the book awaited a snapshot
+    double volume = 0.0;               ///< Notional of the filled samples, quote currency
+    std::uint32_t feeTier = 0;         ///< Fee tier charged, within the fee schedule
+    BacktestCosts costs;               ///< Cost statistics of the day
+    double elapsedSeconds = 0.0;       ///< Wall time of the run
+    std::string error;                 ///< Why the run failed; empty on success
+};
+
+/**
+ * @brief Results of a backtest
+ */
+struct BacktestReport {
+    std::vector<BacktestRunResult> runs;  ///< Ordered by instrument name, then day
+    BacktestCosts total;                  ///< Successful runs merged in the order of runs
+    uint64_t frames = 0;                  ///< Frames of the backtested days processed
+    uint64_t warmupFrames = 0;            ///< Earlier frames processed only to rebuild books
+    std::size_t failedRuns = 0;           ///< Runs with an error
+    std::size_t threads = 0;              ///< Worker threads used
+    double planSeconds = 0.0;             ///< Wall time spent indexing the journals
+    double elapsedSeconds = 0.0;          ///< Wall time of the whole backtest
+    double framesPerSecond = 0.0;         ///< Frames of the backtested days per second of wall time
+};
+
+/**
+ * @brief Runs execution cost backtests over captured journals in parallel
+ *
+ * The journals are first indexed, in parallel, into one run per
+ * (instrument, UTC day) of receive time, and the runs of each instrument
+ * into ranges of consecutive days. Each range has a private pipeline: an
+ * OrderBookProcessor fed the range's frames in order, and an AlmgrenChriss
+ * model and the fee tier's taker rate evaluated on the book at most once
+ * per sample interval. Each day is sampled from the book carried over from
+ * the day before, so a range reads each of its frames once. Ranges share
+ * nothing but the instrument registry and the immutable fee schedule, so
+ * they scale with the cores until memory bandwidth runs out.
+ *
+ * A new range starts at a day whose book can be rebuilt from a recent
+ * snapshot: one followed by at most an eighth as many frames before
+ * midnight as the day holds. The range reads the journals from that
+ * snapshot; the frames before midnight are processed but not sampled, and
+ * count as warm-up. Warm-up thus adds at most an eighth to the frames
+ * processed, however long a connection stayed up. A day with no earlier
+ * snapshot is sampled from its first one.
+ *
+ * Ranges are queued on a WorkStealingPool longest first, and their results
+ * are merged in a fixed order. Where ranges split depends only on the
+ * journals, so the report does not depend on the thread count or on
+ * scheduling.
+ *
+ * With trackVolume, every filled sample counts as a fill of one account and
+ * the fee tier of each day follows the volume of the 30 days before it.
+ * A run's volume does not depend on its fees, so runs still proceed in
+ * parallel: each keeps its fee statistics for every tier, and once all are
+ * done a VolumeTracker walks the days in order and picks each run's tier.
+ */
+class BacktestRunner {
+public:
+    /**
+     * @brief Constructs a runner for @p config
+     */
+    explicit BacktestRunner(const BacktestConfig& config);
+
+    /**
+     * @brief Backtests the given journal files
+     *
+     * @param files Journal files in the order written, typically from
+     *        JournalReader::listFiles()
+     * @return BacktestReport Per-run and merged results
+     * @throws std::invalid_argument if the order quantity, the impact model
+     *         parameters or the fee exchange or product are invalid
+     * @throws std::runtime_error if a file is not a readable journal
+     */
+    BacktestReport run(const QStringList& files);
+
+    /**
+     * @brief Makes running runs return early and queued ones skip; safe from any thread
+     */
+    void stop();
+
+private:
+    /**
+     * @brief A record position across the journal files
+     */
+    struct JournalPosition {
+        int file = -1;         ///< Index into the file list; -1 if unset
+        int64_t offset = 0;    ///< JournalReader::position() in that file
+    };
+
+    /**
+     * @brief One (instrument, day) run as planned from the index
+     */
+    struct Job {
+        InstrumentId instrument;   ///< Instrument to replay
+        int64_t day;               ///< UTC day, in days since the epoch
+        JournalPosition start;     ///< Where a range starting at this day replays from: the last
+                                   ///< snapshot before it, else its first frame
+        uint64_t warmupFrames;     ///< Frames from start to the day's first frame
+        int lastFile;              ///< Last file holding a frame of the day
+        uint64_t frames;           ///< Frames of the day
+    };
+
+    /**
+     * @brief Consecutive runs of one instrument replayed by one pipeline
+     */
+    struct Range {
+        std::size_t firstJob;      ///< Index of the first run
+        std::size_t endJob;        ///< One past the index of the last run
+        uint64_t frames;           ///< Frames of its days, used to order the queue
+    };
+
+    /**
+     * @brief Fee-dependent statistics of a run under one fee rate
+     */
+    struct TierCosts {
+        RunningStatistic fees;        ///< Taker fee, quote currency
+        RunningStatistic totalCost;   ///< Slippage cost plus fee, quote currency
+    };
+
+    std::vector<Job> plan(const QStringList& files, WorkStealingPool& pool) const;
+    static std::vector<Range> splitRanges(const std::vector<Job>& jobs);
+    void runRange(const Range& range, const std::vector<Job>& jobs, const QStringList& files,
+                  const std::vector<double>& takerRates, std::vector<BacktestRunResult>& results,
+                  std::vector<std::vector<TierCosts>>& tierCosts) const;
+    void chargeTrackedTiers(BacktestReport& report,
+                            const std::vector<std::vector<TierCosts>>& tierCosts) const;
+
+    BacktestConfig m_config;               ///< Simulation settings
+    std::atomic<bool> m_stopping{false};   ///< Set by stop()
+};
+
+} // namespace GoQuant
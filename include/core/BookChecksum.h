@@ -0,0 +1,40 @@
+/**
+ * @file BookChecksum.h
+ * @brief Exchange checksum of the top of an order book
+ *
+ * This file declares the OKX-style book checksum used to verify that a
+ * locally maintained book still matches the exchange's after applying
+ * delta updates.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace GoQuant {
+
+/// Levels per side covered by the OKX checksum
+constexpr std::size_t CHECKSUM_DEPTH = 25;
+
+/**
+ * @brief Computes the OKX checksum of the top @p depth levels
+ *
+ * The checksum is the signed CRC-32 of the text
+ * "bid1px:bid1sz:ask1px:ask1sz:bid2px:...", interleaving the sides level by
+ * level and leaving out whichever side has run out. Prices and sizes are
+ * printed in their shortest exact decimal form, which is how the exchange
+ * prints them.
+ *
+ * @param book Book to checksum
+ * @param depth Levels per side to include
+ * @return std::int32_t Checksum, comparable with the "checksum" field of OKX frames
+ */
+std::int32_t bookChecksum(const OrderBook& book, std::size_t depth = CHECKSUM_DEPTH);
+
+} // namespace GoQuant
@@ -0,0 +1,188 @@
+/**
+ * @file BookSnapshot.h
+ * @brief Lock-free publication of immutable order book versions
+ *
+ * This file defines the published book versions shared between the ingest
+ * thread and any number of reader threads, the reference-counted handle
+ * readers hold on a version, and the slot pool the writer publishes into.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/DepthSweep.h"
+#include "core/OrderBook.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace GoQuant {
+
+/**
+ * @brief One immutable, published version of an order book
+ *
+ * The book, its structure-of-arrays sides and the maker/taker proportion are
+ * written by the publisher before the version becomes visible and never
+ * change while any reader holds it. The cumulative depth index is built on
+ * demand by the first reader that needs it; readers never wait for it.
+ */
+class BookVersion {
+public:
+    static constexpr std::uint32_t INDEX_BUILD_THRESHOLD = 2;  ///< Sweeps per side before indexing
+
+    /// Book contents of this version
+    const OrderBook& book() const { return m_book; }
+
+    /// Monotonic version number assigned by the writer
+    std::uint64_t version() const { return m_version; }
+
+    /// Maker/taker proportion at the time this version was published
+    double makerTakerProportion() const { return m_makerTakerProportion; }
+
+    /**
+     * @brief Returns one side in structure-of-arrays layout
+     *
+     * @param isBuy True for the ask side, false for the bid side
+     */
+    const BookSideArrays& side(bool isBuy) const { return m_sides[isBuy ? 0 : 1]; }
+
+    /**
+     * @brief Sweeps one side for the given order size
+     *
+     * Early queries sweep the arrays directly. Once a side has been queried
+     * INDEX_BUILD_THRESHOLD times, one reader builds its cumulative depth
+     * index and later queries use a binary search instead.
+     *
+     * @param isBuy True to sweep the asks, false to sweep the bids
+     * @param quantityLots Order size in lots
+     * @return SweepResult Filled quantity, notional and levels touched
+     */
+    SweepResult sweep(bool isBuy, double quantityLots) const;
+
+    /**
+     * @brief Returns the cumulative depth index of one side, building it if possible
+     *
+     * @param isBuy True for the ask side, false for the bid side
+     * @return const CumulativeDepthIndex* The index, or nullptr while another
+     *         reader is still building it
+     */
+    const CumulativeDepthIndex* depthIndex(bool isBuy) const;
+
+private:
+    friend class BookPublisher;
+    friend class BookSnapshot;
+
+    /// States of a side's lazily built depth index
+    enum IndexState : int { IndexEmpty = 0, IndexBuilding = 1, IndexReady = 2 };
+
+    OrderBook m_book;                                   ///< Published book
+    std::uint64_t m_version = 0;                        ///< Version number
+    double m_makerTakerProportion = 0.5;                ///< Maker/taker proportion
+    BookSideArrays m_sides[2];                          ///< Asks [0] and bids [1] as arrays
+    mutable CumulativeDepthIndex m_index[2];            ///< Lazily built prefix sums
+    mutable std::atomic<int> m_indexState[2] = {{IndexEmpty}, {IndexEmpty}};  ///< IndexState per side
+    mutable std::atomic<std::uint32_t> m_queryCount[2] = {{0}, {0}};         ///< Sweeps per side
+    mutable std::atomic<std::uint32_t> m_readers{0};    ///< Live BookSnapshot handles
+};
+
+/**
+ * @brief Reference-counted handle on a published BookVersion
+ *
+ * While a handle exists the version it refers to is not reused, so the book
+ * can be read without copying and without any lock. An empty handle is
+ * returned before the first publication.
+ */
+class BookSnapshot {
+public:
+    BookSnapshot() = default;
+    BookSnapshot(const BookSnapshot& other);
+    BookSnapshot(BookSnapshot&& other) noexcept;
+    BookSnapshot& operator=(BookSnapshot other) noexcept;
+    ~BookSnapshot();
+
+    /// True if the handle refers to a version
+    explicit operator bool() const { return m_version != nullptr; }
+
+    /// Referenced version; the handle must not be empty
+    const BookVersion& operator*() const { return *m_version; }
+    const BookVersion* operator->() const { return m_version; }
+
+    /// Book of the referenced version; the handle must not be empty
+    const OrderBook& book() const { return m_version->book(); }
+
+    /// Version number, or 0 for an empty handle
+    std::uint64_t version() const { return m_version ? m_version->version() : 0; }
+
+private:
+    friend class BookPublisher;
+
+    explicit BookSnapshot(const BookVersion* version) : m_version(version) {}
+
+    const BookVersion* m_version = nullptr;  ///< Referenced version, already counted
+};
+
+/**
+ * @brief Single-writer, multi-reader publisher of order book versions
+ *
+ * Versions live in a fixed pool of slots. The writer fills a slot that is
+ * neither current nor referenced by a reader and then swaps it in with one
+ * atomic store. Readers take a reference and re-check that the slot is still
+ * current, retrying if the writer moved on in between, so acquiring a
+ * snapshot never takes a lock and never waits on the writer.
+ *
+ * The writer never blocks either: if readers pin every other slot, the
+ * publication is skipped and counted, and the next one catches up.
+ */
+class BookPublisher {
+public:
+    static constexpr std::size_t DEFAULT_SLOTS = 8;  ///< Versions that can be alive at once
+
+    /**
+     * @brief Constructs a publisher with @p slots preallocated versions
+     *
+     * @param slots Number of slots, at least 2
+     * @param reservedDepth Levels reserved per side in each slot
+     * @throws std::invalid_argument if @p slots is less than 2
+     */
+    explicit BookPublisher(std::size_t slots = DEFAULT_SLOTS, std::size_t reservedDepth = 0);
+
+    BookPublisher(const BookPublisher&) = delete;
+    BookPublisher& operator=(const BookPublisher&) = delete;
+
+    /**
+     * @brief Publishes a copy of @p book as the current version
+     *
+     * Must only be called from the single writer thread.
+     *
+     * @param book Book to publish
+     * @param version Version number to tag it with
+     * @param makerTakerProportion Maker/taker proportion to publish with it
+     * @return bool False if every spare slot was pinned and nothing was published
+     */
+    bool publish(const OrderBook& book, std::uint64_t version, double makerTakerProportion);
+
+    /**
+     * @brief Returns a handle on the current version; safe from any thread
+     *
+     * @return BookSnapshot Handle, empty before the first publication
+     */
+    BookSnapshot acquire() const;
+
+    /// Number of publications skipped because no slot was free
+    std::uint64_t skippedPublications() const {
+        return m_skipped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<BookVersion[]> m_slots;         ///< Slot pool
+    std::size_t m_slotCount;                        ///< Number of slots
+    std::size_t m_nextSlot = 0;                     ///< Where the writer starts looking
+    std::atomic<const BookVersion*> m_current{nullptr};  ///< Current version
+    std::atomic<std::uint64_t> m_skipped{0};        ///< Skipped publications
+};
+
+} // namespace GoQuant
@@ -0,0 +1,285 @@
+/**
+ * @file BookStore.h
+ * @brief Header file for the columnar on-disk order book store
+ *
+ * This file defines BookStoreWriter, which appends order books to a
+ * compact columnar file, and BookStoreReader, which memory-maps such a
+ * file and scans time ranges of it at a chosen depth.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/OrderBook.h"
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Layout of book store files
+ *
+ * A file holds the books of one instrument. After a header naming the
+ * instrument and its scales come blocks of up to BLOCK_ROWS books, then an
+ * index with one entry per block (file offset, book count, min/max
+ * exchange time) and a fixed-size footer locating the index.
+ *
+ * Each block stores its books column by column: exchange times, receive
+ * times, ask and bid level counts, then for each depth band the ask
+ * prices, ask quantities, bid prices and bid quantities of the levels whose
+ * rank falls in that band. Times are zigzag varint deltas from the previous
+ * book. The best price of a side is a delta from the previous book's best,
+ * every other price a delta from the level above it, and quantities are
+ * plain varint lot counts. Because the bands are separate columns, reading
+ * the top N levels never touches the bytes of deeper levels.
+ */
+namespace BookStoreFormat {
+
+constexpr std::size_t BLOCK_ROWS = 1024;  ///< Books per block
+constexpr std::size_t BAND_COUNT = 4;     ///< Depth bands per side
+constexpr std::size_t BAND_LIMITS[BAND_COUNT] = {10, 50, 200, SIZE_MAX};  ///< Rank limit of each band
+constexpr std::size_t COLUMN_COUNT = 4 + 4 * BAND_COUNT;  ///< Columns per block
+
+} // namespace BookStoreFormat
+
+/**
+ * @brief Summary of one block of a book store
+ */
+struct BookStoreBlock {
+    std::size_t rows;            ///< Books in the block
+    int64_t minExchangeTimeNs;   ///< Earliest exchange time in the block
+    int64_t maxExchangeTimeNs;   ///< Latest exchange time in the block
+};
+
+/**
+ * @brief Appends order books of one instrument to a columnar store file
+ *
+ * Books are buffered column by column and written a block at a time, so
+ * the file is only valid once close() has written the index.
+ */
+class BookStoreWriter {
+public:
+    /**
+     * @brief Creates or truncates a store file
+     *
+     * @param path File to write
+     * @param maxDepth Levels kept per side; 0 keeps every level
+     * @param blockRows Books per block
+     * @throws std::runtime_error if the file cannot be created
+     */
+    explicit BookStoreWriter(const QString& path, std::size_t maxDepth = 0,
+                             std::size_t blockRows = BookStoreFormat::BLOCK_ROWS);
+
+    /**
+     * @brief Closes the file, writing the index; errors are swallowed
+     */
+    ~BookStoreWriter();
+
+    BookStoreWriter(const BookStoreWriter&) = delete;
+    BookStoreWriter& operator=(const BookStoreWriter&) = delete;
+
+    /**
+     * @brief Appends a book
+     *
+     * @param book Book with asks ascending and bids descending
+     * @throws std::invalid_argument if the book's instrument or scales differ
+     *         from the first book's
+     * @throws std::runtime_error if writing fails
+     */
+    void append(const OrderBook& book);
+
+    /**
+     * @brief Writes the last block, the index and the footer, and closes the file
+     *
+     * @throws std::runtime_error if writing fails
+     */
+    void close();
+
+    /// Books appended so far
+    uint64_t rowCount() const { return m_rowCount; }
+
+    /// Bytes written to the file so far
+    int64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    QFile m_file;
+    std::size_t m_maxDepth;
+    std::size_t m_blockRows;
+    bool m_headerWritten = false;
+    bool m_closed = false;
+    InstrumentId m_instrument = UNKNOWN_INSTRUMENT;
+    InstrumentSpec m_spec;
+    uint64_t m_rowCount = 0;
+    int64_t m_bytesWritten = 0;
+
+    // Current block
+    std::vector<std::string> m_columns;  ///< Column buffers; capacity is reused across blocks
+    std::size_t m_blockRowsUsed = 0;
+    int64_t m_previousExchangeTimeNs = 0;
+    int64_t m_previousReceiveTimeNs = 0;
+    Ticks m_previousBestAsk = 0;
+    Ticks m_previousBestBid = 0;
+    BookStoreBlock m_block{};
+
+    std::string m_index;                 ///< Serialized index entries of written blocks
+
+    void writeHeader();
+    void appendSide(const std::vector<OrderBookLevel>& levels, bool isAsk, Ticks& previousBest);
+    void flushBlock();
+    void write(const void* data, std::size_t size);
+};
+
+/**
+ * @brief Memory-mapped reader of a book store file
+ *
+ * Opening a file reads only its header and index. scan() decodes just the
+ * blocks whose time range overlaps the request, and of those only the
+ * depth bands needed for the requested number of levels.
+ *
+ * Reading is const and keeps no per-scan state in the reader, so several
+ * threads can scan different blocks of the same reader at once.
+ */
+class BookStoreReader {
+public:
+    /**
+     * @brief Opens and maps a store file
+     *
+     * @param path File written by BookStoreWriter
+     * @throws std::runtime_error if the file cannot be mapped or is not a complete store
+     */
+    explicit BookStoreReader(const QString& path);
+
+    /**
+     * @brief Unmaps and closes the file
+     */
+    ~BookStoreReader();
+
+    BookStoreReader(const BookStoreReader&) = delete;
+    BookStoreReader& operator=(const BookStoreReader&) = delete;
+
+    /// Instrument of every book in the file
+    InstrumentId instrument() const { return m_instrument; }
+
+    /// Tick and lot scales of every book in the file
+    const InstrumentSpec& spec() const { return m_spec; }
+
+    /// Total number of books
+    uint64_t rowCount() const { return m_rowCount; }
+
+    /// Number of blocks
+    std::size_t blockCount() const { return m_blockCount; }
+
+    /**
+     * @brief Returns the index entry of a block
+     *
+     * @param index Block position, 0 being the first written
+     */
+    BookStoreBlock block(std::size_t index) const;
+
+    /**
+     * @brief Visits the books with exchange time in [@p fromNs, @p toNs), in file order
+     *
+     * The callback receives a book that is overwritten between calls; copy
+     * it if it must outlive the call.
+     *
+     * @param fromNs Inclusive start, nanoseconds since the epoch
+     * @param toNs Exclusive end, nanoseconds since the epoch
+     * @param depth Levels per side to decode; SIZE_MAX for all
+     * @param callback Invoked as callback(book) for each book in range
+     * @throws std::runtime_error if a block is corrupt
+     */
+    template <typename Callback>
+    void scan(int64_t fromNs, int64_t toNs, std::size_t depth, Callback&& callback) const {
+        OrderBook book;
+        for (std::size_t i = 0; i < m_blockCount; ++i) {
+            scanBlock(i, fromNs, toNs, depth, book, callback);
+        }
+    }
+
+    /**
+     * @brief Visits the books of one block with exchange time in [@p fromNs, @p toNs)
+     *
+     * Blocks whose index range misses the interval are skipped without
+     * being read. Lets callers split a scan across threads by block.
+     *
+     * @param index Block position
+     * @param fromNs Inclusive start, nanoseconds since the epoch
+     * @param toNs Exclusive end, nanoseconds since the epoch
+     * @param depth Levels per side to decode; SIZE_MAX for all
+     * @param book Reused destination book
+     * @param callback Invoked as callback(book) for each book in range
+     * @throws std::runtime_error if the block is corrupt
+     */
+    template <typename Callback>
+    void scanBlock(std::size_t index, int64_t fromNs, int64_t toNs, std::size_t depth,
+                   OrderBook& book, Callback&& callback) const {
+        BookStoreBlock summary = block(index);
+        if (summary.maxExchangeTimeNs < fromNs || summary.minExchangeTimeNs >= toNs) {
+            return;
+        }
+        BlockCursor cursor(*this, index, depth);
+        while (cursor.next(book)) {
+            if (book.exchangeTimeNs >= fromNs && book.exchangeTimeNs < toNs) {
+                callback(static_cast<const OrderBook&>(book));
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Decodes the books of one block in order
+     */
+    class BlockCursor {
+    public:
+        BlockCursor(const BookStoreReader& reader, std::size_t block, std::size_t depth);
+
+        /**
+         * @brief Decodes the next book into @p book
+         *
+         * @return bool False once every book of the block was read
+         * @throws std::runtime_error if the block is corrupt
+         */
+        bool next(OrderBook& book);
+
+    private:
+        /// Read position and end of one column
+        struct Column {
+            const unsigned char* pos = nullptr;
+            const unsigned char* end = nullptr;
+        };
+
+        const BookStoreReader& m_reader;
+        std::size_t m_depth;
+        std::size_t m_bands;           ///< Bands needed for m_depth
+        std::size_t m_rowsLeft;
+        Column m_columns[BookStoreFormat::COLUMN_COUNT];
+        int64_t m_exchangeTimeNs = 0;
+        int64_t m_receiveTimeNs = 0;
+        Ticks m_bestAsk = 0;
+        Ticks m_bestBid = 0;
+
+        uint64_t readUnsigned(Column& column);
+        void readSide(std::size_t levels, bool isAsk, Ticks& best,
+                      std::vector<OrderBookLevel>& out);
+    };
+
+    QFile m_file;
+    const unsigned char* m_data = nullptr;
+    int64_t m_size = 0;
+    InstrumentId m_instrument = UNKNOWN_INSTRUMENT;
+    InstrumentSpec m_spec;
+    uint64_t m_rowCount = 0;
+    std::size_t m_blockCount = 0;
+    int64_t m_headerSize = 0;      ///< Start of the first block
+    int64_t m_indexOffset = 0;     ///< End of the last block
+};
+
+} // namespace GoQuant
@@ -0,0 +1,201 @@
+/**
+ * @file CaptureJournal.h
+ * @brief Header file for the CaptureJournal class and the journal file format
+ *
+ * This file defines the binary append-only journal that records raw market
+ * data frames as they are received, and the on-disk record layout shared
+ * with the readers that replay it.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/InstrumentRegistry.h"
+#include "utils/SpscRing.h"
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+namespace GoQuant {
+
+/**
+ * @brief Layout of journal files
+ *
+ * A journal file starts with a FileHeader and continues with records, each
+ * a RecordHeader followed by @c length payload bytes and padding to the
+ * next multiple of RECORD_ALIGNMENT. A record header of type zero, or the
+ * end of the file, ends the data; files are zero-filled when preallocated
+ * and truncated to their used size when closed, so a file cut short by a
+ * crash still reads back up to its last complete record.
+ *
+ * Instrument IDs are only meaningful within one process, so every file
+ * defines the IDs it uses: the first frame of an instrument in a file is
+ * preceded by an Instrument record whose payload is the exchange and the
+ * symbol separated by a NUL byte.
+ */
+namespace Journal {
+
+constexpr char MAGIC[8] = {'G', 'Q', 'J', 'R', 'N', 'L', '0', '1'};  ///< File signature
+constexpr uint32_t FORMAT_VERSION = 1;        ///< Current layout version
+constexpr uint32_t RECORD_ALIGNMENT = 8;      ///< Records start on 8-byte boundaries
+
+/**
+ * @brief Kind of a journal record
+ */
+enum RecordType : uint16_t {
+    FrameRecord = 1,       ///< Raw frame bytes as received
+    InstrumentRecord = 2   ///< Defines an instrument ID for the rest of the file
+};
+
+/**
+ * @brief Header at the start of every journal file
+ */
+struct FileHeader {
+    char magic[8];          ///< Journal::MAGIC
+    uint32_t version;       ///< Journal::FORMAT_VERSION
+    uint32_t headerSize;    ///< sizeof(FileHeader), for forward compatibility
+    int64_t createdTimeNs;  ///< Wall-clock creation time, ns since the epoch
+};
+
+/**
+ * @brief Header in front of every record payload
+ */
+struct RecordHeader {
+    uint32_t length;         ///< Payload bytes, excluding header and padding
+    uint16_t type;           ///< RecordType; 0 ends the data
+    uint16_t reserved;       ///< Zero
+    int64_t receiveTimeNs;   ///< Wall-clock receive time, ns since the epoch
+    uint32_t instrument;     ///< Instrument ID within the file; UNKNOWN_INSTRUMENT if none
+    uint32_t reserved2;      ///< Zero
+};
+
+static_assert(sizeof(FileHeader) % RECORD_ALIGNMENT == 0, "FileHeader must keep records aligned");
+static_assert(sizeof(RecordHeader) % RECORD_ALIGNMENT == 0, "RecordHeader must keep records aligned");
+
+/// Bytes a record with @p length payload bytes occupies in the file
+constexpr uint64_t recordSize(uint32_t length) {
+    return (sizeof(RecordHeader) + length + RECORD_ALIGNMENT - 1) & ~uint64_t(RECORD_ALIGNMENT - 1);
+}
+
+} // namespace Journal
+
+/**
+ * @brief Settings of a capture journal
+ */
+struct CaptureConfig {
+    QString directory;                          ///< Directory the files are written to
+    QString prefix = "capture";                 ///< File name prefix
+    int64_t maxFileBytes = 256LL << 20;         ///< Rotate when the next record would not fit
+    int64_t maxFileAgeNs = 3600LL * 1000000000; ///< Rotate files older than this; 0 disables
+    size_t queueCapacity = 65536;               ///< Frames the handoff ring can hold
+};
+
+/**
+ * @brief Counters of a capture journal
+ */
+struct CaptureStats {
+    uint64_t framesCaptured;   ///< Frames written to a file
+    uint64_t framesDropped;    ///< Frames discarded because the ring was full or writing failed
+    uint64_t bytesWritten;     ///< File bytes used, headers and padding included
+    uint64_t filesOpened;      ///< Files created, including the current one
+    size_t queueHighWater;     ///< Largest number of frames waiting at once
+    QString currentFile;       ///< Path of the file being written; empty if none
+};
+
+/**
+ * @brief Append-only, memory-mapped journal of raw frames
+ *
+ * append() is called on the receive path and only copies the frame into a
+ * preallocated single-producer/single-consumer ring slot; it never takes a
+ * lock, touches the file or allocates once the ring has warmed up. A
+ * background writer thread resolves each frame's instrument, copies it
+ * into the current memory-mapped file and rotates files by size and age.
+ * When the writer falls behind far enough to fill the ring, frames are
+ * dropped and counted instead of stalling the receiver.
+ *
+ * append() must always be called from the same thread.
+ */
+class CaptureJournal {
+public:
+    /**
+     * @brief Opens the first file and starts the writer thread
+     *
+     * @param config Directory, rotation limits and queue size
+     * @throws std::runtime_error if the directory or first file cannot be created
+     */
+    explicit CaptureJournal(const CaptureConfig& config);
+
+    /**
+     * @brief Writes every queued frame, then truncates and closes the file
+     */
+    ~CaptureJournal();
+
+    CaptureJournal(const CaptureJournal&) = delete;
+    CaptureJournal& operator=(const CaptureJournal&) = delete;
+
+    /**
+     * @brief Queues a frame for the writer; never blocks
+     *
+     * Empty frames carry no data and are not journaled.
+     *
+     * @param frame Raw frame bytes
+     * @param receiveTimeNs Wall-clock receive time, ns since the epoch
+     * @return bool False if the ring was full and the frame was dropped
+     */
+    bool append(std::string_view frame, int64_t receiveTimeNs);
+
+    /**
+     * @brief Returns the journal counters; safe from any thread
+     */
+    CaptureStats stats() const;
+
+private:
+    /**
+     * @brief A frame waiting for the writer
+     */
+    struct PendingFrame {
+        std::string bytes;          ///< Frame bytes; capacity is reused across laps
+        int64_t receiveTimeNs = 0;  ///< Wall-clock receive time
+    };
+
+    CaptureConfig m_config;
+    SpscRing<PendingFrame> m_ring;             ///< Receive path to writer handoff
+    std::thread m_writer;                      ///< Background writer thread
+    std::atomic<bool> m_stopping{false};       ///< Set by the destructor
+
+    // Writer thread state
+    QFile m_file;                              ///< Current file
+    uchar* m_map = nullptr;                    ///< Mapping of the whole preallocated file
+    int64_t m_capacity = 0;                    ///< Size of the mapping
+    int64_t m_used = 0;                        ///< Bytes written to the mapping
+    int64_t m_fileOpenedNs = 0;                ///< Steady-clock time the file was opened
+    uint64_t m_fileSequence = 0;               ///< Number of files opened so far
+    std::unordered_set<InstrumentId> m_definedInstruments;  ///< IDs defined in the current file
+
+    std::atomic<uint64_t> m_framesCaptured{0};
+    std::atomic<uint64_t> m_framesDropped{0};
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::atomic<uint64_t> m_filesOpened{0};
+    std::atomic<size_t> m_queueHighWater{0};
+    mutable std::mutex m_fileNameMutex;        ///< Guards m_fileName
+    QString m_fileName;                        ///< Path of the current file
+
+    void runWriter();
+    void writeFrame(const PendingFrame& frame);
+    bool reserve(int64_t bytes);
+    void writeRecord(uint16_t type, InstrumentId instrument, int64_t receiveTimeNs,
+                     std::string_view payload);
+    void openFile(int64_t minimumBytes);
+    void closeFile();
+};
+
+} // namespace GoQuant
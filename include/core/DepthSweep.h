@@ -0,0 +1,176 @@
+/**
+ * @file DepthSweep.h
+ * @brief Structure-of-arrays book side and vectorised depth sweep kernels
+ *
+ * This file defines the contiguous, AVX2-aligned layout of one order book
+ * side used by the impact and slippage calculations, together with the sweep
+ * kernel that walks it to find the fill boundary of an order.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/OrderBook.h"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Minimal allocator returning storage aligned to @p Alignment bytes
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+/**
+ * @brief One book side laid out as contiguous price and quantity arrays
+ *
+ * Prices (ticks) and quantities (lots) are stored as doubles holding exact
+ * integer values: AVX2 has no packed int64 multiply or int64-to-double
+ * conversion, and integers up to 2^53 are exact in a double. Both arrays are
+ * 32-byte aligned and zero-padded to a multiple of SIMD_WIDTH, so kernels
+ * can use aligned full-width loads with no remainder handling.
+ */
+class BookSideArrays {
+public:
+    static constexpr std::size_t SIMD_WIDTH = 4;  ///< Doubles per AVX2 register
+
+    /**
+     * @brief Rebuilds the arrays from an array-of-structs book side
+     *
+     * Existing capacity is reused, so steady-state rebuilds do not allocate.
+     *
+     * @param levels Book side ordered best-first
+     */
+    void assign(const std::vector<OrderBookLevel>& levels);
+
+    /// Number of real (unpadded) levels
+    std::size_t size() const { return m_size; }
+
+    /// Number of levels including zero padding
+    std::size_t paddedSize() const { return m_prices.size(); }
+
+    /// Level prices in ticks
+    const double* prices() const { return m_prices.data(); }
+
+    /// Level quantities in lots
+    const double* quantities() const { return m_quantities.data(); }
+
+private:
+    std::vector<double, AlignedAllocator<double, 32>> m_prices;      ///< Prices in ticks
+    std::vector<double, AlignedAllocator<double, 32>> m_quantities;  ///< Quantities in lots
+    std::size_t m_size = 0;                                          ///< Real level count
+};
+
+/**
+ * @brief Outcome of sweeping a book side for a given order size
+ */
+struct SweepResult {
+    double filledLots;      ///< Quantity that could be filled, in lots
+    double notionalTicks;   ///< Sum of price * filled quantity, in tick*lot units
+    std::size_t levels;     ///< Number of levels touched by the fill
+};
+
+/**
+ * @brief Cumulative quantity and notional of one book side
+ *
+ * Built once per book version, the index turns any sweep into a binary search
+ * for the fill boundary plus one partial level, so a curve of many order sizes
+ * costs O(sizes x log depth) instead of O(sizes x depth).
+ */
+class CumulativeDepthIndex {
+public:
+    /**
+     * @brief Rebuilds the prefix sums from @p side, reusing existing capacity
+     *
+     * @param side Book side in structure-of-arrays layout
+     */
+    void build(const BookSideArrays& side);
+
+    /**
+     * @brief Answers a sweep from the prefix sums
+     *
+     * Returns the same fill, notional and level count as sweepDepth() on the
+     * side the index was built from.
+     *
+     * @param side Book side the index was built from
+     * @param quantityLots Order size in lots
+     * @return SweepResult Filled quantity, notional and levels touched
+     */
+    SweepResult query(const BookSideArrays& side, double quantityLots) const;
+
+    /// Total quantity on the side, in lots
+    double totalLots() const { return m_cumulativeLots.empty() ? 0.0 : m_cumulativeLots.back(); }
+
+private:
+    std::vector<double> m_cumulativeLots;      ///< Inclusive prefix sums of quantity
+    std::vector<double> m_cumulativeNotional;  ///< Inclusive prefix sums of price * quantity
+};
+
+/**
+ * @brief Sweeps a book side until @p quantityLots is filled or depth runs out
+ *
+ * Dispatches once at runtime to the AVX2 kernel when the CPU supports it and
+ * to the scalar kernel otherwise.
+ *
+ * @param side Book side in structure-of-arrays layout
+ * @param quantityLots Order size in lots
+ * @return SweepResult Filled quantity, notional and levels touched
+ */
+SweepResult sweepDepth(const BookSideArrays& side, double quantityLots);
+
+/**
+ * @brief Sweeps a book side once for a batch of ascending order sizes
+ *
+ * Walks the levels forward a single time, emitting each result when its
+ * fill boundary is reached, so a sorted curve of k sizes costs O(depth + k).
+ *
+ * @param side Book side in structure-of-arrays layout
+ * @param sortedLots Order sizes in lots, in non-decreasing order
+ * @param count Number of order sizes
+ * @param results Receives one SweepResult per order size
+ */
+void sweepDepthSorted(const BookSideArrays& side, const double* sortedLots,
+                      std::size_t count, SweepResult* results);
+
+/**
+ * @brief Portable scalar sweep, used as the fallback kernel
+ */
+SweepResult sweepDepthScalar(const BookSideArrays& side, double quantityLots);
+
+/**
+ * @brief Reports whether sweepDepth() selected the AVX2 kernel
+ */
+bool sweepDepthUsesAvx2();
+
+} // namespace GoQuant
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include "core/FeeSchedule.h"
+#include "core/VolumeTracker.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <vector>
 
 namespace GoQuant {
 
@@ -23,6 +26,14 @@ namespace GoQuant {
  * 
  * This class manages fee calculations for different exchanges, taking into account
  * trading volume-based fee tiers and maker/taker order types.
+ *
+ * It prices the orders of one account at a time against a shared, immutable
+ * FeeSchedule. To price many accounts or venues at once, use the schedule's
+ * batch API directly.
+ *
+ * The tier is either set from a volume the caller supplies, with
+ * setFeeTier(), or follows the account's own fills, with trackVolume() and
+ * recordFill().
  */
 class FeeCalculator {
 public:
@@ -41,17 +52,51 @@ public:
     /**
      * @brief Constructs a new FeeCalculator instance
      * 
-     * Initializes the fee calculator with default fee tiers for supported exchanges.
+     * Initializes the fee calculator with the built-in OKX spot tiers.
      */
     FeeCalculator();
 
+    /**
+     * @brief Constructs a fee calculator on a loaded schedule
+     * 
+     * Starts at the first tier of the schedule's first exchange and product.
+     * 
+     * @param schedule Fee schedule, typically from FeeSchedule::loadFile()
+     * @throws std::invalid_argument if @p schedule is null or empty
+     */
+    explicit FeeCalculator(std::shared_ptr<const FeeSchedule> schedule);
+
     /**
      * @brief Sets the current fee tier based on trading volume
      * 
+     * Stops volume tracking.
+     * 
      * @param exchange Exchange name (e.g., "OKX")
      * @param tradingVolume Total trading volume in USD
+     * @param product Product type (e.g., "spot" or "swap")
      */
-    void setFeeTier(const std::string& exchange, double tradingVolume);
+    void setFeeTier(const std::string& exchange, double tradingVolume,
+                    const std::string& product = FeeSchedule::DEFAULT_PRODUCT);
+
+    /**
+     * @brief Lets recorded fills set the fee tier from now on
+     * 
+     * @param exchange Exchange name (e.g., "OKX")
+     * @param timeNs Current time, in nanoseconds since the epoch
+     * @param priorVolume Trading volume of the 30 days before, in USD
+     * @param product Product type (e.g., "spot" or "swap")
+     */
+    void trackVolume(const std::string& exchange, int64_t timeNs, double priorVolume = 0.0,
+                     const std::string& product = FeeSchedule::DEFAULT_PRODUCT);
+
+    /**
+     * @brief Adds a fill to the tracked volume
+     * 
+     * @param timeNs Time of the fill, in nanoseconds since the epoch
+     * @param notional Traded value in USD
+     * @return bool True if the fee tier changed
+     */
+    bool recordFill(int64_t timeNs, double notional);
 
     /**
      * @brief Calculates trading fees for an order
@@ -69,16 +114,30 @@ public:
      */
     const FeeTier& getCurrentFeeTier() const;
 
+    /**
+     * @brief Returns the schedule the tiers come from
+     */
+    const std::shared_ptr<const FeeSchedule>& getSchedule() const;
+
+    /**
+     * @brief Returns the volume tracker, or null if the tier is set by volume
+     */
+    const VolumeTracker* getVolumeTracker() const;
+
 private:
-    std::unordered_map<std::string, std::vector<FeeTier>> m_feeTiers;  ///< Fee tiers for different exchanges
+    std::shared_ptr<const FeeSchedule> m_schedule;  ///< Fee tiers for different exchanges
     FeeTier m_currentTier;  ///< Currently active fee tier
+    std::optional<VolumeTracker> m_tracker;  ///< Rolling volume, while tracking
 
     /**
-     * @brief Initializes fee tiers for supported exchanges
-     * 
-     * Sets up the fee structure for different exchanges and their VIP tiers.
+     * @brief Makes a tier of the schedule the current one
+     */
+    void selectTier(FeeScheduleId schedule, std::uint32_t tier);
+
+    /**
+     * @brief Looks up a schedule, rejecting unknown ones
      */
-    void initializeFeeTiers();
+    FeeScheduleId findSchedule(const std::string& exchange, const std::string& product) const;
 };
 
 } // namespace GoQuant 
\ No newline at end of file
@@ -0,0 +1,192 @@
+/**
+ * @file FeeSchedule.h
+ * @brief Header file for the FeeSchedule class
+ *
+ * This file defines the immutable, multi-exchange fee schedule compiled from
+ * a JSON configuration, and the query type of its batched fee evaluation.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GoQuant {
+
+using FeeScheduleId = std::uint32_t;  ///< Index of an (exchange, product) schedule
+
+/// Returned by FeeSchedule::find() for an unknown exchange or product
+constexpr FeeScheduleId INVALID_FEE_SCHEDULE = UINT32_MAX;
+
+/**
+ * @brief One order to price in a batch
+ */
+struct FeeQuery {
+    FeeScheduleId schedule;  ///< Exchange and product, from FeeSchedule::find()
+    std::uint32_t tier;      ///< Account tier within the schedule
+    double size;             ///< Order size or notional; the fee is in the same unit
+    bool isMaker;            ///< True for maker orders, false for taker orders
+};
+
+/**
+ * @brief Fee tiers of several exchanges and products, compiled into flat tables
+ *
+ * The configuration lists, per exchange and product type (for example spot
+ * and swap), the account tiers in ascending order of minimum 30-day volume:
+ *
+ * @code{.json}
+ * {"exchanges": [{"name": "OKX", "products": {"spot": [
+ *     {"tier": "Regular", "minVolume": 0, "maker": 0.0008, "taker": 0.0010},
+ *     {"tier": "VIP1", "minVolume": 50000, "maker": 0.0007, "taker": 0.0009}]}}]}
+ * @endcode
+ *
+ * Names are resolved once with find() and tierForVolume(); pricing then
+ * indexes one contiguous array of rates, with a tier's taker and maker rates
+ * side by side. A schedule is never modified after it is built, so one
+ * instance, typically held through a shared_ptr, can price orders for any
+ * number of accounts from any number of threads.
+ */
+class FeeSchedule {
+public:
+    static constexpr const char* DEFAULT_PRODUCT = "spot";  ///< Product used when none is named
+
+    /**
+     * @brief Constructs an empty schedule
+     */
+    FeeSchedule() = default;
+
+    /**
+     * @brief Compiles a schedule from its JSON configuration
+     *
+     * @param config Configuration object, see the class description
+     * @return FeeSchedule Compiled schedule
+     * @throws std::invalid_argument if the configuration is malformed, names an
+     *         (exchange, product) twice, or has tiers out of volume order or
+     *         with negative volumes or taker rates
+     */
+    static FeeSchedule fromJson(const nlohmann::json& config);
+
+    /**
+     * @brief Reads and compiles a configuration file
+     *
+     * @param path JSON configuration file
+     * @return FeeSchedule Compiled schedule
+     * @throws std::runtime_error if the file cannot be read or is not JSON
+     * @throws std::invalid_argument if the configuration is invalid
+     */
+    static FeeSchedule loadFile(const QString& path);
+
+    /**
+     * @brief Returns the built-in schedule: the OKX spot tiers
+     */
+    static std::shared_ptr<const FeeSchedule> builtIn();
+
+    /**
+     * @brief Looks up an (exchange, product) schedule
+     *
+     * @return FeeScheduleId Schedule ID, or INVALID_FEE_SCHEDULE if absent
+     */
+    FeeScheduleId find(std::string_view exchange,
+                       std::string_view product = DEFAULT_PRODUCT) const;
+
+    /// Number of (exchange, product) schedules
+    std::size_t scheduleCount() const { return m_schedules.size(); }
+
+    /// Exchange of @p schedule
+    const std::string& exchange(FeeScheduleId schedule) const { return m_schedules.at(schedule).exchange; }
+
+    /// Product type of @p schedule
+    const std::string& product(FeeScheduleId schedule) const { return m_schedules.at(schedule).product; }
+
+    /// Number of tiers of @p schedule
+    std::uint32_t tierCount(FeeScheduleId schedule) const { return m_schedules.at(schedule).tierCount; }
+
+    /// Name of a tier, as in the configuration
+    const std::string& tierName(FeeScheduleId schedule, std::uint32_t tier) const;
+
+    /// Minimum 30-day volume of a tier, in USD
+    double minVolume(FeeScheduleId schedule, std::uint32_t tier) const;
+
+    /**
+     * @brief Returns the fee rate of a tier
+     *
+     * @throws std::out_of_range if the schedule or tier does not exist
+     */
+    double rate(FeeScheduleId schedule, std::uint32_t tier, bool isMaker) const;
+
+    /**
+     * @brief Finds the highest tier a 30-day volume qualifies for
+     *
+     * @param schedule Schedule ID
+     * @param volume 30-day trading volume in USD
+     * @return std::uint32_t Tier index; the first tier if no minimum is met
+     * @throws std::out_of_range if the schedule does not exist
+     */
+    std::uint32_t tierForVolume(FeeScheduleId schedule, double volume) const;
+
+    /**
+     * @brief Prices one order
+     *
+     * @throws std::out_of_range if the query names an unknown schedule or tier
+     */
+    double calculateFee(const FeeQuery& query) const;
+
+    /**
+     * @brief Prices a batch of orders in one pass
+     *
+     * Queries are validated first, so on error nothing is written. Each fee
+     * is then one table load and one multiply, with no branch on the order
+     * type.
+     *
+     * @param queries Orders to price
+     * @param count Number of orders
+     * @param fees Receives one fee per order
+     * @throws std::out_of_range if a query names an unknown schedule or tier
+     */
+    void calculateFees(const FeeQuery* queries, std::size_t count, double* fees) const;
+
+    /**
+     * @brief Prices a batch of orders in one pass
+     *
+     * @param queries Orders to price
+     * @return std::vector<double> One fee per order, in input order
+     * @throws std::out_of_range if a query names an unknown schedule or tier
+     */
+    std::vector<double> calculateFees(const std::vector<FeeQuery>& queries) const;
+
+private:
+    /**
+     * @brief Location of one (exchange, product) schedule in the flat tables
+     */
+    struct Schedule {
+        std::string exchange;      ///< Exchange name
+        std::string product;       ///< Product type
+        std::uint32_t firstTier;   ///< Index of its first tier in the flat tables
+        std::uint32_t tierCount;   ///< Number of tiers
+    };
+
+    /// Index of a tier in the flat tables, checking both indices
+    std::uint32_t tierIndex(FeeScheduleId schedule, std::uint32_t tier) const;
+
+    /// Lookup key of an (exchange, product) pair
+    static std::string makeKey(std::string_view exchange, std::string_view product);
+
+    std::vector<Schedule> m_schedules;    ///< Schedules by ID
+    std::vector<double> m_rates;          ///< Taker then maker rate of each tier
+    std::vector<double> m_minVolumes;     ///< Minimum 30-day volume of each tier
+    std::vector<std::string> m_tierNames; ///< Name of each tier
+    std::unordered_map<std::string, FeeScheduleId> m_ids;  ///< Key to schedule ID
+};
+
+} // namespace GoQuant
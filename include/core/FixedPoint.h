@@ -0,0 +1,120 @@
+/**
+ * @file FixedPoint.h
+ * @brief Instrument-aware fixed-point representation of prices and quantities
+ *
+ * This file defines the integer tick and lot types used for order book
+ * storage, together with the per-instrument scales that convert between
+ * exchange decimal strings, integer units and doubles.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace GoQuant {
+
+using Ticks = std::int64_t;  ///< Price expressed as an integer number of tick sizes
+using Lots = std::int64_t;   ///< Quantity expressed as an integer number of lot sizes
+
+/**
+ * @brief Converts between decimal values and integer multiples of an increment
+ *
+ * The increment (tick size or lot size) is held exactly as
+ * step * 10^-decimals, so decimal strings from the exchange can be converted
+ * to integer units without going through a binary floating-point value.
+ */
+class FixedPointScale {
+public:
+    /**
+     * @brief Constructs a scale with a 1e-8 increment
+     */
+    FixedPointScale();
+
+    /**
+     * @brief Constructs a scale for the given increment
+     *
+     * @param increment Smallest representable step (e.g. 0.1 for a 0.1 tick)
+     * @throws std::invalid_argument if the increment is not positive or has
+     *         more than 12 decimal places
+     */
+    explicit FixedPointScale(double increment);
+
+    /**
+     * @brief Converts a decimal string to integer units, rounding to nearest
+     *
+     * @param text Decimal text such as "95445.5", "-0.25" or "1e-3"
+     * @param units Receives the value in integer units
+     * @return bool False if the text is not a valid decimal number
+     */
+    bool parse(std::string_view text, std::int64_t& units) const;
+
+    /// Buffer size sufficient for any output of format()
+    static constexpr std::size_t MAX_FORMAT_LENGTH = 32;
+
+    /**
+     * @brief Writes integer units as the shortest exact decimal text
+     *
+     * Trailing fractional zeros and a trailing decimal point are omitted, so
+     * 95445.50 is written as "95445.5" and 8.000 as "8", matching how
+     * exchanges print prices and sizes.
+     *
+     * @param units Value in integer units
+     * @param buffer Destination of at least MAX_FORMAT_LENGTH bytes; not terminated
+     * @return std::size_t Number of characters written
+     */
+    std::size_t format(std::int64_t units, char* buffer) const;
+
+    /**
+     * @brief Converts a double to integer units, rounding to nearest
+     */
+    std::int64_t fromDouble(double value) const {
+        return std::llround(value / m_increment);
+    }
+
+    /**
+     * @brief Converts integer units back to a double
+     */
+    double toDouble(std::int64_t units) const {
+        return static_cast<double>(units) * m_increment;
+    }
+
+    /// Increment represented by one unit
+    double increment() const { return m_increment; }
+
+    /// Number of decimal places in the increment
+    int decimals() const { return m_decimals; }
+
+    bool operator==(const FixedPointScale& other) const {
+        return m_decimals == other.m_decimals && m_step == other.m_step;
+    }
+
+    bool operator!=(const FixedPointScale& other) const { return !(*this == other); }
+
+private:
+    double m_increment;    ///< Increment as a double, for conversions at the API edge
+    int m_decimals;        ///< Decimal places of the increment
+    std::int64_t m_step;   ///< Increment expressed in units of 10^-m_decimals
+};
+
+/**
+ * @brief Fixed-point scales for a single instrument
+ */
+struct InstrumentSpec {
+    FixedPointScale price;     ///< Tick size scale for prices
+    FixedPointScale quantity;  ///< Lot size scale for quantities
+
+    bool operator==(const InstrumentSpec& other) const {
+        return price == other.price && quantity == other.quantity;
+    }
+
+    bool operator!=(const InstrumentSpec& other) const { return !(*this == other); }
+};
+
+} // namespace GoQuant
@@ -0,0 +1,102 @@
+/**
+ * @file InstrumentRegistry.h
+ * @brief Process-wide interning of (exchange, symbol) pairs
+ *
+ * This file defines the small integer instrument IDs carried by order books
+ * in place of exchange and symbol strings, and the registry that maps
+ * between the two.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace GoQuant {
+
+using InstrumentId = std::uint32_t;  ///< Interned (exchange, symbol) pair
+
+/// ID of the instrument with empty exchange and symbol, used when a message names none
+constexpr InstrumentId UNKNOWN_INSTRUMENT = 0;
+
+/**
+ * @brief Interns (exchange, symbol) pairs into dense instrument IDs
+ *
+ * IDs are assigned in registration order and never reused, so they can be
+ * stored in books and history indefinitely. Resolving an ID back to its
+ * names is lock-free; interning takes a mutex and is expected to happen once
+ * per instrument, with callers caching the ID on their hot path.
+ */
+class InstrumentRegistry {
+public:
+    static constexpr std::size_t MAX_INSTRUMENTS = 65536;  ///< Capacity of the registry
+
+    /**
+     * @brief Returns the process-wide registry
+     */
+    static InstrumentRegistry& instance();
+
+    /**
+     * @brief Returns the ID of an instrument, registering it if needed
+     *
+     * @param exchange Exchange name
+     * @param symbol Instrument symbol
+     * @return InstrumentId ID of the pair
+     * @throws std::length_error if MAX_INSTRUMENTS would be exceeded
+     */
+    InstrumentId intern(std::string_view exchange, std::string_view symbol);
+
+    /**
+     * @brief Looks up an instrument without registering it
+     *
+     * @return InstrumentId ID of the pair, or UNKNOWN_INSTRUMENT if not registered
+     */
+    InstrumentId find(std::string_view exchange, std::string_view symbol) const;
+
+    /**
+     * @brief Tests whether @p id names the given pair; lock-free
+     */
+    bool matches(InstrumentId id, std::string_view exchange, std::string_view symbol) const;
+
+    /// Exchange name of @p id; empty for unknown IDs
+    const std::string& exchange(InstrumentId id) const { return entry(id).exchange; }
+
+    /// Symbol of @p id; empty for unknown IDs
+    const std::string& symbol(InstrumentId id) const { return entry(id).symbol; }
+
+    /// Number of registered instruments, UNKNOWN_INSTRUMENT included
+    std::size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+private:
+    /**
+     * @brief Names of one instrument
+     */
+    struct Entry {
+        std::string exchange;  ///< Exchange name
+        std::string symbol;    ///< Instrument symbol
+    };
+
+    static constexpr std::size_t CHUNK_SIZE = 256;  ///< Entries per allocation
+
+    InstrumentRegistry();
+
+    const Entry& entry(InstrumentId id) const;
+    static std::string makeKey(std::string_view exchange, std::string_view symbol);
+
+    std::unique_ptr<Entry[]> m_chunks[MAX_INSTRUMENTS / CHUNK_SIZE];  ///< Stable entry storage
+    std::atomic<std::size_t> m_size{0};                              ///< Published entries
+    std::unordered_map<std::string, InstrumentId> m_ids;             ///< Key to ID; guarded by m_mutex
+    mutable std::mutex m_mutex;                                      ///< Serialises interning
+};
+
+} // namespace GoQuant
@@ -0,0 +1,117 @@
+/**
+ * @file JournalReader.h
+ * @brief Header file for the JournalReader class
+ *
+ * This file defines the memory-mapped reader of the files written by
+ * CaptureJournal.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/CaptureJournal.h"
+#include "core/InstrumentRegistry.h"
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace GoQuant {
+
+/**
+ * @brief A frame read back from a journal
+ */
+struct JournalFrame {
+    std::string_view bytes;    ///< Frame bytes, pointing into the mapping
+    int64_t receiveTimeNs;     ///< Wall-clock receive time, ns since the epoch
+    InstrumentId instrument;   ///< Instrument in this process's registry; UNKNOWN_INSTRUMENT if none
+};
+
+/**
+ * @brief Sequential reader of one journal file
+ *
+ * The whole file is mapped read-only and frames are returned as views into
+ * the mapping, so reading costs no copy and no allocation per frame. The
+ * file's instrument records are resolved into this process's
+ * InstrumentRegistry as they are met, so the IDs of returned frames can be
+ * compared with those of live books.
+ *
+ * A file that ends in a partial record, as one cut short by a crash does,
+ * reads up to its last complete record.
+ */
+class JournalReader {
+public:
+    /**
+     * @brief Opens and maps a journal file
+     *
+     * @param path Journal file written by CaptureJournal
+     * @throws std::runtime_error if the file cannot be mapped or is not a journal
+     */
+    explicit JournalReader(const QString& path);
+
+    /**
+     * @brief Unmaps and closes the file
+     */
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    /**
+     * @brief Reads the next frame
+     *
+     * Views returned earlier stay valid for the lifetime of the reader.
+     *
+     * @param frame Receives the frame
+     * @return bool False at the end of the data
+     */
+    bool next(JournalFrame& frame);
+
+    /**
+     * @brief Returns to the first record
+     */
+    void rewind();
+
+    /**
+     * @brief Moves to a record position returned earlier by position()
+     *
+     * Record headers from the start are walked up to @p position, so the
+     * instrument records before it are resolved as if the file had been read.
+     *
+     * @param position Value of position() from a reader of the same file
+     */
+    void seek(int64_t position);
+
+    /// Wall-clock time the file was created, ns since the epoch
+    int64_t createdTimeNs() const { return m_createdTimeNs; }
+
+    /// Size of the file in bytes
+    int64_t size() const { return m_size; }
+
+    /// Offset of the next record
+    int64_t position() const { return m_position; }
+
+    /**
+     * @brief Lists the journal files at a path in the order they were written
+     *
+     * @param path A journal file, or a directory of them
+     * @return QStringList The file itself, or the directory's .gqj files sorted by name
+     */
+    static QStringList listFiles(const QString& path);
+
+private:
+    QFile m_file;                  ///< Journal file
+    const uchar* m_data = nullptr; ///< Mapping of the whole file
+    int64_t m_size = 0;            ///< Bytes mapped
+    int64_t m_dataStart = 0;       ///< Offset of the first record
+    int64_t m_position = 0;        ///< Offset of the next record
+    int64_t m_createdTimeNs = 0;   ///< From the file header
+    std::unordered_map<uint32_t, InstrumentId> m_instruments;  ///< File IDs to registry IDs
+};
+
+} // namespace GoQuant
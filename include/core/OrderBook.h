@@ -0,0 +1,115 @@
+/**
+ * @file OrderBook.h
+ * @brief Order book data structures shared by the parser and the processor
+ *
+ * This file defines the plain data structures used to represent an L2 order
+ * book. They are kept free of Qt and JSON dependencies so that the parsing
+ * and analytics code can be used outside the Qt event loop.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/FixedPoint.h"
+#include "core/InstrumentRegistry.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Represents a single price level in the order book
+ *
+ * This structure holds the price and quantity information for a single
+ * level in either the ask (sell) or bid (buy) side of the order book, in
+ * the integer units of the owning book's InstrumentSpec.
+ */
+struct OrderBookLevel {
+    Ticks priceTicks;    ///< Price at this level, in ticks
+    Lots quantityLots;   ///< Available quantity at this price, in lots
+};
+
+/**
+ * @brief Kind of L2 message received from the exchange
+ */
+enum class BookAction {
+    Snapshot,  ///< Full book replacing the current state
+    Update,    ///< Level deltas; a zero quantity removes the level
+    None       ///< No book, such as a subscription ack or error event
+};
+
+/**
+ * @brief Represents a complete order book snapshot
+ *
+ * This structure holds the complete state of an order book at a specific
+ * point in time, including all ask and bid levels. Levels are stored in
+ * fixed-point units; use price() and quantity() to convert at the API edge.
+ * The instrument is an interned InstrumentRegistry ID and both timestamps
+ * are binary, so copying a book never allocates for its metadata.
+ */
+struct OrderBook {
+    std::vector<OrderBookLevel> asks;  ///< List of ask (sell) orders
+    std::vector<OrderBookLevel> bids;  ///< List of bid (buy) orders
+    InstrumentId instrument = UNKNOWN_INSTRUMENT;  ///< Interned exchange and symbol
+    std::int64_t exchangeTimeNs = 0;   ///< Exchange timestamp, ns since the Unix epoch; 0 if absent
+    std::int64_t receiveTimeNs = 0;    ///< Local receive time, ns since the Unix epoch
+    InstrumentSpec spec;               ///< Tick and lot scales of the levels
+
+    /// Exchange identifier
+    const std::string& exchange() const {
+        return InstrumentRegistry::instance().exchange(instrument);
+    }
+
+    /// Trading pair symbol
+    const std::string& symbol() const {
+        return InstrumentRegistry::instance().symbol(instrument);
+    }
+
+    /// Price of @p level as a double
+    double price(const OrderBookLevel& level) const {
+        return spec.price.toDouble(level.priceTicks);
+    }
+
+    /// Quantity of @p level as a double
+    double quantity(const OrderBookLevel& level) const {
+        return spec.quantity.toDouble(level.quantityLots);
+    }
+};
+
+/**
+ * @brief Applies one level delta to a sorted book side in place
+ *
+ * The level is located by binary search. A zero quantity removes it, any
+ * other quantity modifies or inserts it. Insertions and removals shift the
+ * tail within the side's reserved capacity, so no allocation takes place
+ * once the side has reached its working depth.
+ *
+ * @param side Book side, asks ascending or bids descending
+ * @param delta Price level and its new total quantity
+ * @param isAsk True if @p side is the ask side
+ */
+inline void applyLevelDelta(std::vector<OrderBookLevel>& side, const OrderBookLevel& delta,
+                            bool isAsk) {
+    auto it = std::lower_bound(side.begin(), side.end(), delta.priceTicks,
+        [isAsk](const OrderBookLevel& level, Ticks price) {
+            return isAsk ? level.priceTicks < price : level.priceTicks > price;
+        });
+
+    bool found = (it != side.end() && it->priceTicks == delta.priceTicks);
+    if (delta.quantityLots == 0) {
+        if (found) {
+            side.erase(it);
+        }
+    } else if (found) {
+        it->quantityLots = delta.quantityLots;
+    } else {
+        side.insert(it, delta);
+    }
+}
+
+} // namespace GoQuant
@@ -0,0 +1,236 @@
+/**
+ * @file OrderBookHistory.h
+ * @brief Header file for the OrderBookHistory class
+ *
+ * This file defines a preallocated ring of order book history that stores
+ * periodic keyframes plus level deltas between consecutive books, and
+ * rebuilds any retained book on demand.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/OrderBook.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Delta-compressed ring buffer of order book history
+ *
+ * History is split into segments. Each segment starts with a full keyframe
+ * book and stores, for every following entry, only the levels that changed
+ * since the previous entry (a zero quantity marks a removed level). When
+ * the ring is full the oldest segment is dropped as a whole and its storage
+ * is reused, so steady-state pushes do not allocate.
+ *
+ * A past book is rebuilt by copying its segment's keyframe and replaying at
+ * most KEYFRAME_INTERVAL - 1 deltas. Sequential scans with forEach() replay
+ * each delta once.
+ */
+class OrderBookHistory {
+public:
+    static constexpr std::size_t DEFAULT_KEYFRAME_INTERVAL = 64;  ///< Entries per segment
+
+    /**
+     * @brief Constructs a history retaining at least @p capacity entries
+     *
+     * @param capacity Minimum number of books retained once the ring is full
+     * @param keyframeInterval Maximum number of entries per keyframe segment
+     * @throws std::invalid_argument if either argument is zero
+     */
+    explicit OrderBookHistory(std::size_t capacity,
+                              std::size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    /**
+     * @brief Appends a book to the history
+     *
+     * A new keyframe is started when the current segment is full or when the
+     * instrument metadata (exchange, symbol, scales) changes.
+     *
+     * @param book Book to record; asks ascending, bids descending
+     */
+    void push(const OrderBook& book);
+
+    /// Number of books currently retained
+    std::size_t size() const { return m_size; }
+
+    /// True if no book has been recorded
+    bool empty() const { return m_size == 0; }
+
+    /// Total number of books pushed since construction or clear()
+    std::uint64_t totalPushed() const { return m_nextSequence; }
+
+    /**
+     * @brief Rebuilds a retained book
+     *
+     * @param index Position in the history, 0 being the oldest retained book
+     * @return OrderBook Reconstructed book
+     * @throws std::out_of_range if @p index >= size()
+     */
+    OrderBook at(std::size_t index) const;
+
+    /**
+     * @brief Rebuilds a retained book into existing storage
+     *
+     * @param index Position in the history, 0 being the oldest retained book
+     * @param out Destination book; its capacity is reused
+     * @throws std::out_of_range if @p index >= size()
+     */
+    void reconstruct(std::size_t index, OrderBook& out) const;
+
+    /**
+     * @brief Replays retained books in order starting at @p first
+     *
+     * The callback receives a reference to a book that is updated in place
+     * between calls; copy it if it must outlive the call.
+     *
+     * @param first Position of the first book to visit
+     * @param callback Invoked as callback(index, book) for each book
+     */
+    template <typename Callback>
+    void forEach(std::size_t first, Callback&& callback) const {
+        forEach(first, m_size, std::forward<Callback>(callback));
+    }
+
+    /**
+     * @brief Replays the retained books at positions [@p first, @p last)
+     *
+     * @param first Position of the first book to visit
+     * @param last Position one past the last book to visit
+     * @param callback Invoked as callback(index, book) for each book
+     */
+    template <typename Callback>
+    void forEach(std::size_t first, std::size_t last, Callback&& callback) const;
+
+    /**
+     * @brief Finds the first retained book at or after an exchange time
+     *
+     * Assumes exchange timestamps are non-decreasing, as the feed delivers
+     * them. Costs a binary search over segments, then over one segment's
+     * entries; no book is rebuilt.
+     *
+     * @param exchangeTimeNs Exchange time in nanoseconds since the epoch
+     * @return std::size_t Position of the book, or size() if all are earlier
+     */
+    std::size_t lowerBound(std::int64_t exchangeTimeNs) const;
+
+    /**
+     * @brief Replays the retained books with exchange time in [@p fromNs, @p toNs)
+     *
+     * @param fromNs Inclusive start, nanoseconds since the epoch
+     * @param toNs Exclusive end, nanoseconds since the epoch
+     * @param callback Invoked as callback(index, book) for each book
+     */
+    template <typename Callback>
+    void forEachInTimeRange(std::int64_t fromNs, std::int64_t toNs, Callback&& callback) const {
+        forEach(lowerBound(fromNs), lowerBound(toNs), std::forward<Callback>(callback));
+    }
+
+    /**
+     * @brief Copies the segments holding positions [@p first, @p last)
+     *
+     * The copy holds whole segments, so it starts at the keyframe of book
+     * @p first and costs a memory copy of at most one segment more than the
+     * range, far less than rebuilding the books. It lets a reader take a
+     * consistent window under a lock and rebuild it after releasing the
+     * lock. The copy is for reading only; do not push to it.
+     *
+     * @param first Position of the first book wanted
+     * @param last Position one past the last book wanted
+     * @param[out] offset Position of book @p first in the copy
+     * @return OrderBookHistory Copy of the covering segments; empty for an
+     *         empty range
+     */
+    OrderBookHistory copyRange(std::size_t first, std::size_t last, std::size_t& offset) const;
+
+    /**
+     * @brief Removes all entries, keeping the allocated storage
+     */
+    void clear();
+
+    /**
+     * @brief Approximate heap memory held by the history, in bytes
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    /**
+     * @brief Per-entry bookkeeping within a segment
+     */
+    struct Entry {
+        std::uint32_t deltaBegin;      ///< Offset of the entry's first delta in Segment::deltas
+        std::uint32_t askDeltas;       ///< Number of ask deltas, stored first
+        std::uint32_t bidDeltas;       ///< Number of bid deltas, stored after the asks
+        std::int64_t exchangeTimeNs;   ///< Exchange timestamp of the entry
+        std::int64_t receiveTimeNs;    ///< Receive timestamp of the entry
+    };
+
+    /**
+     * @brief A keyframe followed by the deltas of subsequent entries
+     */
+    struct Segment {
+        std::uint64_t firstSequence = 0;   ///< Sequence number of the keyframe entry
+        OrderBook keyframe;                ///< Full book of the first entry
+        std::vector<OrderBookLevel> deltas;///< Level deltas of all later entries
+        std::vector<Entry> entries;        ///< One record per entry, keyframe included
+    };
+
+    std::vector<Segment> m_segments;    ///< Ring of segments
+    std::size_t m_keyframeInterval = DEFAULT_KEYFRAME_INTERVAL;  ///< Maximum entries per segment
+    std::size_t m_firstSegment = 0;     ///< Ring index of the oldest live segment
+    std::size_t m_liveSegments = 0;     ///< Number of live segments
+    std::size_t m_size = 0;             ///< Number of retained entries
+    std::uint64_t m_nextSequence = 0;   ///< Sequence number of the next pushed entry
+    OrderBook m_previous;               ///< Last pushed book, the base of the next diff
+
+    /// Empty history without storage, the starting point of copyRange()
+    OrderBookHistory() = default;
+
+    Segment& segmentAt(std::size_t ordinal) { return m_segments[(m_firstSegment + ordinal) % m_segments.size()]; }
+    const Segment& segmentAt(std::size_t ordinal) const { return m_segments[(m_firstSegment + ordinal) % m_segments.size()]; }
+
+    void startSegment(const OrderBook& book);
+    std::size_t findSegment(std::uint64_t sequence) const;
+    static void appendSideDiff(const std::vector<OrderBookLevel>& previous,
+                               const std::vector<OrderBookLevel>& current, bool isAsk,
+                               std::vector<OrderBookLevel>& deltas);
+    static void applyEntry(const Segment& segment, const Entry& entry, OrderBook& book);
+};
+
+template <typename Callback>
+void OrderBookHistory::forEach(std::size_t first, std::size_t last, Callback&& callback) const {
+    last = std::min(last, m_size);
+    if (first >= last) {
+        return;
+    }
+
+    std::uint64_t sequence = segmentAt(0).firstSequence + first;
+    std::size_t ordinal = findSegment(sequence);
+    std::size_t offset = static_cast<std::size_t>(sequence - segmentAt(ordinal).firstSequence);
+
+    OrderBook book;
+    reconstruct(first, book);
+    std::size_t index = first;
+    callback(index++, static_cast<const OrderBook&>(book));
+
+    for (++offset; ordinal < m_liveSegments && index < last; ++ordinal, offset = 0) {
+        const Segment& segment = segmentAt(ordinal);
+        for (; offset < segment.entries.size() && index < last; ++offset) {
+            if (offset == 0) {
+                book = segment.keyframe;
+            }
+            applyEntry(segment, segment.entries[offset], book);
+            callback(index++, static_cast<const OrderBook&>(book));
+        }
+    }
+}
+
+} // namespace GoQuant
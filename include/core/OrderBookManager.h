@@ -0,0 +1,190 @@
+/**
+ * @file OrderBookManager.h
+ * @brief Header file for the OrderBookManager class
+ *
+ * This file defines the multi-instrument book manager, which routes raw
+ * frames by exchange and symbol to per-instrument OrderBookProcessor
+ * instances sharded across a fixed pool of pinned worker threads.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/FixedPoint.h"
+#include "core/OrderBookProcessor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Throughput and load counters of one worker shard
+ */
+struct ShardStats {
+    size_t shard;              ///< Shard index
+    int cpu;                   ///< CPU the worker was asked to run on
+    bool pinned;               ///< True if the affinity request succeeded
+    size_t instruments;        ///< Instruments assigned to the shard
+    uint64_t processed;        ///< Frames applied successfully
+    uint64_t failed;           ///< Frames rejected by the parser or processor
+    size_t queueHighWater;     ///< Largest number of frames waiting at once
+    double busySeconds;        ///< Time spent processing frames
+    double elapsedSeconds;     ///< Time since start(), or length of the last run
+    double messagesPerSecond;  ///< processed / elapsedSeconds
+    double utilization;        ///< busySeconds / elapsedSeconds
+};
+
+/**
+ * @brief Routes order book frames to per-instrument processors on worker shards
+ *
+ * Instruments are registered up front and assigned round-robin to shards.
+ * Each shard owns one worker thread pinned to its own CPU, one inbound
+ * queue and the processors of its instruments, so the only lock a frame
+ * ever meets is its own shard's queue lock. The instrument table is
+ * immutable once the manager is started, which keeps routing lock-free.
+ *
+ * Readers query an instrument through processor(); its query methods read
+ * published snapshots and are safe to call while the shard is running.
+ */
+class OrderBookManager {
+public:
+    /**
+     * @brief Constructs a manager with a fixed number of shards
+     *
+     * @param shardCount Number of worker threads; 0 uses one per hardware thread
+     */
+    explicit OrderBookManager(size_t shardCount = 0);
+
+    /**
+     * @brief Stops the workers after draining their queues
+     */
+    ~OrderBookManager();
+
+    OrderBookManager(const OrderBookManager&) = delete;
+    OrderBookManager& operator=(const OrderBookManager&) = delete;
+
+    /**
+     * @brief Registers an instrument and assigns it to a shard
+     *
+     * @param exchange Exchange name, as it appears in frames
+     * @param symbol Instrument symbol, as it appears in frames
+     * @param spec Tick and lot scales of the instrument
+     * @return OrderBookProcessor& Processor of the instrument
+     * @throws std::logic_error if the manager is running
+     * @throws std::invalid_argument if the instrument is already registered
+     */
+    OrderBookProcessor& addInstrument(const std::string& exchange, const std::string& symbol,
+                                      const InstrumentSpec& spec = InstrumentSpec());
+
+    /**
+     * @brief Starts the shard workers
+     */
+    void start();
+
+    /**
+     * @brief Processes every queued frame, then joins the workers
+     */
+    void stop();
+
+    /**
+     * @brief Queues a frame for the instrument it names
+     *
+     * @param frame Raw UTF-8 frame; copied into the shard queue
+     * @return bool False if the frame names no registered instrument
+     */
+    bool submit(std::string_view frame);
+
+    /**
+     * @brief Queues a frame for an instrument known to the caller
+     *
+     * @param exchange Exchange name
+     * @param symbol Instrument symbol
+     * @param frame Raw UTF-8 frame; copied into the shard queue
+     * @return bool False if the instrument is not registered
+     */
+    bool submit(std::string_view exchange, std::string_view symbol, std::string_view frame);
+
+    /**
+     * @brief Looks up the processor of an instrument
+     *
+     * @return OrderBookProcessor* The processor, or nullptr if not registered
+     */
+    OrderBookProcessor* processor(std::string_view exchange, std::string_view symbol) const;
+
+    /// Number of worker shards
+    size_t shardCount() const { return m_shards.size(); }
+
+    /// Number of registered instruments
+    size_t instrumentCount() const { return m_instruments.size(); }
+
+    /// Frames dropped because they named no registered instrument
+    uint64_t unroutableMessages() const { return m_unroutable.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns throughput and load counters of every shard
+     */
+    std::vector<ShardStats> shardStats() const;
+
+private:
+    /**
+     * @brief A registered instrument and its processor
+     */
+    struct Instrument {
+        std::string exchange;                          ///< Exchange name
+        std::string symbol;                            ///< Instrument symbol
+        size_t shard;                                  ///< Owning shard
+        std::unique_ptr<OrderBookProcessor> processor; ///< Book and analytics
+    };
+
+    /**
+     * @brief A frame waiting in a shard queue
+     */
+    struct Message {
+        OrderBookProcessor* processor;  ///< Destination processor
+        int64_t receiveTimeNs;          ///< Wall-clock time the frame was submitted
+        std::string frame;              ///< Frame bytes; capacity is reused
+    };
+
+    /**
+     * @brief One worker thread with its queue and counters
+     */
+    struct Shard {
+        std::thread worker;                      ///< Worker thread
+        int cpu = -1;                            ///< CPU the worker is pinned to
+        std::atomic<bool> pinned{false};         ///< Whether pinning succeeded
+        size_t instruments = 0;                  ///< Instruments assigned
+        std::mutex mutex;                        ///< Guards the pending queue
+        std::condition_variable wakeup;          ///< Signalled on new frames and stop
+        std::vector<Message> pending;            ///< Queued frames; slots are reused
+        size_t pendingCount = 0;                 ///< Live entries in pending
+        size_t queueHighWater = 0;               ///< Largest pendingCount seen
+        bool stopping = false;                   ///< Set by stop()
+        std::atomic<uint64_t> processed{0};      ///< Frames applied
+        std::atomic<uint64_t> failed{0};         ///< Frames rejected
+        std::atomic<int64_t> busyNanoseconds{0}; ///< Time spent processing
+    };
+
+    std::vector<std::unique_ptr<Instrument>> m_instruments;  ///< Sorted by (exchange, symbol)
+    std::vector<std::unique_ptr<Shard>> m_shards;            ///< Worker shards
+    std::chrono::steady_clock::time_point m_startTime;       ///< When start() was called
+    std::chrono::steady_clock::time_point m_stopTime;        ///< When stop() last returned
+    std::atomic<uint64_t> m_unroutable{0};                   ///< Frames with no instrument
+    bool m_running = false;                                  ///< Whether workers are running
+
+    const Instrument* findInstrument(std::string_view exchange, std::string_view symbol) const;
+    void enqueue(const Instrument& instrument, std::string_view frame);
+    static void runShard(Shard& shard);
+};
+
+} // namespace GoQuant
@@ -0,0 +1,158 @@
+/**
+ * @file OrderBookParser.h
+ * @brief Header file for the OrderBookParser class
+ *
+ * This file defines a single-pass parser that reads raw UTF-8 L2 order book
+ * frames directly into OrderBook storage without building a JSON DOM.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace GoQuant {
+
+/**
+ * @brief Sequencing and integrity fields of an exchange frame
+ *
+ * Filled from the OKX "seqId", "prevSeqId" and "checksum" fields; frames
+ * from the gateway's flat layout leave the defaults.
+ */
+struct FrameSequence {
+    std::int64_t seqId = -1;      ///< Sequence number of the frame; -1 if absent
+    std::int64_t prevSeqId = -1;  ///< Sequence number of the preceding frame; -1 if absent
+    bool hasChecksum = false;     ///< Whether the frame carries a book checksum
+    std::int32_t checksum = 0;    ///< Expected bookChecksum() of the book after the frame
+};
+
+/**
+ * @brief Streaming parser for L2 order book frames
+ *
+ * The parser walks the raw frame exactly once and converts price and quantity
+ * fields straight into tick and lot units of the target book, using the
+ * exact decimal conversion of the instrument's FixedPointScale.
+ * The target book's vectors are cleared, not released, so a book reused
+ * across calls reaches a steady state with no heap allocation. The exchange
+ * and symbol are resolved to an InstrumentId, with the last ID cached so
+ * that a stream of frames for one instrument never touches the registry
+ * lock, and the timestamp is converted to nanoseconds.
+ *
+ * Accepted frame layouts are the gateway's flat book:
+ * @code
+ * {"timestamp":"...","exchange":"OKX","symbol":"BTC-USDT-SWAP",
+ *  "asks":[["95445.5","9.06"],...],"bids":[["95445.4","1.02"],...]}
+ * @endcode
+ * and the native OKX books channel envelope:
+ * @code
+ * {"arg":{"channel":"books","instId":"BTC-USDT-SWAP"},"action":"update",
+ *  "data":[{"asks":[["95445.5","0","0","0"]],"bids":[],"ts":"..."}]}
+ * @endcode
+ * Levels may carry additional trailing elements, prices and quantities may be
+ * JSON strings or numbers, and unknown keys are skipped. The OKX sequence
+ * numbers and checksum are reported through FrameSequence. A frame without an
+ * "action" field is treated as a snapshot. A frame with an "event" field, or
+ * without any "asks" or "bids", carries no book, such as the OKX
+ * {"event":"subscribe",...} ack or an error, and is reported as
+ * BookAction::None.
+ */
+class OrderBookParser {
+public:
+    /**
+     * @brief Parses a raw frame into an order book
+     *
+     * @param frame Raw UTF-8 frame as received from the exchange
+     * @param spec Tick and lot scales of the instrument
+     * @param book Destination book; existing storage is reused. Its
+     *        instrument is UNKNOWN_INSTRUMENT and its exchange time 0 if the
+     *        frame does not name them; its receive time is left at 0.
+     * @param sequence Receives the frame's sequencing fields if not null
+     * @return BookAction Whether the frame is a full snapshot, a delta
+     *         update, or carries no book
+     * @throws std::runtime_error if the frame is malformed
+     */
+    BookAction parse(std::string_view frame, const InstrumentSpec& spec, OrderBook& book,
+                     FrameSequence* sequence = nullptr) const;
+
+    /**
+     * @brief Extracts the exchange and symbol of a frame without parsing levels
+     *
+     * Used to route frames before they are parsed. Top-level keys are
+     * scanned until both fields are known; the OKX envelope yields "OKX" and
+     * its instId.
+     *
+     * @param frame Raw UTF-8 frame as received from the exchange
+     * @param exchange Receives a view of the exchange name
+     * @param symbol Receives a view of the symbol
+     * @return bool False if the frame is malformed or names no symbol
+     */
+    static bool peekInstrument(std::string_view frame, std::string_view& exchange,
+                               std::string_view& symbol);
+
+    /**
+     * @brief Tells a snapshot from an update without parsing levels
+     *
+     * Top-level keys are scanned until "action" is found; OKX sends it
+     * before the data array. A frame without one is a snapshot if it has
+     * levels and BookAction::None otherwise, as in parse().
+     *
+     * @param frame Raw UTF-8 frame as received from the exchange
+     * @param action Receives the frame's action
+     * @return bool False if the frame is malformed
+     */
+    static bool peekAction(std::string_view frame, BookAction& action);
+
+private:
+    /**
+     * @brief Cursor over the frame being parsed
+     */
+    struct Cursor {
+        const char* pos;   ///< Current read position
+        const char* begin; ///< Start of the frame, used for error offsets
+        const char* end;   ///< One past the last byte of the frame
+    };
+
+    /**
+     * @brief What a frame turned out to hold, gathered while parsing it
+     */
+    struct FrameContent {
+        BookAction action = BookAction::Snapshot;  ///< From the "action" field
+        bool hasLevels = false;                    ///< An "asks" or "bids" field was seen
+        bool isEvent = false;                      ///< An "event" field was seen
+    };
+
+    /**
+     * @brief Instrument names found in a frame, viewing the frame bytes
+     */
+    struct InstrumentNames {
+        std::string_view exchange;  ///< Exchange name, empty if absent
+        std::string_view symbol;    ///< Symbol, empty if absent
+    };
+
+    mutable InstrumentId m_lastInstrument = UNKNOWN_INSTRUMENT;  ///< Most recently resolved ID
+
+    InstrumentId resolveInstrument(const InstrumentNames& names) const;
+    static void parseObject(Cursor& cursor, const InstrumentSpec& spec, OrderBook& book,
+                            InstrumentNames& names, FrameContent& content,
+                            FrameSequence& sequence);
+    static void parseArg(Cursor& cursor, InstrumentNames& names);
+    static void skipWhitespace(Cursor& cursor);
+    static void expect(Cursor& cursor, char c);
+    static bool consume(Cursor& cursor, char c);
+    static std::string_view parseString(Cursor& cursor);
+    static std::string_view parseScalar(Cursor& cursor);
+    static std::int64_t parseFixed(Cursor& cursor, const FixedPointScale& scale);
+    static std::int64_t parseInteger(Cursor& cursor);
+    static void parseLevels(Cursor& cursor, const InstrumentSpec& spec,
+                            std::vector<OrderBookLevel>& levels);
+    static void skipValue(Cursor& cursor);
+    [[noreturn]] static void fail(const Cursor& cursor, const char* what);
+};
+
+} // namespace GoQuant
@@ -12,37 +12,198 @@
 
 #pragma once
 
+#include "core/BookSnapshot.h"
+#include "core/DepthSweep.h"
+#include "core/OrderBook.h"
+#include "core/OrderBookHistory.h"
+#include "core/OrderBookParser.h"
+#include "utils/LatencyHistogram.h"
+#include <QMetaType>
 #include <QObject>
-#include <vector>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <vector>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 namespace GoQuant {
 
 /**
- * @brief Represents a single price level in the order book
+ * @brief Execution cost estimate for one order size
+ * 
+ * One entry of an impact curve, see OrderBookProcessor::calculateImpactCurve().
+ */
+struct ImpactEstimate {
+    double quantity;          ///< Requested order size in base currency
+    bool isBuy;               ///< True for buy orders (sweeping the asks)
+    double filledQuantity;    ///< Quantity available within visible depth
+    double vwap;              ///< Average execution price, 0 if nothing filled
+    double impact;            ///< Same value as calculateMarketImpact()
+    double slippage;          ///< Same value as calculateSlippage(); infinity if exhausted
+    bool liquidityExhausted;  ///< True if visible depth cannot fill the order
+};
+
+/**
+ * @brief Book version and derived metrics delivered to analytics subscribers
+ * 
+ * Copying it only copies the snapshot handle, so queued cross-thread
+ * delivery never copies the book itself.
+ */
+struct BookAnalytics {
+    uint64_t version = 0;              ///< Version of the book the metrics were computed on
+    BookSnapshot snapshot;             ///< Zero-copy handle on that book version
+    double quantity = 0.0;             ///< Reference order size of impact and slippage
+    double marketImpact = 0.0;         ///< Buy-side market impact for quantity
+    double slippage = 0.0;             ///< Buy-side slippage for quantity
+    double makerTakerProportion = 0.5; ///< Maker/taker proportion
+};
+
+/**
+ * @brief How a subscription absorbs updates its consumer has not taken yet
+ * 
+ * With Mode::None every update is emitted from the ingest thread as it is
+ * produced; a queued connection to a slow consumer then grows without
+ * bound. The other modes hold undelivered updates in a bounded mailbox
+ * instead and deliver them from the subscription's own thread:
  * 
- * This structure holds the price and quantity information for a single
- * level in either the ask (sell) or bid (buy) side of the order book.
+ * - LatestOnly keeps one update; a newer one replaces it (counted as dropped).
+ * - Depth keeps the newest @c depth updates; the oldest is evicted when full.
+ * - TimeBucket merges updates that fall in the same @c bucketNs interval
+ *   into the latest of them, keeping up to @c depth buckets.
+ * 
+ * Every pending update pins its book version, so depths well below
+ * BookPublisher::DEFAULT_SLOTS keep the publisher from skipping versions.
+ */
+struct ConflationPolicy {
+    enum class Mode {
+        None,        ///< Emit every update on the ingest thread
+        LatestOnly,  ///< Keep only the newest undelivered update
+        Depth,       ///< Keep the newest N undelivered updates
+        TimeBucket   ///< Merge undelivered updates per time interval
+    };
+
+    Mode mode = Mode::None;  ///< Conflation mode
+    size_t depth = 0;        ///< Mailbox capacity for Depth and TimeBucket
+    int64_t bucketNs = 0;    ///< Bucket width for TimeBucket
+
+    /// Every update, emitted on the ingest thread
+    static ConflationPolicy none() { return ConflationPolicy(); }
+
+    /// Only the newest undelivered update
+    static ConflationPolicy latestOnly() { return {Mode::LatestOnly, 1, 0}; }
+
+    /// The newest @p n undelivered updates
+    static ConflationPolicy newest(size_t n) { return {Mode::Depth, n > 0 ? n : 1, 0}; }
+
+    /// The latest update of each @p seconds interval, up to @p n intervals
+    static ConflationPolicy timeBucket(double seconds, size_t n = 4) {
+        return {Mode::TimeBucket, n > 0 ? n : 1, static_cast<int64_t>(seconds * 1e9)};
+    }
+};
+
+/**
+ * @brief Sequence and checksum health of one instrument's feed
  */
-struct OrderBookLevel {
-    double price;    ///< Price at this level
-    double quantity; ///< Available quantity at this price
+struct SyncStats {
+    bool synced;                   ///< False while waiting for a resync snapshot
+    uint64_t sequenceGaps;         ///< Updates whose prevSeqId did not follow the book
+    uint64_t checksumMismatches;   ///< Updates after which the book checksum was wrong
+    uint64_t resyncs;              ///< Completed resyncs
+    int64_t lastResyncNs;          ///< Duration of the last resync
+    int64_t maxResyncNs;           ///< Longest resync
+    double meanResyncNs;           ///< Mean resync duration
+    size_t bufferedFrames;         ///< Updates currently held for replay
+    uint64_t droppedFrames;        ///< Updates discarded because the buffer was full
 };
 
 /**
- * @brief Represents a complete order book snapshot
+ * @brief One consumer's rate-limited feed of BookAnalytics
  * 
- * This structure holds the complete state of an order book at a specific
- * point in time, including all ask and bid levels.
+ * Created by OrderBookProcessor::subscribeAnalytics() and owned by the
+ * processor, though not as its QObject child. Updates are produced at most
+ * maxRate() times per second, always for the latest book version, and
+ * delivered according to the subscription's ConflationPolicy.
+ * 
+ * Conflated updates are emitted on the thread the subscription has
+ * affinity with, initially the one that subscribed. If that thread runs
+ * no event loop or is not the consumer's, call moveToThread() with the
+ * consumer's thread. At most one
+ * delivery is queued at a time, so a slow consumer costs the ingest thread
+ * one short mailbox lock per update.
+ */
+class AnalyticsSubscription : public QObject {
+    Q_OBJECT
+
+public:
+    /// Maximum emission rate in Hz; 0 means every book version
+    double maxRate() const { return m_maxRate; }
+
+    /// How undelivered updates are absorbed
+    const ConflationPolicy& policy() const { return m_policy; }
+
+    /// Updates emitted to the consumer
+    uint64_t deliveredUpdates() const { return m_delivered.load(std::memory_order_relaxed); }
+
+    /// Undelivered updates replaced or evicted by newer ones
+    uint64_t droppedUpdates() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// Undelivered updates folded into a newer one of the same time bucket
+    uint64_t mergedUpdates() const { return m_merged.load(std::memory_order_relaxed); }
+
+signals:
+    /// Emitted with the latest book version and its metrics
+    void analyticsUpdated(const GoQuant::BookAnalytics& analytics);
+
+private:
+    friend class OrderBookProcessor;
+
+    /**
+     * @brief An undelivered update and the time bucket it belongs to
+     */
+    struct PendingUpdate {
+        BookAnalytics analytics;  ///< The update
+        int64_t bucket;           ///< Time bucket index, TimeBucket mode only
+    };
+
+    AnalyticsSubscription(double maxRateHz, const ConflationPolicy& policy);
+
+    /**
+     * @brief Emits or enqueues an update; called on the ingest thread
+     * 
+     * @param analytics Update to deliver
+     * @param nowNs Steady-clock time of the update
+     */
+    void offer(const BookAnalytics& analytics, int64_t nowNs);
+
+    /**
+     * @brief Emits every pending update; runs on the subscription's thread
+     */
+    void deliverPending();
+
+    double m_maxRate;               ///< Maximum emission rate in Hz
+    int64_t m_minIntervalNs;        ///< Minimum time between emissions
+    int64_t m_lastEmitNs;           ///< Steady-clock time of the last emission
+    ConflationPolicy m_policy;      ///< How undelivered updates are absorbed
+
+    std::mutex m_mailboxMutex;                ///< Guards m_pending
+    std::vector<PendingUpdate> m_pending;     ///< Undelivered updates, oldest first
+    std::vector<PendingUpdate> m_delivering;  ///< Batch being emitted; swapped with m_pending
+    std::atomic<uint64_t> m_delivered{0};     ///< Updates emitted
+    std::atomic<uint64_t> m_dropped{0};       ///< Updates replaced or evicted
+    std::atomic<uint64_t> m_merged{0};        ///< Updates merged into a newer one
+};
+
+/**
+ * @brief Latency of each stage of OrderBookProcessor::processRawMessage()
  */
-struct OrderBook {
-    std::vector<OrderBookLevel> asks;  ///< List of ask (sell) orders
-    std::vector<OrderBookLevel> bids;  ///< List of bid (buy) orders
-    std::string timestamp;             ///< ISO format timestamp
-    std::string exchange;              ///< Exchange identifier
-    std::string symbol;                ///< Trading pair symbol
+struct ProcessingStageLatency {
+    LatencyHistogram parse;    ///< Parsing the frame into the parse buffer
+    LatencyHistogram apply;    ///< Snapshot swap or delta application, checksum included
+    LatencyHistogram record;   ///< History append and maker/taker bookkeeping
+    LatencyHistogram publish;  ///< Version publication and analytics fan-out
 };
 
 /**
@@ -51,7 +212,15 @@ struct OrderBook {
  * This class handles the processing of order book updates and provides
  * methods for calculating various market metrics such as market impact,
  * slippage, and maker/taker proportions. It maintains a history of order
- * book snapshots for analysis and emits signals when updates occur.
+ * book snapshots for analysis and delivers rate-limited analytics updates
+ * to subscribers (see subscribeAnalytics()).
+ *
+ * Messages must be processed from a single ingest thread. Every committed
+ * book is published as an immutable BookVersion, and all query methods read
+ * the latest version through a BookSnapshot, so they are safe to call from
+ * any thread and neither block nor are blocked by the ingest thread. History
+ * queries copy the segments they need under a short lock and rebuild books
+ * after releasing it.
  */
 class OrderBookProcessor : public QObject {
     Q_OBJECT
@@ -68,16 +237,82 @@ public:
     /**
      * @brief Processes incoming order book data
      * 
+     * Snapshots replace the current book; messages with "action": "update"
+     * are applied in place as level deltas.
+     * 
      * @param data JSON object containing order book data
      */
     void processOrderBook(const nlohmann::json& data);
 
+    /**
+     * @brief Processes a raw order book frame without building a JSON DOM
+     * 
+     * Frames carrying OKX sequence numbers are checked for gaps, and frames
+     * carrying a checksum are verified against the updated book. On either
+     * failure the book stops updating, resyncRequested() is emitted, and
+     * later updates are buffered until the next snapshot, after which those
+     * that follow it are replayed.
+     * 
+     * @param frame Raw UTF-8 frame as received from the exchange
+     * @param receiveTimeNs Local receive time in nanoseconds since the epoch;
+     *                      0 stamps the frame with the current wall clock
+     */
+    void processRawMessage(std::string_view frame, int64_t receiveTimeNs = 0);
+
+    /**
+     * @brief Sets the tick and lot scales used for incoming levels
+     * 
+     * Defaults to 1e-8 for both, which represents any exchange decimal
+     * exactly. Set the instrument's real tick and lot size for compact units.
+     * 
+     * The spec is read without synchronisation while frames are processed,
+     * so call this from the ingest thread, or before ingest starts.
+     * 
+     * @param spec Fixed-point scales of the instrument
+     */
+    void setInstrumentSpec(const InstrumentSpec& spec);
+
+    /**
+     * @brief Starts or stops timing the stages of raw frame processing
+     * 
+     * Off by default, in which case it costs one branch per stage. The
+     * histograms are written on the ingest thread without synchronisation,
+     * so call this from the ingest thread and read them there, or once
+     * ingest has stopped.
+     * 
+     * @param latency Histograms to record into, or nullptr to stop timing
+     */
+    void setStageLatency(ProcessingStageLatency* latency);
+
     /**
      * @brief Retrieves the most recent order book snapshot
      * 
-     * @return OrderBook Current order book state
+     * @return OrderBook Copy of the current order book state
      */
     OrderBook getLatestOrderBook() const;
+
+    /**
+     * @brief Returns a zero-copy handle on the latest published book version
+     * 
+     * The handle keeps its version alive and unchanged until it is destroyed,
+     * so several queries on it see one consistent book.
+     * 
+     * @return BookSnapshot Handle tagged with the version number
+     */
+    BookSnapshot acquireSnapshot() const;
+
+    /**
+     * @brief Number of book versions that could not be published because
+     *        readers held every spare slot
+     */
+    uint64_t getSkippedPublications() const;
+
+    /**
+     * @brief Returns sequence gap, checksum and resync counters; safe from any thread
+     * 
+     * @return SyncStats Current counters
+     */
+    SyncStats getSyncStats() const;
     
     /**
      * @brief Calculates market impact for a given order size
@@ -96,6 +331,30 @@ public:
      * @return double Slippage as a percentage of mid price
      */
     double calculateSlippage(double quantity, bool isBuy) const;
+
+    /**
+     * @brief Calculates impact, slippage and VWAP for many order sizes at once
+     * 
+     * All sizes are evaluated against one consistent book version. Sizes in ascending order are served by a single
+     * forward sweep; other orders use the cumulative depth index.
+     * 
+     * @param quantities Order sizes in base currency
+     * @param isBuy True for buy orders, false for sell orders
+     * @return std::vector<ImpactEstimate> One estimate per order size, in input order
+     */
+    std::vector<ImpactEstimate> calculateImpactCurve(const std::vector<double>& quantities,
+                                                     bool isBuy) const;
+
+    /**
+     * @brief Calculates an impact curve with a side per order size
+     * 
+     * @param quantities Order sizes in base currency
+     * @param isBuy Side of each order; must have the same length as @p quantities
+     * @return std::vector<ImpactEstimate> One estimate per order size, in input order
+     * @throws std::invalid_argument if the lengths differ
+     */
+    std::vector<ImpactEstimate> calculateImpactCurve(const std::vector<double>& quantities,
+                                                     const std::vector<bool>& isBuy) const;
     
     /**
      * @brief Calculates the proportion of maker vs taker orders
@@ -104,34 +363,204 @@ public:
      */
     double calculateMakerTakerProportion() const;
 
+    /**
+     * @brief Returns the number of order books retained in the history
+     * 
+     * @return size_t Number of retained books
+     */
+    size_t getHistorySize() const;
+
+    /**
+     * @brief Rebuilds a past order book from the history
+     * 
+     * @param index Position in the history, 0 being the oldest retained book
+     * @return OrderBook Reconstructed book
+     */
+    OrderBook getHistoricalOrderBook(size_t index) const;
+
+    /**
+     * @brief Finds the first retained book at or after an exchange time
+     * 
+     * @param exchangeTimeNs Exchange time in nanoseconds since the epoch
+     * @return size_t History position, or getHistorySize() if every book is earlier
+     */
+    size_t findHistoryIndex(int64_t exchangeTimeNs) const;
+
+    /**
+     * @brief Rebuilds every retained book with exchange time in [@p fromNs, @p toNs)
+     * 
+     * @param fromNs Inclusive start, nanoseconds since the epoch
+     * @param toNs Exclusive end, nanoseconds since the epoch
+     * @return std::vector<OrderBook> Reconstructed books, oldest first
+     */
+    std::vector<OrderBook> getHistoricalRange(int64_t fromNs, int64_t toNs) const;
+
+    /**
+     * @brief Subscribes to consolidated analytics updates
+     * 
+     * Metrics are only computed for book versions at which at least one
+     * subscription is due, and once per version however many are due.
+     * Slots connected with Qt::DirectConnection run on the ingest thread and
+     * must not subscribe or unsubscribe.
+     * 
+     * @param maxRateHz Maximum updates per second; 0 for every book version
+     * @param policy How updates the consumer has not taken yet are absorbed
+     * @return AnalyticsSubscription* Subscription owned by the processor;
+     *         parentless, so it can be moved to the consumer's thread
+     */
+    AnalyticsSubscription* subscribeAnalytics(double maxRateHz = 0.0,
+                                              const ConflationPolicy& policy = ConflationPolicy());
+
+    /**
+     * @brief Cancels a subscription; it is deleted once control returns to its event loop
+     * 
+     * @param subscription Subscription returned by subscribeAnalytics()
+     */
+    void unsubscribeAnalytics(AnalyticsSubscription* subscription);
+
 signals:
-    /// Emitted when the order book is updated
-    void orderBookUpdated(const OrderBook& orderBook);
-    /// Emitted when market impact is calculated
-    void marketImpactUpdated(double impact);
-    /// Emitted when slippage is calculated
-    void slippageUpdated(double slippage);
-    /// Emitted when maker/taker proportion is calculated
-    void makerTakerProportionUpdated(double proportion);
+    /**
+     * @brief Emitted on the ingest thread when the book needs a fresh snapshot
+     * 
+     * Connect it to whatever re-requests the snapshot from the exchange,
+     * typically a resubscription of the instrument's channel.
+     */
+    void resyncRequested();
 
 private:
     OrderBook m_currentOrderBook;              ///< Current order book state
-    std::deque<OrderBook> m_orderBookHistory;  ///< Historical order book snapshots
-    mutable std::mutex m_mutex;                ///< Mutex for thread safety
+    OrderBook m_parseBuffer;                   ///< Reused destination for incoming frames
+    OrderBookParser m_parser;                  ///< Streaming parser for raw frames
+    InstrumentSpec m_instrumentSpec;           ///< Tick and lot scales for incoming levels
+    BookPublisher m_publisher;                 ///< Published immutable versions of the book
+    uint64_t m_version = 0;                    ///< Version number of the current book
+    OrderBookHistory m_orderBookHistory;       ///< Delta-compressed historical snapshots
+
+    /**
+     * @brief Maker and changed-level counts contributed by one consecutive book pair
+     */
+    struct MakerTakerSample {
+        std::uint32_t makers;   ///< Changed levels classified as maker activity
+        std::uint32_t changes;  ///< Levels whose price changed
+    };
+
+    std::vector<MakerTakerSample> m_makerTakerWindow;  ///< Ring of the last HISTORY_SIZE - 1 pair samples
+    size_t m_makerTakerNext = 0;               ///< Ring slot of the next sample
+    size_t m_makerTakerSamples = 0;            ///< Number of samples in the ring
+    size_t m_makerCount = 0;                   ///< Sum of makers over the ring
+    size_t m_changeCount = 0;                  ///< Sum of changes over the ring
+    std::vector<OrderBookLevel> m_previousAsks;  ///< Asks of the previously committed book
+    std::vector<OrderBookLevel> m_previousBids;  ///< Bids of the previously committed book
+    mutable std::mutex m_mutex;                ///< Guards the history
+    std::vector<AnalyticsSubscription*> m_subscriptions;  ///< Active analytics subscriptions
+    std::mutex m_subscriptionMutex;            ///< Guards m_subscriptions
+
+    /**
+     * @brief An update held back while the book waits for a snapshot
+     */
+    struct BufferedFrame {
+        std::string frame;      ///< Raw frame bytes
+        int64_t receiveTimeNs;  ///< Original receive time
+    };
+
+    FrameSequence m_frameSequence;             ///< Sequencing fields of the frame being processed
+    int64_t m_lastSeqId = -1;                  ///< seqId of the last applied frame; -1 if unsequenced
+    std::atomic<bool> m_awaitingSnapshot{false};  ///< Set between a gap and the next snapshot
+    int64_t m_resyncStartNs = 0;               ///< Steady-clock time the current resync began
+    std::deque<BufferedFrame> m_resyncBuffer;  ///< Updates received while awaiting a snapshot
+    std::atomic<size_t> m_bufferedFrames{0};   ///< Size of m_resyncBuffer, for readers
+    std::atomic<uint64_t> m_droppedFrames{0};  ///< Updates evicted from a full buffer
+    std::atomic<uint64_t> m_sequenceGaps{0};   ///< Detected sequence gaps
+    std::atomic<uint64_t> m_checksumMismatches{0};  ///< Detected checksum mismatches
+    std::atomic<uint64_t> m_resyncs{0};        ///< Completed resyncs
+    std::atomic<int64_t> m_lastResyncNs{0};    ///< Duration of the last resync
+    std::atomic<int64_t> m_maxResyncNs{0};     ///< Longest resync
+    std::atomic<int64_t> m_totalResyncNs{0};   ///< Sum of resync durations
+    ProcessingStageLatency* m_stageLatency = nullptr;  ///< Stage timing destination, if enabled
     
-    static constexpr size_t HISTORY_SIZE = 1000;  ///< Maximum history size
+    static constexpr size_t HISTORY_SIZE = 1000;  ///< Books used for the maker/taker estimate
+    static constexpr size_t HISTORY_CAPACITY = 1 << 16;  ///< Books retained in the history ring
+    static constexpr size_t RESERVED_DEPTH = 512; ///< Levels reserved per side
+    static constexpr double ANALYTICS_QUANTITY = 100.0;  ///< Reference size of published metrics
+    static constexpr size_t MAX_RESYNC_BUFFER = 4096;    ///< Updates held while awaiting a snapshot
     
     /**
-     * @brief Updates the current order book with new data
+     * @brief Parses a frame, checks its sequence and applies or buffers it
      * 
-     * @param data JSON object containing order book data
+     * @param frame Raw UTF-8 frame
+     * @param receiveTimeNs Local receive time in nanoseconds since the epoch
+     */
+    void processFrame(std::string_view frame, int64_t receiveTimeNs);
+
+    /**
+     * @brief Publishes the book held in m_parseBuffer and notifies due subscribers
+     * 
+     * @param action Whether m_parseBuffer holds a snapshot or level deltas
+     * @param sequence Sequencing fields of the frame, or nullptr if it has none
+     * @return bool False if the updated book failed the frame's checksum and
+     *         was not published
+     */
+    bool commitOrderBook(BookAction action, const FrameSequence* sequence = nullptr);
+
+    /**
+     * @brief Stops applying updates and asks for a fresh snapshot
      */
-    void updateOrderBook(const nlohmann::json& data);
+    void beginResync();
 
     /**
-     * @brief Maintains the order book history within size limits
+     * @brief Records the resync time and replays the updates that follow the snapshot
      */
-    void maintainHistory();
+    void completeResync();
+
+    /**
+     * @brief Holds an update for replay once the snapshot arrives
+     * 
+     * @param frame Raw UTF-8 frame
+     * @param receiveTimeNs Local receive time in nanoseconds since the epoch
+     */
+    void bufferFrame(std::string_view frame, int64_t receiveTimeNs);
+
+    /**
+     * @brief Records the time since @p start in a stage histogram if stage timing is on
+     * 
+     * @param stage Histogram of the stage that just ended
+     * @param start Steady-clock time the stage began
+     * @return int64_t Current steady-clock time, the start of the next stage; 0 if timing is off
+     */
+    int64_t endStage(LatencyHistogram ProcessingStageLatency::*stage, int64_t start);
+
+    /**
+     * @brief Applies a parsed delta message to the current book in place
+     * 
+     * @param deltas Parsed update whose levels carry new total quantities
+     */
+    void applyDeltas(const OrderBook& deltas);
+
+    /**
+     * @brief Folds the newest book change into the running maker/taker counters
+     * 
+     * Called on the ingest thread after the current book was updated.
+     */
+    void updateMakerTakerCounters();
+
+    /**
+     * @brief Computes analytics for the latest version and emits them to due subscribers
+     */
+    void publishAnalytics();
+
+    /**
+     * @brief Converts a sweep of a published book into an ImpactEstimate
+     * 
+     * @param version Book version that was swept
+     * @param quantity Requested order size in base currency
+     * @param quantityLots Requested order size in lots
+     * @param isBuy True if the asks were swept
+     * @param sweep Result of sweeping the side
+     */
+    static ImpactEstimate makeEstimate(const BookVersion& version, double quantity,
+                                       double quantityLots, bool isBuy, const SweepResult& sweep);
 };
 
-} // namespace GoQuant 
\ No newline at end of file
+} // namespace GoQuant
+
+Q_DECLARE_METATYPE(GoQuant::BookAnalytics) 
\ No newline at end of file
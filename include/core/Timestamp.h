@@ -0,0 +1,61 @@
+/**
+ * @file Timestamp.h
+ * @brief Binary timestamps for order book messages
+ *
+ * This file declares the conversion of exchange timestamp text into int64
+ * nanoseconds since the Unix epoch, the local wall clock used to stamp
+ * message receipt in the same unit, and the steady clock used for durations.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace GoQuant {
+
+/// Nanoseconds in a UTC day
+constexpr std::int64_t NS_PER_DAY = 86400LL * 1000000000LL;
+
+/**
+ * @brief Parses an exchange timestamp into nanoseconds since the Unix epoch
+ *
+ * Accepts integer epoch times, whose unit is inferred from the digit count
+ * (up to 10 digits seconds, 13 milliseconds, 16 microseconds, otherwise
+ * nanoseconds), and ISO 8601 UTC date-times such as
+ * "2024-03-20T10:00:00.123Z" or "2024-03-20T12:00:00+02:00". Epoch times
+ * beyond the int64 nanosecond range are rejected.
+ *
+ * @param text Timestamp text, without surrounding quotes
+ * @param nanoseconds Receives the time in nanoseconds since the epoch
+ * @return bool False if the text is not a supported timestamp
+ */
+bool parseTimestamp(std::string_view text, std::int64_t& nanoseconds);
+
+/**
+ * @brief UTC day of a time, in days since the Unix epoch
+ *
+ * Rounds down, so times before the epoch fall on negative days.
+ *
+ * @param timeNs Nanoseconds since the epoch
+ */
+std::int64_t utcDay(std::int64_t timeNs);
+
+/**
+ * @brief Current wall-clock time in nanoseconds since the Unix epoch
+ */
+std::int64_t wallClockNanoseconds();
+
+/**
+ * @brief Current steady-clock time in nanoseconds
+ *
+ * Monotonic, with an unspecified epoch; use it for durations, rates and
+ * ages, never as a timestamp.
+ */
+std::int64_t steadyNanoseconds();
+
+} // namespace GoQuant
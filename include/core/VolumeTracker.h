@@ -0,0 +1,121 @@
+/**
+ * @file VolumeTracker.h
+ * @brief Header file for the VolumeTracker class
+ *
+ * This file defines the rolling-window trading volume of one exchange
+ * account and the fee tier it qualifies for.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "core/FeeSchedule.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Rolling 30-day trading volume of one account and its fee tier
+ *
+ * Fills are added to a circular array of UTC day buckets. The tier follows
+ * the exchanges' rule: it is set by the volume of the completed days of the
+ * window before the current day, so it only moves when the day rolls over.
+ * A rollover adds the finished day to the window total and subtracts the day
+ * that leaves it, then steps the tier up or down from where it was, so the
+ * cost of a fill or a new day does not depend on the fill history.
+ *
+ * Volumes are kept in whole cents, so the running total is exact however
+ * many days roll through it.
+ */
+class VolumeTracker {
+public:
+    static constexpr int DEFAULT_WINDOW_DAYS = 30;  ///< Window exchanges use for fee tiers
+
+    /**
+     * @brief Constructs a tracker with an empty window at day 0
+     *
+     * @param schedule Fee schedule the tiers come from
+     * @param id (Exchange, product) schedule of the account
+     * @param windowDays Completed days that set the tier
+     * @throws std::invalid_argument if @p schedule is null, @p id is not one
+     *         of its schedules or @p windowDays is not positive
+     */
+    VolumeTracker(std::shared_ptr<const FeeSchedule> schedule, FeeScheduleId id,
+                  int windowDays = DEFAULT_WINDOW_DAYS);
+
+    /**
+     * @brief Restarts the window at the day of @p timeNs
+     *
+     * @param timeNs Current time, in nanoseconds since the epoch
+     * @param priorVolume Volume of the window before that day, in USD, spread
+     *        evenly over its days so that it rolls off gradually
+     * @throws std::invalid_argument if @p priorVolume is negative
+     */
+    void reset(int64_t timeNs, double priorVolume = 0.0);
+
+    /**
+     * @brief Moves the clock to the day of @p timeNs, rolling the window
+     *
+     * Earlier times leave the clock where it is.
+     *
+     * @return bool True if the tier changed
+     */
+    bool advanceTo(int64_t timeNs);
+
+    /**
+     * @brief Adds an executed or simulated fill
+     *
+     * Advances the clock to the fill first. A late fill on a completed day
+     * still in the window updates the tier at once; older fills are ignored.
+     *
+     * @param timeNs Time of the fill, in nanoseconds since the epoch
+     * @param notional Traded value in USD
+     * @return bool True if the tier changed
+     * @throws std::invalid_argument if @p notional is negative
+     */
+    bool recordFill(int64_t timeNs, double notional);
+
+    /// Current tier within the schedule
+    std::uint32_t tier() const { return m_tier; }
+
+    /// Volume of the completed days of the window, in USD
+    double windowVolume() const { return static_cast<double>(m_windowCents) / 100.0; }
+
+    /// Volume of the current day so far, in USD
+    double todayVolume() const { return static_cast<double>(m_buckets[slot(m_day)]) / 100.0; }
+
+    /// Current UTC day, in days since the epoch
+    int64_t day() const { return m_day; }
+
+    /// Completed days that set the tier
+    int windowDays() const { return m_windowDays; }
+
+    /// (Exchange, product) schedule of the account
+    FeeScheduleId scheduleId() const { return m_id; }
+
+    /// Fee schedule the tiers come from
+    const std::shared_ptr<const FeeSchedule>& schedule() const { return m_schedule; }
+
+private:
+    /// Bucket of @p day in the ring
+    std::size_t slot(int64_t day) const;
+
+    /// Steps the tier to match the window total; returns true if it changed
+    bool updateTier();
+
+    std::shared_ptr<const FeeSchedule> m_schedule;  ///< Fee tiers
+    FeeScheduleId m_id;                              ///< Schedule of the account
+    int m_windowDays;                                ///< Completed days in the window
+    std::vector<int64_t> m_buckets;   ///< Cents per day; the window plus the current day
+    int64_t m_day = 0;                ///< Current UTC day
+    int64_t m_windowCents = 0;        ///< Sum of the completed days in the window
+    std::uint32_t m_tier = 0;         ///< Tier of m_windowCents
+};
+
+} // namespace GoQuant
@@ -4,6 +4,8 @@
  * 
  * This file defines the WebSocketClient class for handling WebSocket connections
  * to cryptocurrency exchange APIs and processing real-time market data streams.
+ * Socket I/O runs on a dedicated thread and frames are handed to a separate
+ * processing thread through a lock-free ring.
  * 
  * @author GoQuant Team
  * @version 1.0
@@ -12,32 +14,79 @@
 
 #pragma once
 
+#include "core/CaptureJournal.h"
+#include "utils/SpscRing.h"
+#include <QByteArray>
 #include <QObject>
+#include <QStringEncoder>
+#include <QThread>
 #include <QWebSocket>
 #include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
-#include <nlohmann/json.hpp>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
 
 namespace GoQuant {
 
+/**
+ * @brief Queue and handoff counters of a WebSocketClient
+ */
+struct FeedStats {
+    uint64_t framesReceived;   ///< Frames read from the socket
+    uint64_t bytesReceived;    ///< UTF-8 payload bytes read from the socket
+    uint64_t framesProcessed;  ///< Frames passed to the callback without error
+    uint64_t framesFailed;     ///< Frames whose callback threw
+    uint64_t framesDropped;    ///< Frames discarded because the ring was full
+    size_t queueDepth;         ///< Frames waiting at the time of the call
+    size_t queueHighWater;     ///< Largest number of frames waiting at once
+    size_t queueCapacity;      ///< Ring size
+    double meanHandoffNs;      ///< Mean time from socket read to start of processing
+    int64_t maxHandoffNs;      ///< Worst time from socket read to start of processing
+};
+
 /**
  * @brief WebSocket client for real-time market data streaming
  * 
  * This class provides a Qt-based WebSocket client implementation for connecting
  * to cryptocurrency exchange WebSocket APIs. It handles connection management,
  * message processing, and error handling.
+ *
+ * The socket lives on a dedicated I/O thread whose only job is to copy each
+ * frame into a bounded single-producer/single-consumer ring. A processing
+ * thread drains the ring and invokes the frame callback, so neither a slow
+ * callback nor a busy UI event loop delays socket reads. When the ring is
+ * full new frames are dropped and counted rather than blocking the reader.
+ * Signals are emitted from the I/O thread and reach receivers on other
+ * threads through queued connections.
+ *
+ * Binary frames are queued by sharing their QByteArray, without a copy.
+ * Text frames, which QWebSocket only delivers as UTF-16, are encoded to
+ * UTF-8 once, straight into the reused buffer of their ring slot.
+ *
+ * In capture mode every frame that enters the ring is also handed to a
+ * CaptureJournal, which records it on its own writer thread.
  */
 class WebSocketClient : public QObject {
     Q_OBJECT
 
 public:
+    /// Default number of frames the handoff ring can hold
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
     /**
      * @brief Constructs a new WebSocketClient instance
      * 
      * @param parent Parent QObject for Qt signal/slot system
+     * @param queueCapacity Frames the handoff ring can hold; rounded up to a power of two
      */
-    explicit WebSocketClient(QObject *parent = nullptr);
+    explicit WebSocketClient(QObject *parent = nullptr,
+                             size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
     ~WebSocketClient();
 
     /**
@@ -52,6 +101,14 @@ public:
      */
     void disconnect();
 
+    /**
+     * @brief Reopens the connection to the last URL, so the feed resends its snapshot
+     * 
+     * Used to resync a book after a sequence gap or checksum mismatch.
+     * Frames already queued are still delivered.
+     */
+    void reconnect();
+
     /**
      * @brief Checks if the client is currently connected
      * 
@@ -60,18 +117,64 @@ public:
     bool isConnected() const;
 
     /**
-     * @brief Callback function type for processing received messages
+     * @brief Callback function type for processing received frames
+     * 
+     * The callback runs on the processing thread and receives the raw UTF-8
+     * frame together with its wall-clock receive time in nanoseconds since
+     * the epoch. The view is only valid for the duration of the call.
+     */
+    using FrameCallback = std::function<void(std::string_view frame, int64_t receiveTimeNs)>;
+
+    /**
+     * @brief Sets the callback function for handling incoming frames
+     * 
+     * Must be called before connect().
+     * 
+     * @param callback Function to be called on the processing thread for each frame
+     */
+    void setFrameCallback(FrameCallback callback);
+
+    /**
+     * @brief Returns queue depth and handoff latency counters
+     * 
+     * Safe to call from any thread.
+     * 
+     * @return FeedStats Current counters
+     */
+    FeedStats stats() const;
+
+    /**
+     * @brief Starts recording every queued frame to a capture journal
      * 
-     * The callback receives parsed JSON messages from the WebSocket connection.
+     * Replaces any journal already running, which is flushed and closed.
+     * Must not be called from a slot connected to this client's signals
+     * with a direct connection, since it waits for the I/O thread.
+     * 
+     * @param config Directory, rotation limits and queue size of the journal
+     * @throws std::runtime_error if the first journal file cannot be created
+     */
+    void startCapture(const CaptureConfig &config);
+
+    /**
+     * @brief Stops recording and closes the journal
+     * 
+     * Frames already handed to the journal are written before it closes.
+     */
+    void stopCapture();
+
+    /**
+     * @brief Checks if capture mode is on
      */
-    using MessageCallback = std::function<void(const nlohmann::json&)>;
+    bool isCapturing() const;
 
     /**
-     * @brief Sets the callback function for handling incoming messages
+     * @brief Returns the counters of the running journal
+     * 
+     * Safe to call from any thread.
      * 
-     * @param callback Function to be called when a message is received
+     * @return CaptureStats Current counters; all zero if capture is off
      */
-    void setMessageCallback(MessageCallback callback);
+    CaptureStats captureStats() const;
 
 signals:
     /// Emitted when the WebSocket connection is established
@@ -81,35 +184,109 @@ signals:
     /// Emitted when a WebSocket error occurs
     void error(const QString &error);
 
-private slots:
+private:
+    /**
+     * @brief A frame waiting in the handoff ring
+     */
+    struct RawFrame {
+        std::string text;           ///< Encoded text frame; capacity is reused across laps
+        QByteArray binary;          ///< Binary frame, shared with the socket's buffer
+        bool isBinary = false;      ///< Which of the two holds the frame
+        int64_t receiveTimeNs = 0;  ///< Wall-clock receive time
+        int64_t enqueueTicks = 0;   ///< Steady-clock time the frame entered the ring
+
+        /// The frame bytes, whichever buffer holds them
+        std::string_view view() const {
+            return isBinary ? std::string_view(binary.constData(), static_cast<size_t>(binary.size()))
+                            : std::string_view(text);
+        }
+    };
+
     /**
-     * @brief Handles successful WebSocket connection
+     * @brief Handles successful WebSocket connection; runs on the I/O thread
      */
     void onConnected();
 
     /**
-     * @brief Handles WebSocket disconnection
+     * @brief Handles WebSocket disconnection; runs on the I/O thread
      */
     void onDisconnected();
 
     /**
-     * @brief Handles WebSocket errors
+     * @brief Handles WebSocket errors; runs on the I/O thread
      * 
      * @param error Socket error code
      */
     void onError(QAbstractSocket::SocketError error);
 
     /**
-     * @brief Processes incoming WebSocket text messages
+     * @brief Encodes an incoming text message into the ring; runs on the I/O thread
      * 
      * @param message Received text message
      */
     void onTextMessageReceived(const QString &message);
 
-private:
-    std::unique_ptr<QWebSocket> m_webSocket;  ///< WebSocket connection instance
-    MessageCallback m_messageCallback;         ///< Callback for message processing
-    bool m_isConnected;                        ///< Connection state flag
+    /**
+     * @brief Queues an incoming binary message without copying; runs on the I/O thread
+     * 
+     * @param message Received binary message
+     */
+    void onBinaryMessageReceived(const QByteArray &message);
+
+    /**
+     * @brief Claims the next ring slot, counting the frame as received or dropped
+     * 
+     * @param receiveTimeNs Wall-clock receive time of the frame
+     * @return RawFrame* Slot to fill, or nullptr if the ring is full
+     */
+    RawFrame* beginFrame(int64_t receiveTimeNs);
+
+    /**
+     * @brief Publishes the slot claimed by beginFrame() and wakes the consumer if needed
+     * 
+     * @param slot Slot returned by beginFrame(), now filled
+     * @param bytes Payload size, for the byte counter
+     */
+    void commitFrame(RawFrame& slot, size_t bytes);
+
+    /**
+     * @brief Processing thread loop: drains the ring into the frame callback
+     */
+    void runProcessing();
+
+    /**
+     * @brief Points the I/O thread at a journal and takes ownership of it
+     * 
+     * @param journal New journal, or nullptr to stop capturing
+     */
+    void setJournal(std::unique_ptr<CaptureJournal> journal);
+
+    QThread m_ioThread;                        ///< Thread owning the socket
+    QWebSocket* m_webSocket;                   ///< Socket; deleted on the I/O thread
+    std::thread m_processingThread;            ///< Thread running the frame callback
+    QString m_url;                             ///< URL of the last connect()
+    FrameCallback m_frameCallback;             ///< Callback for frame processing
+    QStringEncoder m_encoder;                  ///< UTF-16 to UTF-8; used on the I/O thread only
+    std::atomic<bool> m_isConnected;           ///< Connection state flag
+
+    SpscRing<RawFrame> m_ring;                 ///< I/O thread to processing thread handoff
+    std::mutex m_wakeupMutex;                  ///< Guards sleeping of the processing thread
+    std::condition_variable m_wakeup;          ///< Signalled when the consumer may be asleep
+    std::atomic<bool> m_consumerSleeping{false}; ///< Set while the processing thread waits
+    std::atomic<bool> m_stopping{false};       ///< Set by the destructor
+
+    std::atomic<uint64_t> m_framesReceived{0};
+    std::atomic<uint64_t> m_bytesReceived{0};
+    std::atomic<uint64_t> m_framesProcessed{0};
+    std::atomic<uint64_t> m_framesFailed{0};
+    std::atomic<uint64_t> m_framesDropped{0};
+    std::atomic<size_t> m_queueHighWater{0};
+    std::atomic<int64_t> m_handoffTotalNs{0};
+    std::atomic<int64_t> m_handoffMaxNs{0};
+
+    mutable std::mutex m_captureMutex;         ///< Guards m_journal
+    std::unique_ptr<CaptureJournal> m_journal; ///< Running journal, if capturing
+    CaptureJournal* m_activeJournal = nullptr; ///< The journal as seen by the I/O thread
 };
 
 } // namespace GoQuant 
\ No newline at end of file
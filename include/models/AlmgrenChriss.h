@@ -16,8 +16,13 @@ public:
     };
 
     AlmgrenChriss(const Parameters& params);
+
+    // Throws std::invalid_argument unless every parameter is positive
+    static void validate(const Parameters& params);
     
-    // Calculate optimal trading trajectory
+    // Calculate optimal trading trajectory: the numSteps + 1 holdings of the
+    // discrete-time solution, from initialPosition down to targetPosition.
+    // TrajectoryEngine caches the solution for repeated use.
     std::vector<double> calculateOptimalTrajectory(
         double initialPosition,
         double targetPosition,
@@ -0,0 +1,115 @@
+/**
+ * @file EfficientFrontier.h
+ * @brief Header file for the EfficientFrontier class
+ *
+ * This file defines the parameter grid of an Almgren-Chriss frontier sweep,
+ * its per-point results and the parallel evaluator.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "models/AlmgrenChriss.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace GoQuant {
+
+class WorkStealingPool;
+
+/**
+ * @brief Parameter grids of a frontier sweep
+ *
+ * Every combination of risk aversion, horizon and order size is evaluated.
+ */
+struct FrontierGrid {
+    AlmgrenChriss::Parameters model{0.02, 2.5e-7, 2.5e-6, 1e-6, 1.0};  ///< Volatility and impacts; riskAversion and timeHorizon come from the grids
+    std::vector<double> riskAversions;   ///< Lambda values, positive
+    std::vector<double> timeHorizons;    ///< Horizons T, positive
+    std::vector<double> orderSizes;      ///< Positions to liquidate, positive; a buy costs the same
+    int numSteps = 50;                   ///< Trading intervals per schedule
+};
+
+/**
+ * @brief Expected shortfall and variance of one optimal schedule
+ */
+struct FrontierPoint {
+    double riskAversion = 0.0;   ///< Lambda of the schedule
+    double timeHorizon = 0.0;    ///< Horizon T
+    double orderSize = 0.0;      ///< Position liquidated
+    double kappa = 0.0;          ///< Urgency of the schedule
+    double expectedCost = 0.0;   ///< Expected implementation shortfall, price times quantity
+    double variance = 0.0;       ///< Variance of the shortfall
+};
+
+/**
+ * @brief Results of a frontier sweep
+ *
+ * Points are stored horizon-major, then by order size, then by risk
+ * aversion, so the frontier of one (horizon, size) pair is contiguous and in
+ * the order of FrontierGrid::riskAversions.
+ */
+struct FrontierResult {
+    std::vector<FrontierPoint> points;   ///< Every grid point
+    std::size_t horizonCount = 0;        ///< Entries of FrontierGrid::timeHorizons
+    std::size_t sizeCount = 0;           ///< Entries of FrontierGrid::orderSizes
+    std::size_t riskAversionCount = 0;   ///< Entries of FrontierGrid::riskAversions
+    std::size_t threads = 0;             ///< Worker threads used
+    double elapsedSeconds = 0.0;         ///< Wall time of the sweep
+
+    /**
+     * @brief Returns the point of one grid combination
+     */
+    const FrontierPoint& at(std::size_t horizon, std::size_t size, std::size_t riskAversion) const {
+        return points[(horizon * sizeCount + size) * riskAversionCount + riskAversion];
+    }
+};
+
+/**
+ * @brief Evaluates Almgren-Chriss efficient frontiers on a thread pool
+ *
+ * Expected cost and variance of an optimal schedule scale with the square
+ * of the order size, so each (risk aversion, horizon) pair needs one
+ * closed-form TrajectoryProfile and every order size is then two
+ * multiplications. Pairs are split into blocks queued on a WorkStealingPool;
+ * each block writes only its own points, so results do not depend on the
+ * thread count.
+ *
+ * The pool is kept between sweeps. compute() is not reentrant.
+ */
+class EfficientFrontier {
+public:
+    /**
+     * @brief Starts the worker threads
+     *
+     * @param threadCount Number of workers; 0 for one per hardware thread
+     */
+    explicit EfficientFrontier(std::size_t threadCount = 0);
+
+    /**
+     * @brief Joins the worker threads
+     */
+    ~EfficientFrontier();
+
+    /**
+     * @brief Evaluates every point of a grid
+     *
+     * @param grid Parameter grids
+     * @return FrontierResult Expected shortfall and variance per point
+     * @throws std::invalid_argument if a grid is empty or holds a
+     *         non-positive value, or if a combination is not a valid model
+     */
+    FrontierResult compute(const FrontierGrid& grid);
+
+    /// Number of worker threads
+    std::size_t threadCount() const;
+
+private:
+    std::unique_ptr<WorkStealingPool> m_pool;  ///< Workers evaluating blocks
+};
+
+} // namespace GoQuant
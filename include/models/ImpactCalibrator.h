@@ -0,0 +1,119 @@
+/**
+ * @file ImpactCalibrator.h
+ * @brief Header file for the ImpactCalibrator class
+ *
+ * This file defines the calibration of Almgren-Chriss impact coefficients
+ * and realized volatility from a recorded book store: its settings and its
+ * results.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "models/AlmgrenChriss.h"
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace GoQuant {
+
+class BookStoreReader;
+
+/**
+ * @brief What a calibration reads and how it turns books into parameters
+ *
+ * Times are in nanoseconds; the fitted parameters use timeUnitNs as their
+ * unit of time, one day by default as in the Almgren-Chriss paper.
+ */
+struct CalibrationConfig {
+    AlmgrenChriss::Parameters model{0.02, 2.5e-7, 2.5e-6, 1e-6, 1.0};  ///< riskAversion and timeHorizon are passed through
+    int64_t timeUnitNs = 86400LL * 1000000000LL;  ///< Time unit of the fitted parameters
+    int64_t tradeIntervalNs = 60LL * 1000000000LL;  ///< Time over which a swept quantity is assumed traded
+    int64_t bucketNs = 60LL * 1000000000LL;        ///< Interval of mid returns and order flow
+    std::vector<double> probeDepthFractions{0.01, 0.02, 0.05, 0.1, 0.2};  ///< Swept sizes, as fractions of the thinner side
+    std::size_t depth = SIZE_MAX;          ///< Levels read per side; SIZE_MAX for all
+    std::size_t sampleEvery = 1;           ///< Sweep every n-th book of a block
+    int64_t fromNs = std::numeric_limits<int64_t>::min();  ///< First exchange time included
+    int64_t toNs = std::numeric_limits<int64_t>::max();    ///< Exchange time excluded from here on
+    std::size_t threadCount = 0;           ///< Worker threads; 0 for one per hardware thread
+};
+
+/**
+ * @brief Fitted parameters and fit diagnostics
+ *
+ * Prices are absolute, in the book's price unit, and quantities in its
+ * base currency, so parameters plug into TrajectoryEngine directly.
+ */
+struct ImpactCalibration {
+    AlmgrenChriss::Parameters parameters{};  ///< volatility, permanentImpact and temporaryImpact fitted
+    double spreadCost = 0.0;           ///< Fixed cost per unit traded (epsilon), mostly the half spread
+    double temporaryRSquared = 0.0;    ///< Fit of sweep concession against size
+    double permanentRSquared = 0.0;    ///< Fit of mid change against order flow
+    double relativeVolatility = 0.0;   ///< Volatility as a fraction of price, per square root of the time unit
+    double referencePrice = 0.0;       ///< Mean mid price, converting relative to absolute volatility
+    uint64_t books = 0;                ///< Two-sided books read
+    uint64_t sweeps = 0;               ///< Fully filled probe sweeps fitted
+    uint64_t returns = 0;              ///< Bucket returns fitted
+    std::size_t threads = 0;           ///< Worker threads used
+    double elapsedSeconds = 0.0;       ///< Wall time of the calibration
+};
+
+/**
+ * @brief Fits Almgren-Chriss parameters to recorded order books
+ *
+ * - Temporary impact: every sampled book is swept with the depth kernels
+ *   at several sizes on both sides. The concession of the average fill
+ *   price against the mid, per unit, is regressed on the size; the
+ *   intercept is the spread cost and the slope, times the trade interval,
+ *   is eta, as in h(v) = epsilon + eta v.
+ * - Permanent impact: the book's order flow imbalance (the net quantity
+ *   added to the bid and removed from the ask at the touch) is summed per
+ *   bucket, and the mid change of each bucket is regressed on it. The
+ *   slope is gamma, the price move per unit of net flow.
+ * - Volatility: realized variance of the bucket mid log returns, scaled
+ *   to the time unit and multiplied by the mean mid.
+ *
+ * Blocks of the store are evaluated in parallel on a WorkStealingPool into
+ * mergeable partial statistics, then stitched in file order, so the result
+ * does not depend on the thread count.
+ *
+ * A fitted impact may come out non-positive on data without the expected
+ * relationship; check the R-squared values before using the parameters.
+ */
+class ImpactCalibrator {
+public:
+    /**
+     * @brief Constructs a calibrator for @p config
+     *
+     * @throws std::invalid_argument if an interval, the time unit, the
+     *         sampling stride or a probe fraction is not positive
+     */
+    explicit ImpactCalibrator(const CalibrationConfig& config);
+
+    /**
+     * @brief Calibrates on an open book store
+     *
+     * @param store Reader of the recorded books
+     * @return ImpactCalibration Fitted parameters
+     * @throws std::runtime_error if the store is corrupt or holds fewer
+     *         than two buckets of two-sided books
+     */
+    ImpactCalibration calibrate(const BookStoreReader& store) const;
+
+    /**
+     * @brief Opens a book store and calibrates on it
+     *
+     * @throws std::runtime_error if the file is not a readable book store
+     */
+    ImpactCalibration calibrate(const QString& path) const;
+
+private:
+    CalibrationConfig m_config;  ///< Calibration settings
+};
+
+} // namespace GoQuant
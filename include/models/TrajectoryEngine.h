@@ -0,0 +1,161 @@
+/**
+ * @file TrajectoryEngine.h
+ * @brief Header file for the TrajectoryEngine class
+ *
+ * This file defines the closed-form discrete-time Almgren-Chriss execution
+ * schedule, its per-parameter-set profile and the engine that caches
+ * profiles across schedules.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include "models/AlmgrenChriss.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Optimal schedule of a unit position under one parameter set
+ *
+ * With step tau = T / N, the discrete-time solution holds
+ *
+ *     x_j = X sinh(kappa (T - t_j)) / sinh(kappa T),   j = 0..N
+ *
+ * where kappa solves 2 (cosh(kappa tau) - 1) / tau^2 = lambda sigma^2 / eta~
+ * and eta~ = eta - gamma tau / 2. The sinh ratios depend on the parameters
+ * and N only, so they are computed once here and every schedule is a scaled
+ * copy.
+ */
+struct TrajectoryProfile {
+    int numSteps = 0;                 ///< Trading intervals N
+    double tau = 0.0;                 ///< Interval length, T / N
+    double kappa = 0.0;               ///< Urgency, per unit of time
+    double adjustedImpact = 0.0;      ///< eta~, temporary impact net of the permanent part
+    std::vector<double> holdings;     ///< sinh(kappa (T - t_j)) / sinh(kappa T), N + 1 values from 1 to 0
+    std::vector<double> trades;       ///< holdings[j - 1] - holdings[j], N values
+    double costFactor = 0.0;          ///< Expected cost of a position X is costFactor * X^2
+    double varianceFactor = 0.0;      ///< Cost variance of a position X is varianceFactor * X^2
+};
+
+/**
+ * @brief Holdings, trades and cost of one execution
+ */
+struct ExecutionSchedule {
+    std::vector<double> holdings;  ///< Position at each step, from initial to target
+    std::vector<double> trades;    ///< Quantity sold in each interval; negative when buying
+    double expectedCost = 0.0;     ///< Expected impact cost, in price times quantity
+    double variance = 0.0;         ///< Variance of the cost
+};
+
+/**
+ * @brief Builds Almgren-Chriss schedules from cached profiles
+ *
+ * A profile is computed the first time a (parameters, step count) pair is
+ * seen and reused for every later schedule with that pair, so a sweep over
+ * order sizes or start positions costs two multiply-adds per step. When the
+ * cache reaches its capacity it is emptied and refilled.
+ *
+ * Profiles are immutable and may be shared between threads; the engine
+ * itself is not synchronized, so give each thread its own.
+ */
+class TrajectoryEngine {
+public:
+    static constexpr std::size_t DEFAULT_CACHE_CAPACITY = 1024;  ///< Profiles kept by default
+
+    /**
+     * @brief Constructs an engine with an empty cache
+     *
+     * @param cacheCapacity Profiles kept before the cache is emptied
+     */
+    explicit TrajectoryEngine(std::size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+    /**
+     * @brief Computes the profile of a parameter set, without caching
+     *
+     * @param params Model parameters; timeHorizon is T
+     * @param numSteps Trading intervals N
+     * @return std::shared_ptr<const TrajectoryProfile> The profile
+     * @throws std::invalid_argument if the parameters are invalid, @p numSteps
+     *         is not positive, or the permanent impact is so large for the
+     *         step that eta~ is not positive
+     */
+    static std::shared_ptr<const TrajectoryProfile> computeProfile(
+        const AlmgrenChriss::Parameters& params, int numSteps);
+
+    /**
+     * @brief Writes the schedule of one position from a profile
+     *
+     * @param profile Profile of the parameter set
+     * @param initialPosition Position at the start
+     * @param targetPosition Position at the horizon
+     * @param holdings Receives numSteps + 1 holdings; may be null
+     * @param trades Receives numSteps trades; may be null
+     */
+    static void fillSchedule(const TrajectoryProfile& profile, double initialPosition,
+                             double targetPosition, double* holdings, double* trades);
+
+    /**
+     * @brief Returns the profile of a parameter set, computing it on a miss
+     *
+     * @throws std::invalid_argument as computeProfile()
+     */
+    std::shared_ptr<const TrajectoryProfile> profile(const AlmgrenChriss::Parameters& params,
+                                                     int numSteps);
+
+    /**
+     * @brief Builds the optimal schedule from one position to another
+     *
+     * @param params Model parameters
+     * @param initialPosition Position at the start
+     * @param targetPosition Position at the horizon
+     * @param numSteps Trading intervals
+     * @return ExecutionSchedule Holdings, trades, expected cost and variance
+     * @throws std::invalid_argument as computeProfile()
+     */
+    ExecutionSchedule schedule(const AlmgrenChriss::Parameters& params, double initialPosition,
+                               double targetPosition, int numSteps);
+
+    /// Profiles currently cached
+    std::size_t cacheSize() const { return m_cache.size(); }
+
+    /// Profile requests answered from the cache
+    uint64_t cacheHits() const { return m_hits; }
+
+    /// Profile requests that computed a profile
+    uint64_t cacheMisses() const { return m_misses; }
+
+private:
+    /**
+     * @brief Cache key: the parameters' bit patterns and the step count
+     */
+    struct Key {
+        uint64_t bits[5];   ///< Parameters, in declaration order
+        int numSteps;       ///< Trading intervals
+
+        bool operator==(const Key& other) const;
+    };
+
+    /**
+     * @brief Hash of a Key
+     */
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    static Key makeKey(const AlmgrenChriss::Parameters& params, int numSteps);
+
+    std::size_t m_capacity;                                                  ///< Cache bound
+    std::unordered_map<Key, std::shared_ptr<const TrajectoryProfile>, KeyHash> m_cache;  ///< Profiles
+    uint64_t m_hits = 0;       ///< Cache hits
+    uint64_t m_misses = 0;     ///< Cache misses
+};
+
+} // namespace GoQuant
@@ -2,7 +2,9 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <atomic>
 #include <memory>
+#include <string_view>
 #include "../core/WebSocketClient.h"
 #include "../core/OrderBookProcessor.h"
 #include "../models/AlmgrenChriss.h"
@@ -20,21 +22,19 @@ private slots:
     void onWebSocketConnected();
     void onWebSocketDisconnected();
     void onWebSocketError(const QString &error);
-    void onOrderBookUpdated(const OrderBook& orderBook);
-    void onMarketImpactUpdated(double impact);
-    void onSlippageUpdated(double slippage);
-    void onMakerTakerProportionUpdated(double proportion);
+    void onAnalyticsUpdated(const BookAnalytics& analytics);
     void updatePerformanceMetrics();
 
 private:
     // UI Components
     void setupUi();
-    void createInputPanel();
-    void createOutputPanel();
+    QWidget* createInputPanel();
+    QWidget* createOutputPanel();
     void createStatusBar();
+    void setupConnections();
     
     // Data processing
-    void processOrderBookData(const nlohmann::json& data);
+    void processOrderBookData(std::string_view frame, int64_t receiveTimeNs);
     void updateMetrics();
     
     // Performance monitoring
@@ -50,7 +50,7 @@ private:
     
     // UI state
     bool m_isConnected;
-    double m_lastProcessingTime;
+    std::atomic<double> m_lastProcessingTime;
     double m_lastUiUpdateTime;
     
     // Input parameters
@@ -0,0 +1,42 @@
+/**
+ * @file Crc32.h
+ * @brief CRC-32 checksum with the zlib (IEEE 802.3) polynomial
+ *
+ * This file declares the CRC-32 used by exchange book checksums. It is the
+ * same function as zlib's crc32(), including its initial and final
+ * inversion, so partial checksums can be chained across buffers.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace GoQuant {
+
+/**
+ * @brief Computes or extends a CRC-32 (polynomial 0xEDB88320)
+ *
+ * Uses the ARMv8 CRC32 instructions when the target has them, and an
+ * eight-byte-at-a-time table lookup ("slicing-by-8") otherwise. The x86
+ * SSE4.2 crc32 instruction is not used: it implements the Castagnoli
+ * polynomial, which exchanges do not use.
+ *
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Checksum of the preceding bytes; 0 to start a new checksum
+ * @return std::uint32_t Checksum of everything passed so far
+ */
+std::uint32_t crc32(const void* data, std::size_t length, std::uint32_t crc = 0);
+
+/// Computes or extends a CRC-32 over @p text
+inline std::uint32_t crc32(std::string_view text, std::uint32_t crc = 0) {
+    return crc32(text.data(), text.size(), crc);
+}
+
+} // namespace GoQuant
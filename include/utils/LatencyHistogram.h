@@ -0,0 +1,160 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief Fixed-size log-linear histogram of nanosecond latencies
+ *
+ * This file defines LatencyHistogram, a constant-time recorder for latency
+ * distributions on hot paths. Unlike PerformanceMonitor it keeps no samples
+ * and takes no lock, so it can record every message of a replay.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace GoQuant {
+
+/**
+ * @brief Histogram of non-negative latencies with bounded relative error
+ *
+ * Values below 2 * SUB_BUCKETS are counted exactly. Above that, every
+ * power-of-two range is split into SUB_BUCKETS equal buckets, so a
+ * percentile is reported to within 1 / SUB_BUCKETS of its true value
+ * anywhere up to the full int64_t range.
+ *
+ * Not thread-safe: each thread records into its own histogram, and
+ * histograms are combined with merge().
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;                       ///< log2 of SUB_BUCKETS
+    static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;  ///< Buckets per power of two
+    static constexpr std::size_t BUCKETS = (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;  ///< Covers every int64_t
+
+    /**
+     * @brief Counts one latency; negative values are counted as 0
+     *
+     * @param nanoseconds Latency in nanoseconds
+     */
+    void record(std::int64_t nanoseconds) {
+        std::uint64_t value = nanoseconds > 0 ? static_cast<std::uint64_t>(nanoseconds) : 0;
+        ++m_counts[bucketIndex(value)];
+        ++m_count;
+        m_sum += static_cast<double>(value);
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    /**
+     * @brief Adds the counts of another histogram
+     */
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    /**
+     * @brief Forgets every recorded value
+     */
+    void reset() { *this = LatencyHistogram(); }
+
+    /// Number of recorded values
+    std::uint64_t count() const { return m_count; }
+
+    /// Smallest recorded value; 0 if empty
+    std::int64_t min() const { return m_count ? static_cast<std::int64_t>(m_min) : 0; }
+
+    /// Largest recorded value; 0 if empty
+    std::int64_t max() const { return static_cast<std::int64_t>(m_max); }
+
+    /// Mean of the recorded values; 0 if empty
+    double mean() const { return m_count ? m_sum / static_cast<double>(m_count) : 0.0; }
+
+    /**
+     * @brief Returns the value at or below which @p percentile percent of values fall
+     *
+     * The answer is the upper bound of the bucket holding that rank, capped
+     * at the largest recorded value.
+     *
+     * @param percentile Percentile in [0, 100]
+     * @return std::int64_t Latency in nanoseconds; 0 if empty
+     */
+    std::int64_t percentile(double percentile) const {
+        if (m_count == 0) {
+            return 0;
+        }
+        double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+        std::uint64_t rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_count))));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return static_cast<std::int64_t>(std::min(bucketUpperBound(i), m_max));
+            }
+        }
+        return max();
+    }
+
+private:
+    /// Index of the highest set bit of a non-zero value
+    static int highestBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    /**
+     * @brief Bucket of a value
+     *
+     * The bits below the leading one, truncated to SUB_BUCKET_BITS, select
+     * the bucket within the value's power of two.
+     */
+    static std::size_t bucketIndex(std::uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        int shift = highestBit(value) - SUB_BUCKET_BITS;
+        return static_cast<std::size_t>(shift + 1) * SUB_BUCKETS +
+               static_cast<std::size_t>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    /// Largest value that falls into bucket @p index
+    static std::uint64_t bucketUpperBound(std::size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        std::uint64_t mantissa = SUB_BUCKETS + index % SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<std::uint64_t, BUCKETS> m_counts{};  ///< Values per bucket
+    std::uint64_t m_count = 0;                      ///< Number of values
+    double m_sum = 0.0;                             ///< Sum of values, for the mean
+    std::uint64_t m_min = std::numeric_limits<std::uint64_t>::max();  ///< Smallest value
+    std::uint64_t m_max = 0;                        ///< Largest value
+};
+
+} // namespace GoQuant
@@ -0,0 +1,96 @@
+/**
+ * @file RunningStatistic.h
+ * @brief Streaming count, mean, variance and range of a series
+ *
+ * This file defines RunningStatistic, which summarises a series in constant
+ * space and can merge the summaries of separately processed parts, as the
+ * parallel backtest does with its per-day runs.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace GoQuant {
+
+/**
+ * @brief Count, mean, variance and range of a series of doubles
+ *
+ * Uses Welford's update for single values and Chan's pairwise formula for
+ * merge(), both numerically stable. Merging is exact up to rounding but not
+ * associative in floating point, so merge parts in a fixed order when the
+ * result must be reproducible.
+ */
+class RunningStatistic {
+public:
+    /**
+     * @brief Adds one value
+     */
+    void add(double value) {
+        ++m_count;
+        double delta = value - m_mean;
+        m_mean += delta / static_cast<double>(m_count);
+        m_m2 += delta * (value - m_mean);
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    /**
+     * @brief Adds every value summarised by @p other
+     */
+    void merge(const RunningStatistic& other) {
+        if (other.m_count == 0) {
+            return;
+        }
+        if (m_count == 0) {
+            *this = other;
+            return;
+        }
+        double count = static_cast<double>(m_count);
+        double otherCount = static_cast<double>(other.m_count);
+        double total = count + otherCount;
+        double delta = other.m_mean - m_mean;
+        m_mean += delta * otherCount / total;
+        m_m2 += other.m_m2 + delta * delta * count * otherCount / total;
+        m_count += other.m_count;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    /// Number of values added
+    uint64_t count() const { return m_count; }
+
+    /// Mean of the values; 0 if there are none
+    double mean() const { return m_mean; }
+
+    /// Sum of the values
+    double sum() const { return m_mean * static_cast<double>(m_count); }
+
+    /// Sample variance; 0 for fewer than two values
+    double variance() const { return m_count > 1 ? m_m2 / static_cast<double>(m_count - 1) : 0.0; }
+
+    /// Sample standard deviation
+    double stddev() const { return std::sqrt(variance()); }
+
+    /// Smallest value; 0 if there are none
+    double min() const { return m_count > 0 ? m_min : 0.0; }
+
+    /// Largest value; 0 if there are none
+    double max() const { return m_count > 0 ? m_max : 0.0; }
+
+private:
+    uint64_t m_count = 0;
+    double m_mean = 0.0;
+    double m_m2 = 0.0;  ///< Sum of squared deviations from the mean
+    double m_min = std::numeric_limits<double>::infinity();
+    double m_max = -std::numeric_limits<double>::infinity();
+};
+
+} // namespace GoQuant
@@ -0,0 +1,147 @@
+/**
+ * @file SpscRing.h
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * This file defines SpscRing, the handoff queue between exactly one
+ * producer thread and one consumer thread. Slots are constructed once and
+ * filled in place, so element types that own heap storage (strings,
+ * vectors) keep their capacity from one lap of the ring to the next.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Bounded lock-free queue between one producer and one consumer
+ *
+ * The producer claims a slot with acquireSlot(), fills it and makes it
+ * visible with publish(); the consumer reads front() and releases it with
+ * pop(). Each side owns one index and keeps a cached copy of the other's, so
+ * the shared cache lines are only touched when the cached view says the ring
+ * is full or empty.
+ *
+ * Calling producer methods from more than one thread, or consumer methods
+ * from more than one thread, is undefined.
+ *
+ * @tparam T Slot type; must be default-constructible
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief Constructs a ring holding at least @p capacity elements
+     *
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     * @throws std::invalid_argument if @p capacity is zero
+     */
+    explicit SpscRing(std::size_t capacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_capacity - 1)
+        , m_slots(new T[m_capacity])
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Returns the next free slot for the producer to fill
+     *
+     * The slot still holds whatever a previous lap left in it.
+     *
+     * @return T* Slot to fill, or nullptr if the ring is full
+     */
+    T* acquireSlot() {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_capacity) {
+                return nullptr;
+            }
+        }
+        return &m_slots[tail & m_mask];
+    }
+
+    /**
+     * @brief Makes the slot returned by acquireSlot() visible to the consumer
+     */
+    void publish() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns the oldest published element
+     *
+     * @return T* Element, or nullptr if the ring is empty
+     */
+    T* front() {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return nullptr;
+            }
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    /**
+     * @brief Releases the element returned by front() back to the producer
+     */
+    void pop() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns the number of published, unconsumed elements
+     *
+     * Exact from either end of the ring; approximate from any other thread.
+     */
+    std::size_t size() const {
+        std::size_t head = m_head.load(std::memory_order_acquire);
+        std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    /// True if no element is waiting
+    bool empty() const { return size() == 0; }
+
+    /// Number of slots
+    std::size_t capacity() const { return m_capacity; }
+
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        if (value == 0) {
+            throw std::invalid_argument("Ring capacity must be positive");
+        }
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{0};  ///< Next slot to consume
+    std::size_t m_cachedTail = 0;                             ///< Consumer's view of m_tail
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{0};  ///< Next slot to fill
+    std::size_t m_cachedHead = 0;                             ///< Producer's view of m_head
+};
+
+} // namespace GoQuant
@@ -0,0 +1,64 @@
+/**
+ * @file Varint.h
+ * @brief LEB128 variable-length integers and zigzag signed mapping
+ *
+ * This file provides the integer encodings of the on-disk book store:
+ * unsigned values in 7-bit groups, least significant first, and signed
+ * values mapped to unsigned so that small magnitudes of either sign stay
+ * short.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace GoQuant {
+
+/// Maps a signed value to unsigned so that -1, 1, -2, 2... become 1, 2, 3, 4...
+inline std::uint64_t zigzagEncode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+/// Inverse of zigzagEncode()
+inline std::int64_t zigzagDecode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * @brief Appends @p value as a varint of 1 to 10 bytes
+ */
+inline void appendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Reads a varint and advances @p pos past it
+ *
+ * @param pos Read position; advanced on success
+ * @param end One past the last readable byte
+ * @param value Receives the decoded value
+ * @return bool False if the data ends inside the varint or it exceeds 64 bits
+ */
+inline bool readVarint(const unsigned char*& pos, const unsigned char* end, std::uint64_t& value) {
+    std::uint64_t result = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        unsigned char byte = *pos++;
+        result |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace GoQuant
@@ -0,0 +1,115 @@
+/**
+ * @file WorkStealingPool.h
+ * @brief Fixed-size thread pool with per-worker queues and work stealing
+ *
+ * This file defines WorkStealingPool, which runs coarse independent tasks,
+ * such as the per-day runs of a backtest, on all cores and keeps them busy
+ * when the tasks differ widely in length.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GoQuant {
+
+/**
+ * @brief Thread pool in which idle workers steal queued tasks from busy ones
+ *
+ * Each worker owns a deque. Tasks submitted from outside the pool are dealt
+ * to the deques in turn; tasks submitted by a running task go to its own
+ * worker's deque. A worker takes tasks from the front of its deque, so tasks
+ * submitted largest first run largest first, and an idle worker steals from
+ * the back of another's, taking the smallest remaining task.
+ *
+ * Each deque has its own mutex, held only to push or pop, so workers contend
+ * only when stealing. The pool is meant for tasks of microseconds or more,
+ * not for fine-grained parallel loops.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;  ///< Unit of work
+
+    /**
+     * @brief Starts the worker threads
+     *
+     * @param threadCount Number of workers; 0 for one per hardware thread
+     */
+    explicit WorkStealingPool(std::size_t threadCount = 0);
+
+    /**
+     * @brief Runs the tasks still queued, then joins the workers
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// Number of worker threads
+    std::size_t threadCount() const { return m_threads.size(); }
+
+    /**
+     * @brief Queues a task; safe from any thread, including pool workers
+     *
+     * @param task Task to run; an exception it throws is rethrown by wait()
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every submitted task has finished
+     *
+     * Must not be called from a task.
+     *
+     * @throws The first exception thrown by a task since the last wait()
+     */
+    void wait();
+
+private:
+    /**
+     * @brief Task deque of one worker
+     */
+    struct Worker {
+        std::mutex mutex;        ///< Guards tasks
+        std::deque<Task> tasks;  ///< Queued tasks, next to run at the front
+    };
+
+    /**
+     * @brief Takes a task from worker @p self's deque or steals one
+     *
+     * @return bool False if every deque was empty
+     */
+    bool takeTask(std::size_t self, Task& task);
+
+    /**
+     * @brief Body of worker thread @p index
+     */
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;  ///< One deque per worker
+    std::vector<std::thread> m_threads;              ///< Worker threads
+    std::atomic<std::size_t> m_nextWorker{0};        ///< Deque receiving the next outside task
+    std::atomic<int64_t> m_queued{0};                ///< Tasks in the deques; may briefly lag them
+
+    std::mutex m_mutex;                  ///< Guards the members below and sleeping
+    std::condition_variable m_wake;      ///< Signalled when a task is queued or the pool stops
+    std::condition_variable m_idle;      ///< Signalled when m_pending reaches 0
+    std::size_t m_pending = 0;           ///< Tasks submitted and not yet finished
+    bool m_stopping = false;             ///< Set by the destructor
+    std::exception_ptr m_error;          ///< First task exception since the last wait()
+};
+
+} // namespace GoQuant
@@ -0,0 +1,522 @@
+/**
+ * @file BacktestRunner.cpp
+ * @brief Implementation of the parallel BacktestRunner
+ *
+ * This file contains the indexing of journals into (instrument, day) runs,
+ * their grouping into ranges, the per-range pipeline and the deterministic
+ * merge of their results.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BacktestRunner.h"
+#include "core/FeeCalculator.h"
+#include "core/JournalReader.h"
+#include "core/OrderBookParser.h"
+#include "core/OrderBookProcessor.h"
+#include "core/Timestamp.h"
+#include "core/VolumeTracker.h"
+#include "utils/WorkStealingPool.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace GoQuant {
+
+namespace {
+
+/// Map key of an (instrument, day) pair
+uint64_t dayKey(InstrumentId instrument, int64_t day) {
+    return (static_cast<uint64_t>(day) << 32) | instrument;
+}
+
+/// A range may start where its warm-up is at most this fraction of its first day's frames
+constexpr uint64_t WARMUP_DIVISOR = 8;
+
+/**
+ * @brief What one journal file holds, per instrument and day
+ */
+struct FileIndex {
+    /**
+     * @brief Where an instrument's book can be rebuilt from within the file
+     */
+    struct Warmup {
+        int64_t snapshotOffset = -1;  ///< Position of its last snapshot; -1 if none
+        uint64_t frames = 0;          ///< Its frames from that snapshot on, or from the file start if none
+    };
+
+    /**
+     * @brief Frames of one instrument on one day within the file
+     */
+    struct DayEntry {
+        InstrumentId instrument;   ///< Instrument of the frames
+        int64_t day;               ///< UTC day of their receive times
+        int64_t firstOffset;       ///< Position of the first of them
+        Warmup warmup;             ///< Rebuild point as of the first of them, which it excludes
+        uint64_t frames;           ///< Number of them
+    };
+
+    std::vector<DayEntry> days;                            ///< In order of first frame
+    std::vector<std::pair<InstrumentId, Warmup>> tails;    ///< Rebuild point of each instrument at the end
+};
+
+/**
+ * @brief Indexes one journal file, reading frame headers and peeking at actions
+ *
+ * @param path Journal file
+ * @param only Instrument to index; UNKNOWN_INSTRUMENT for all
+ * @throws std::runtime_error if the file is not a readable journal
+ */
+FileIndex indexFile(const QString& path, InstrumentId only) {
+    FileIndex index;
+    JournalReader reader(path);
+    std::unordered_map<uint64_t, std::size_t> entries;
+    std::unordered_map<InstrumentId, FileIndex::Warmup> warmups;
+
+    JournalFrame frame;
+    for (int64_t offset = reader.position(); reader.next(frame); offset = reader.position()) {
+        if (frame.instrument == UNKNOWN_INSTRUMENT ||
+            (only != UNKNOWN_INSTRUMENT && frame.instrument != only)) {
+            continue;
+        }
+
+        FileIndex::Warmup& warmup = warmups[frame.instrument];
+        BookAction action;
+        if (OrderBookParser::peekAction(frame.bytes, action) && action == BookAction::Snapshot) {
+            warmup = {offset, 0};
+        }
+
+        int64_t day = utcDay(frame.receiveTimeNs);
+        auto inserted = entries.emplace(dayKey(frame.instrument, day), index.days.size());
+        if (inserted.second) {
+            index.days.push_back({frame.instrument, day, offset, warmup, 0});
+        }
+        ++index.days[inserted.first->second].frames;
+        ++warmup.frames;
+    }
+
+    index.tails.assign(warmups.begin(), warmups.end());
+    return index;
+}
+
+} // namespace
+
+/**
+ * @brief Adds the samples of @p other
+ */
+void BacktestCosts::merge(const BacktestCosts& other) {
+    samples += other.samples;
+    unfilled += other.unfilled;
+    slippage.merge(other.slippage);
+    marketImpact.merge(other.marketImpact);
+    modelImpact.merge(other.modelImpact);
+    fees.merge(other.fees);
+    totalCost.merge(other.totalCost);
+}
+
+/**
+ * @brief Constructs a runner for @p config
+ */
+BacktestRunner::BacktestRunner(const BacktestConfig& config)
+    : m_config(config)
+{
+}
+
+/**
+ * @brief Backtests the given journal files
+ *
+ * Runs are indexed and grouped into ranges, then the ranges are queued with
+ * the most frames first so the longest start early and stealing evens out
+ * the tail. Each range writes only its own runs' slots of the report, and
+ * the totals are merged afterwards in slot order.
+ *
+ * @param files Journal files in the order written
+ * @return BacktestReport Per-run and merged results
+ * @throws std::invalid_argument if the order quantity, the impact model
+ *         parameters or the fee exchange or product are invalid
+ * @throws std::runtime_error if a file is not a readable journal
+ */
+BacktestReport BacktestRunner::run(const QStringList& files) {
+    m_stopping.store(false, std::memory_order_relaxed);
+    int64_t startNs = steadyNanoseconds();
+
+    // Fail before any work rather than once per run
+    if (m_config.orderQuantity <= 0.0) {
+        throw std::invalid_argument("Order quantity must be positive");
+    }
+    if (!m_config.feeSchedule) {
+        m_config.feeSchedule = FeeSchedule::builtIn();
+    }
+    AlmgrenChriss model(m_config.impactModel);
+    FeeCalculator fees(m_config.feeSchedule);
+    fees.setFeeTier(m_config.feeExchange, m_config.tradingVolume, m_config.feeProduct);
+    if (m_config.tradingVolume < 0.0) {
+        throw std::invalid_argument("Trading volume cannot be negative");
+    }
+
+    // A fixed tier is priced alone; a tracked one is priced at every tier
+    const FeeSchedule& schedule = *m_config.feeSchedule;
+    FeeScheduleId scheduleId = schedule.find(m_config.feeExchange, m_config.feeProduct);
+    std::uint32_t fixedTier = schedule.tierForVolume(scheduleId, m_config.tradingVolume);
+    std::vector<double> takerRates;
+    if (m_config.trackVolume) {
+        for (std::uint32_t tier = 0; tier < schedule.tierCount(scheduleId); ++tier) {
+            takerRates.push_back(schedule.rate(scheduleId, tier, false));
+        }
+    } else {
+        takerRates.push_back(schedule.rate(scheduleId, fixedTier, false));
+    }
+
+    BacktestReport report;
+    WorkStealingPool pool(m_config.threadCount);
+    report.threads = pool.threadCount();
+
+    std::vector<Job> jobs = plan(files, pool);
+    std::vector<Range> ranges = splitRanges(jobs);
+    report.planSeconds = (steadyNanoseconds() - startNs) * 1e-9;
+
+    std::vector<std::size_t> queueOrder(ranges.size());
+    std::iota(queueOrder.begin(), queueOrder.end(), 0);
+    std::stable_sort(queueOrder.begin(), queueOrder.end(), [&ranges](std::size_t a, std::size_t b) {
+        return ranges[a].frames > ranges[b].frames;
+    });
+
+    report.runs.resize(jobs.size());
+    std::vector<std::vector<TierCosts>> tierCosts(jobs.size());
+    for (std::size_t index : queueOrder) {
+        pool.submit([this, &ranges, &jobs, &files, &report, &takerRates, &tierCosts, index]() {
+            runRange(ranges[index], jobs, files, takerRates, report.runs, tierCosts);
+        });
+    }
+    pool.wait();
+
+    if (m_config.trackVolume) {
+        chargeTrackedTiers(report, tierCosts);
+    } else {
+        for (std::size_t index = 0; index < report.runs.size(); ++index) {
+            report.runs[index].feeTier = fixedTier;
+            report.runs[index].costs.fees = tierCosts[index].front().fees;
+            report.runs[index].costs.totalCost = tierCosts[index].front().totalCost;
+        }
+    }
+
+    for (const BacktestRunResult& result : report.runs) {
+        report.frames += result.frames;
+        report.warmupFrames += result.warmupFrames;
+        if (!result.error.empty()) {
+            ++report.failedRuns;
+            continue;
+        }
+        report.total.merge(result.costs);
+    }
+    report.elapsedSeconds = (steadyNanoseconds() - startNs) * 1e-9;
+    if (report.elapsedSeconds > 0.0) {
+        report.framesPerSecond = report.frames / report.elapsedSeconds;
+    }
+    return report;
+}
+
+/**
+ * @brief Makes running runs return early and queued ones skip; safe from any thread
+ */
+void BacktestRunner::stop() {
+    m_stopping.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Indexes the files in parallel and turns the index into runs
+ *
+ * The per-file indexes are combined in file order, carrying each
+ * instrument's last snapshot and the frames since it forward, so a range
+ * can start from one recorded in an earlier file. Registry IDs depend on
+ * which thread interned a name first, so runs are ordered by exchange,
+ * symbol and day instead.
+ *
+ * @param files Journal files in the order written
+ * @param pool Pool to index on
+ * @return std::vector<Job> Runs ordered by instrument name, then day
+ * @throws std::runtime_error if a file is not a readable journal
+ */
+std::vector<BacktestRunner::Job> BacktestRunner::plan(const QStringList& files,
+                                                      WorkStealingPool& pool) const {
+    std::vector<FileIndex> indexes(files.size());
+    for (int i = 0; i < static_cast<int>(files.size()); ++i) {
+        pool.submit([this, &files, &indexes, i]() {
+            indexes[i] = indexFile(files[i], m_config.instrument);
+        });
+    }
+    pool.wait();
+
+    std::unordered_map<uint64_t, std::size_t> jobIndex;
+    std::unordered_map<InstrumentId, std::pair<JournalPosition, uint64_t>> lastSnapshot;
+    std::vector<Job> jobs;
+    for (int file = 0; file < static_cast<int>(indexes.size()); ++file) {
+        for (const FileIndex::DayEntry& entry : indexes[file].days) {
+            auto inserted = jobIndex.emplace(dayKey(entry.instrument, entry.day), jobs.size());
+            if (inserted.second) {
+                JournalPosition start{file, entry.firstOffset};
+                uint64_t warmupFrames = 0;
+                auto carried = lastSnapshot.find(entry.instrument);
+                if (entry.warmup.snapshotOffset >= 0) {
+                    start.offset = entry.warmup.snapshotOffset;
+                    warmupFrames = entry.warmup.frames;
+                } else if (carried != lastSnapshot.end() && carried->second.first.file >= 0) {
+                    start = carried->second.first;
+                    warmupFrames = carried->second.second + entry.warmup.frames;
+                }
+                jobs.push_back({entry.instrument, entry.day, start, warmupFrames, file, 0});
+            }
+            Job& job = jobs[inserted.first->second];
+            job.lastFile = file;
+            job.frames += entry.frames;
+        }
+        for (const auto& tail : indexes[file].tails) {
+            std::pair<JournalPosition, uint64_t>& carried = lastSnapshot[tail.first];
+            if (tail.second.snapshotOffset >= 0) {
+                carried = {JournalPosition{file, tail.second.snapshotOffset}, tail.second.frames};
+            } else {
+                carried.second += tail.second.frames;
+            }
+        }
+    }
+
+    const InstrumentRegistry& registry = InstrumentRegistry::instance();
+    std::sort(jobs.begin(), jobs.end(), [&registry](const Job& a, const Job& b) {
+        if (a.instrument != b.instrument) {
+            int byExchange = registry.exchange(a.instrument).compare(registry.exchange(b.instrument));
+            if (byExchange != 0) {
+                return byExchange < 0;
+            }
+            return registry.symbol(a.instrument) < registry.symbol(b.instrument);
+        }
+        return a.day < b.day;
+    });
+    return jobs;
+}
+
+/**
+ * @brief Groups the runs of each instrument into ranges of consecutive days
+ *
+ * A range ends before a day whose book can be rebuilt from a snapshot
+ * with at most 1 / WARMUP_DIVISOR of the day's frames of warm-up, or that
+ * no snapshot precedes. Elsewhere the book is carried over, as the nearest
+ * snapshot could lie any number of days back.
+ *
+ * @param jobs Runs ordered by instrument, then day
+ * @return std::vector<Range> Ranges in the order of their runs
+ */
+std::vector<BacktestRunner::Range> BacktestRunner::splitRanges(const std::vector<Job>& jobs) {
+    std::vector<Range> ranges;
+    for (std::size_t index = 0; index < jobs.size(); ++index) {
+        const Job& job = jobs[index];
+        bool startsRange = index == 0 || job.instrument != jobs[index - 1].instrument ||
+                           job.warmupFrames * WARMUP_DIVISOR <= job.frames;
+        if (startsRange) {
+            ranges.push_back({index, index, 0});
+        }
+        ranges.back().endJob = index + 1;
+        ranges.back().frames += job.frames;
+    }
+    return ranges;
+}
+
+/**
+ * @brief Replays one range of days through a private pipeline
+ *
+ * Frames before the first day only rebuild the book. From each midnight,
+ * the book is sampled at the first new version at least sampleIntervalNs
+ * after the previous sample of the day, provided the processor is in sync
+ * and both sides have levels. An error ends the range: the day it occurred
+ * in reports it, and the days after it were not run.
+ *
+ * Fees are left out of the results' costs: they are accumulated once per
+ * candidate taker rate in @p tierCosts, for the caller to pick from.
+ *
+ * @param range Range to perform
+ * @param jobs All runs; the range's are replayed
+ * @param files Journal files the runs' positions refer to
+ * @param takerRates Candidate fee rates
+ * @param results Receives the statistics of the range's runs, in their slots
+ * @param tierCosts Receives the fee statistics of the range's runs under each rate
+ */
+void BacktestRunner::runRange(const Range& range, const std::vector<Job>& jobs,
+                              const QStringList& files, const std::vector<double>& takerRates,
+                              std::vector<BacktestRunResult>& results,
+                              std::vector<std::vector<TierCosts>>& tierCosts) const {
+    for (std::size_t index = range.firstJob; index < range.endJob; ++index) {
+        tierCosts[index].assign(takerRates.size(), TierCosts());
+        results[index].instrument = jobs[index].instrument;
+        results[index].day = jobs[index].day;
+    }
+    if (m_stopping.load(std::memory_order_relaxed)) {
+        for (std::size_t index = range.firstJob; index < range.endJob; ++index) {
+            results[index].error = "stopped";
+        }
+        return;
+    }
+
+    const Job& first = jobs[range.firstJob];
+    const Job& last = jobs[range.endJob - 1];
+    const int64_t rangeEndNs = (last.day + 1) * NS_PER_DAY;
+    std::size_t current = range.firstJob;
+    int64_t runStartNs = steadyNanoseconds();
+
+    try {
+        AlmgrenChriss model(m_config.impactModel);
+        OrderBookProcessor processor;
+
+        const std::vector<double> quantities{m_config.orderQuantity};
+        uint64_t sampledVersion = processor.acquireSnapshot().version();
+        int64_t dayStartNs = first.day * NS_PER_DAY;
+        int64_t nextSampleNs = dayStartNs;
+        int countedFile = -1;
+        bool done = false;
+
+        for (int file = first.start.file; file <= last.lastFile && !done; ++file) {
+            JournalReader reader(files[file]);
+            if (file == first.start.file) {
+                reader.seek(first.start.offset);
+            }
+
+            JournalFrame frame;
+            while (reader.next(frame)) {
+                if (frame.instrument != first.instrument) {
+                    continue;
+                }
+                if (frame.receiveTimeNs >= rangeEndNs || m_stopping.load(std::memory_order_relaxed)) {
+                    done = true;
+                    break;
+                }
+
+                // Days without frames have no run, so move straight to the frame's
+                while (current + 1 < range.endJob &&
+                       frame.receiveTimeNs >= jobs[current + 1].day * NS_PER_DAY) {
+                    int64_t nowNs = steadyNanoseconds();
+                    results[current].elapsedSeconds = (nowNs - runStartNs) * 1e-9;
+                    runStartNs = nowNs;
+                    ++current;
+                    dayStartNs = jobs[current].day * NS_PER_DAY;
+                    nextSampleNs = dayStartNs;
+                    countedFile = -1;
+                }
+                BacktestRunResult& result = results[current];
+                if (file != countedFile) {
+                    ++result.files;
+                    countedFile = file;
+                }
+
+                try {
+                    processor.processRawMessage(frame.bytes, frame.receiveTimeNs);
+                } catch (const std::exception&) {
+                    ++result.failedFrames;
+                }
+                if (frame.receiveTimeNs < dayStartNs) {
+                    ++result.warmupFrames;
+                    continue;
+                }
+                ++result.frames;
+                if (!processor.getSyncStats().synced) {
+                    ++result.unsyncedFrames;
+                    continue;
+                }
+                if (frame.receiveTimeNs < nextSampleNs) {
+                    continue;
+                }
+
+                BookSnapshot snapshot = processor.acquireSnapshot();
+                const OrderBook& book = snapshot.book();
+                if (snapshot.version() == sampledVersion || book.asks.empty() || book.bids.empty()) {
+                    continue;
+                }
+                sampledVersion = snapshot.version();
+                nextSampleNs = frame.receiveTimeNs + m_config.sampleIntervalNs;
+
+                BacktestCosts& costs = result.costs;
+                ++costs.samples;
+                ImpactEstimate estimate = processor.calculateImpactCurve(quantities, m_config.isBuy).front();
+                if (estimate.liquidityExhausted) {
+                    ++costs.unfilled;
+                    continue;
+                }
+                double mid = (book.price(book.asks.front()) + book.price(book.bids.front())) / 2.0;
+                double notional = m_config.orderQuantity * mid;
+                result.volume += notional;
+                costs.slippage.add(estimate.slippage);
+                costs.marketImpact.add(estimate.impact);
+                costs.modelImpact.add(model.calculateMarketImpact(
+                    m_config.orderQuantity, mid, m_config.impactModel.timeHorizon));
+                std::vector<TierCosts>& charged = tierCosts[current];
+                for (std::size_t tier = 0; tier < takerRates.size(); ++tier) {
+                    double fee = notional * takerRates[tier];
+                    charged[tier].fees.add(fee);
+                    charged[tier].totalCost.add(estimate.slippage * notional + fee);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        results[current].error = e.what();
+        for (std::size_t index = current + 1; index < range.endJob; ++index) {
+            results[index].error = std::string("not run after an earlier day failed: ") + e.what();
+        }
+    }
+    if (m_stopping.load(std::memory_order_relaxed)) {
+        for (std::size_t index = current + 1; index < range.endJob; ++index) {
+            results[index].error = "stopped";
+        }
+    }
+
+    results[current].elapsedSeconds = (steadyNanoseconds() - runStartNs) * 1e-9;
+}
+
+/**
+ * @brief Charges each run the fee tier its account volume reached
+ *
+ * Walks the runs by day. Every run of a day is charged the tier the
+ * tracker holds at the start of that day, and only then are the day's
+ * volumes recorded, so they count from the next day on. Failed runs add no
+ * volume.
+ *
+ * @param report Report whose runs to charge
+ * @param tierCosts Fee statistics of each run under every tier
+ */
+void BacktestRunner::chargeTrackedTiers(BacktestReport& report,
+                                        const std::vector<std::vector<TierCosts>>& tierCosts) const {
+    std::vector<std::size_t> byDay(report.runs.size());
+    std::iota(byDay.begin(), byDay.end(), 0);
+    std::stable_sort(byDay.begin(), byDay.end(), [&report](std::size_t a, std::size_t b) {
+        return report.runs[a].day < report.runs[b].day;
+    });
+
+    VolumeTracker tracker(m_config.feeSchedule,
+                          m_config.feeSchedule->find(m_config.feeExchange, m_config.feeProduct));
+    for (std::size_t first = 0; first < byDay.size();) {
+        int64_t day = report.runs[byDay[first]].day;
+        if (first == 0) {
+            tracker.reset(day * NS_PER_DAY, m_config.tradingVolume);
+        } else {
+            tracker.advanceTo(day * NS_PER_DAY);
+        }
+
+        std::size_t last = first;
+        for (; last < byDay.size() && report.runs[byDay[last]].day == day; ++last) {
+            BacktestRunResult& result = report.runs[byDay[last]];
+            const TierCosts& charged = tierCosts[byDay[last]][tracker.tier()];
+            result.feeTier = tracker.tier();
+            result.costs.fees = charged.fees;
+            result.costs.totalCost = charged.totalCost;
+        }
+        for (std::size_t i = first; i < last; ++i) {
+            const BacktestRunResult& result = report.runs[byDay[i]];
+            if (result.error.empty()) {
+                tracker.recordFill(day * NS_PER_DAY, result.volume);
+            }
+        }
+        first = last;
+    }
+}
+
+} // namespace GoQuant
@@ -0,0 +1,65 @@
+/**
+ * @file BookChecksum.cpp
+ * @brief Implementation of the exchange book checksum
+ *
+ * This file contains the formatting of the top levels into the checksum
+ * text and its CRC-32.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BookChecksum.h"
+#include "utils/Crc32.h"
+#include <algorithm>
+
+namespace GoQuant {
+
+/**
+ * @brief Computes the OKX checksum of the top @p depth levels
+ *
+ * The text is assembled in a stack buffer and checksummed in one pass, so
+ * verifying a book costs no allocation.
+ *
+ * @param book Book to checksum
+ * @param depth Levels per side to include
+ * @return std::int32_t Checksum, comparable with the "checksum" field of OKX frames
+ */
+std::int32_t bookChecksum(const OrderBook& book, std::size_t depth) {
+    // Each level is "price:size" plus a separator
+    constexpr std::size_t LEVEL_LENGTH = 2 * FixedPointScale::MAX_FORMAT_LENGTH + 2;
+    char buffer[2 * CHECKSUM_DEPTH * LEVEL_LENGTH];
+
+    std::uint32_t crc = 0;
+    std::size_t used = 0;
+    bool first = true;
+    auto append = [&](const OrderBookLevel& level) {
+        if (sizeof(buffer) - used < LEVEL_LENGTH) {
+            crc = crc32(buffer, used, crc);
+            used = 0;
+        }
+        if (!first) {
+            buffer[used++] = ':';
+        }
+        first = false;
+        used += book.spec.price.format(level.priceTicks, buffer + used);
+        buffer[used++] = ':';
+        used += book.spec.quantity.format(level.quantityLots, buffer + used);
+    };
+
+    std::size_t levels = std::min(depth, std::max(book.asks.size(), book.bids.size()));
+    for (std::size_t i = 0; i < levels; ++i) {
+        if (i < book.bids.size()) {
+            append(book.bids[i]);
+        }
+        if (i < book.asks.size()) {
+            append(book.asks[i]);
+        }
+    }
+
+    crc = crc32(buffer, used, crc);
+    return static_cast<std::int32_t>(crc);
+}
+
+} // namespace GoQuant
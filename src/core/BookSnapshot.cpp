@@ -0,0 +1,193 @@
+/**
+ * @file BookSnapshot.cpp
+ * @brief Implementation of lock-free order book version publication
+ *
+ * This file contains the slot reuse and publication logic of BookPublisher,
+ * the reference counting of BookSnapshot handles and the on-demand depth
+ * index of a published BookVersion.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BookSnapshot.h"
+#include <stdexcept>
+#include <utility>
+
+namespace GoQuant {
+
+/**
+ * @brief Sweeps one side for the given order size
+ *
+ * @param isBuy True to sweep the asks, false to sweep the bids
+ * @param quantityLots Order size in lots
+ * @return SweepResult Filled quantity, notional and levels touched
+ */
+SweepResult BookVersion::sweep(bool isBuy, double quantityLots) const {
+    size_t index = isBuy ? 0 : 1;
+    const BookSideArrays& levels = m_sides[index];
+
+    if (m_indexState[index].load(std::memory_order_acquire) != IndexReady &&
+        m_queryCount[index].fetch_add(1, std::memory_order_relaxed) + 1 < INDEX_BUILD_THRESHOLD) {
+        return sweepDepth(levels, quantityLots);
+    }
+    if (const CumulativeDepthIndex* depth = depthIndex(isBuy)) {
+        return depth->query(levels, quantityLots);
+    }
+    return sweepDepth(levels, quantityLots);
+}
+
+/**
+ * @brief Returns the cumulative depth index of one side, building it if possible
+ *
+ * The first caller claims the build with a compare-and-swap; callers that
+ * arrive while it is in progress get nullptr and sweep the arrays instead of
+ * waiting.
+ *
+ * @param isBuy True for the ask side, false for the bid side
+ * @return const CumulativeDepthIndex* The index, or nullptr while it is being built
+ */
+const CumulativeDepthIndex* BookVersion::depthIndex(bool isBuy) const {
+    size_t index = isBuy ? 0 : 1;
+    int state = m_indexState[index].load(std::memory_order_acquire);
+    if (state == IndexReady) {
+        return &m_index[index];
+    }
+
+    int expected = IndexEmpty;
+    if (state == IndexEmpty &&
+        m_indexState[index].compare_exchange_strong(expected, IndexBuilding,
+                                                    std::memory_order_acq_rel)) {
+        m_index[index].build(m_sides[index]);
+        m_indexState[index].store(IndexReady, std::memory_order_release);
+        return &m_index[index];
+    }
+    return nullptr;
+}
+
+BookSnapshot::BookSnapshot(const BookSnapshot& other)
+    : m_version(other.m_version)
+{
+    if (m_version) {
+        m_version->m_readers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+BookSnapshot::BookSnapshot(BookSnapshot&& other) noexcept
+    : m_version(std::exchange(other.m_version, nullptr))
+{
+}
+
+BookSnapshot& BookSnapshot::operator=(BookSnapshot other) noexcept {
+    std::swap(m_version, other.m_version);
+    return *this;
+}
+
+/**
+ * @brief Releases the reference, allowing the writer to reuse the slot
+ *
+ * The release ordering makes every read of the version happen before the
+ * writer's next overwrite of the slot.
+ */
+BookSnapshot::~BookSnapshot() {
+    if (m_version) {
+        m_version->m_readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Constructs a publisher with @p slots preallocated versions
+ *
+ * @param slots Number of slots, at least 2
+ * @param reservedDepth Levels reserved per side in each slot
+ * @throws std::invalid_argument if @p slots is less than 2
+ */
+BookPublisher::BookPublisher(std::size_t slots, std::size_t reservedDepth)
+    : m_slotCount(slots)
+{
+    if (slots < 2) {
+        throw std::invalid_argument("Book publisher needs at least two slots");
+    }
+
+    m_slots.reset(new BookVersion[slots]);
+    for (std::size_t i = 0; i < slots; ++i) {
+        m_slots[i].m_book.asks.reserve(reservedDepth);
+        m_slots[i].m_book.bids.reserve(reservedDepth);
+    }
+}
+
+/**
+ * @brief Publishes a copy of @p book as the current version
+ *
+ * A slot is reusable when it is not current and has no readers. The reader
+ * count is checked after the previous store to m_current, and readers
+ * re-check m_current after incrementing it; with sequentially consistent
+ * ordering on both sides, a reader that is missed by the check is
+ * guaranteed to see that its slot is no longer current and back off.
+ *
+ * @param book Book to publish
+ * @param version Version number to tag it with
+ * @param makerTakerProportion Maker/taker proportion to publish with it
+ * @return bool False if every spare slot was pinned and nothing was published
+ */
+bool BookPublisher::publish(const OrderBook& book, std::uint64_t version,
+                            double makerTakerProportion) {
+    const BookVersion* current = m_current.load(std::memory_order_relaxed);
+
+    BookVersion* slot = nullptr;
+    for (std::size_t i = 0; i < m_slotCount; ++i) {
+        BookVersion* candidate = &m_slots[(m_nextSlot + i) % m_slotCount];
+        if (candidate != current && candidate->m_readers.load(std::memory_order_seq_cst) == 0) {
+            slot = candidate;
+            m_nextSlot = (m_nextSlot + i + 1) % m_slotCount;
+            break;
+        }
+    }
+    if (!slot) {
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slot->m_book.asks.assign(book.asks.begin(), book.asks.end());
+    slot->m_book.bids.assign(book.bids.begin(), book.bids.end());
+    slot->m_book.instrument = book.instrument;
+    slot->m_book.exchangeTimeNs = book.exchangeTimeNs;
+    slot->m_book.receiveTimeNs = book.receiveTimeNs;
+    slot->m_book.spec = book.spec;
+    slot->m_version = version;
+    slot->m_makerTakerProportion = makerTakerProportion;
+    slot->m_sides[0].assign(book.asks);
+    slot->m_sides[1].assign(book.bids);
+    for (size_t side = 0; side < 2; ++side) {
+        slot->m_indexState[side].store(BookVersion::IndexEmpty, std::memory_order_relaxed);
+        slot->m_queryCount[side].store(0, std::memory_order_relaxed);
+    }
+
+    m_current.store(slot, std::memory_order_seq_cst);
+    return true;
+}
+
+/**
+ * @brief Returns a handle on the current version; safe from any thread
+ *
+ * Retries only if the writer replaced the current version between the load
+ * and the re-check, so the loop is lock-free and normally runs once.
+ *
+ * @return BookSnapshot Handle, empty before the first publication
+ */
+BookSnapshot BookPublisher::acquire() const {
+    for (;;) {
+        const BookVersion* version = m_current.load(std::memory_order_seq_cst);
+        if (!version) {
+            return BookSnapshot();
+        }
+        version->m_readers.fetch_add(1, std::memory_order_seq_cst);
+        if (m_current.load(std::memory_order_seq_cst) == version) {
+            return BookSnapshot(version);
+        }
+        version->m_readers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace GoQuant
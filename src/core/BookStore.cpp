@@ -0,0 +1,520 @@
+/**
+ * @file BookStore.cpp
+ * @brief Implementation of the columnar book store writer and reader
+ *
+ * This file contains the on-disk header, index and footer layouts, the
+ * column encoding of books and their memory-mapped decoding.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/BookStore.h"
+#include "core/InstrumentRegistry.h"
+#include "utils/Varint.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace GoQuant {
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'G', 'Q', 'B', 'O', 'O', 'K', 'S', '1'};  ///< Header signature
+constexpr char FOOTER_MAGIC[8] = {'G', 'Q', 'B', 'S', 'E', 'N', 'D', '1'};  ///< Footer signature
+constexpr uint32_t FORMAT_VERSION = 1;
+
+/// Column positions within a block
+enum ColumnIndex : std::size_t {
+    EXCHANGE_TIME = 0,
+    RECEIVE_TIME = 1,
+    ASK_COUNT = 2,
+    BID_COUNT = 3,
+    FIRST_BAND = 4   ///< Then ask prices, ask quantities, bid prices, bid quantities per band
+};
+
+/// Column of a band's prices (quantities follow it)
+constexpr std::size_t priceColumn(std::size_t band, bool isAsk) {
+    return FIRST_BAND + band * 4 + (isAsk ? 0 : 2);
+}
+
+/**
+ * @brief Fixed part of the file header; the exchange and symbol follow it
+ */
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;         ///< Including names and padding
+    double priceIncrement;
+    double quantityIncrement;
+    uint32_t maxDepth;           ///< 0 if every level was kept
+    uint16_t exchangeLength;
+    uint16_t symbolLength;
+};
+
+/**
+ * @brief Start of every block; the column sizes follow it
+ */
+struct BlockHeader {
+    uint32_t rows;
+    uint32_t columns;
+};
+
+/**
+ * @brief One index entry per block
+ */
+struct IndexEntry {
+    uint64_t offset;             ///< File offset of the BlockHeader
+    uint32_t rows;
+    uint32_t reserved;
+    int64_t minExchangeTimeNs;
+    int64_t maxExchangeTimeNs;
+};
+
+/**
+ * @brief Last bytes of the file
+ */
+struct Footer {
+    uint64_t indexOffset;
+    uint64_t rowCount;
+    uint32_t blockCount;
+    uint32_t reserved;
+    char magic[8];
+};
+
+/// Rounds @p size up to a multiple of 8
+constexpr std::size_t align8(std::size_t size) {
+    return (size + 7) & ~std::size_t(7);
+}
+
+/// First rank of a band
+constexpr std::size_t bandStart(std::size_t band) {
+    return band == 0 ? 0 : BookStoreFormat::BAND_LIMITS[band - 1];
+}
+
+[[noreturn]] void corrupt() {
+    throw std::runtime_error("Corrupt book store block");
+}
+
+} // namespace
+
+/**
+ * @brief Creates or truncates a store file
+ *
+ * @param path File to write
+ * @param maxDepth Levels kept per side; 0 keeps every level
+ * @param blockRows Books per block
+ * @throws std::runtime_error if the file cannot be created
+ */
+BookStoreWriter::BookStoreWriter(const QString& path, std::size_t maxDepth, std::size_t blockRows)
+    : m_file(path)
+    , m_maxDepth(maxDepth == 0 ? SIZE_MAX : maxDepth)
+    , m_blockRows(std::max<std::size_t>(blockRows, 1))
+    , m_columns(BookStoreFormat::COLUMN_COUNT)
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw std::runtime_error("Cannot create book store " + path.toStdString() + ": " +
+                                 m_file.errorString().toStdString());
+    }
+}
+
+/**
+ * @brief Closes the file, writing the index; errors are swallowed
+ */
+BookStoreWriter::~BookStoreWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+    }
+}
+
+/**
+ * @brief Appends a book
+ *
+ * The first book fixes the file's instrument and scales.
+ *
+ * @param book Book with asks ascending and bids descending
+ */
+void BookStoreWriter::append(const OrderBook& book) {
+    if (m_closed) {
+        throw std::logic_error("Book store is closed");
+    }
+    if (!m_headerWritten) {
+        m_instrument = book.instrument;
+        m_spec = book.spec;
+        writeHeader();
+    } else if (book.instrument != m_instrument || book.spec != m_spec) {
+        throw std::invalid_argument("A book store holds a single instrument");
+    }
+
+    if (m_blockRowsUsed == 0) {
+        m_block.minExchangeTimeNs = book.exchangeTimeNs;
+        m_block.maxExchangeTimeNs = book.exchangeTimeNs;
+    } else {
+        m_block.minExchangeTimeNs = std::min(m_block.minExchangeTimeNs, book.exchangeTimeNs);
+        m_block.maxExchangeTimeNs = std::max(m_block.maxExchangeTimeNs, book.exchangeTimeNs);
+    }
+
+    appendVarint(m_columns[EXCHANGE_TIME], zigzagEncode(book.exchangeTimeNs - m_previousExchangeTimeNs));
+    appendVarint(m_columns[RECEIVE_TIME], zigzagEncode(book.receiveTimeNs - m_previousReceiveTimeNs));
+    m_previousExchangeTimeNs = book.exchangeTimeNs;
+    m_previousReceiveTimeNs = book.receiveTimeNs;
+
+    appendSide(book.asks, true, m_previousBestAsk);
+    appendSide(book.bids, false, m_previousBestBid);
+
+    ++m_rowCount;
+    if (++m_blockRowsUsed == m_blockRows) {
+        flushBlock();
+    }
+}
+
+/**
+ * @brief Encodes the count and levels of one side into the block's columns
+ *
+ * Price deltas are stored zigzag-encoded, so an unsorted side still round
+ * trips, only less compactly.
+ */
+void BookStoreWriter::appendSide(const std::vector<OrderBookLevel>& levels, bool isAsk,
+                                 Ticks& previousBest) {
+    std::size_t count = std::min(levels.size(), m_maxDepth);
+    appendVarint(m_columns[isAsk ? ASK_COUNT : BID_COUNT], count);
+
+    std::size_t band = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        while (i >= BookStoreFormat::BAND_LIMITS[band]) {
+            ++band;
+        }
+        std::string& prices = m_columns[priceColumn(band, isAsk)];
+        std::string& quantities = m_columns[priceColumn(band, isAsk) + 1];
+
+        Ticks price = levels[i].priceTicks;
+        Ticks delta;
+        if (i == 0) {
+            delta = price - previousBest;
+            previousBest = price;
+        } else {
+            delta = isAsk ? price - levels[i - 1].priceTicks : levels[i - 1].priceTicks - price;
+        }
+        appendVarint(prices, zigzagEncode(delta));
+        appendVarint(quantities, static_cast<uint64_t>(levels[i].quantityLots));
+    }
+}
+
+/**
+ * @brief Writes the last block, the index and the footer, and closes the file
+ */
+void BookStoreWriter::close() {
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+    if (!m_headerWritten) {
+        writeHeader();
+    }
+    flushBlock();
+
+    Footer footer{};
+    footer.indexOffset = static_cast<uint64_t>(m_bytesWritten);
+    footer.rowCount = m_rowCount;
+    footer.blockCount = static_cast<uint32_t>(m_index.size() / sizeof(IndexEntry));
+    std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(footer.magic));
+    write(m_index.data(), m_index.size());
+    write(&footer, sizeof(footer));
+    m_file.close();
+}
+
+/**
+ * @brief Writes the file header for the instrument of the first book
+ */
+void BookStoreWriter::writeHeader() {
+    const InstrumentRegistry& registry = InstrumentRegistry::instance();
+    const std::string& exchange = registry.exchange(m_instrument);
+    const std::string& symbol = registry.symbol(m_instrument);
+
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.priceIncrement = m_spec.price.increment();
+    header.quantityIncrement = m_spec.quantity.increment();
+    header.maxDepth = m_maxDepth == SIZE_MAX ? 0 : static_cast<uint32_t>(m_maxDepth);
+    header.exchangeLength = static_cast<uint16_t>(exchange.size());
+    header.symbolLength = static_cast<uint16_t>(symbol.size());
+    header.headerSize = static_cast<uint32_t>(
+        align8(sizeof(header) + header.exchangeLength + header.symbolLength));
+
+    std::string bytes(header.headerSize, '\0');
+    std::memcpy(&bytes[0], &header, sizeof(header));
+    std::memcpy(&bytes[sizeof(header)], exchange.data(), header.exchangeLength);
+    std::memcpy(&bytes[sizeof(header) + header.exchangeLength], symbol.data(), header.symbolLength);
+    write(bytes.data(), bytes.size());
+    m_headerWritten = true;
+}
+
+/**
+ * @brief Writes the buffered block and its index entry, and starts a new block
+ *
+ * Delta bases reset at every block, so each block decodes on its own.
+ */
+void BookStoreWriter::flushBlock() {
+    if (m_blockRowsUsed == 0) {
+        return;
+    }
+
+    IndexEntry entry{};
+    entry.offset = static_cast<uint64_t>(m_bytesWritten);
+    entry.rows = static_cast<uint32_t>(m_blockRowsUsed);
+    entry.minExchangeTimeNs = m_block.minExchangeTimeNs;
+    entry.maxExchangeTimeNs = m_block.maxExchangeTimeNs;
+    m_index.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+    BlockHeader header{static_cast<uint32_t>(m_blockRowsUsed),
+                       static_cast<uint32_t>(BookStoreFormat::COLUMN_COUNT)};
+    uint32_t sizes[BookStoreFormat::COLUMN_COUNT];
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < BookStoreFormat::COLUMN_COUNT; ++i) {
+        sizes[i] = static_cast<uint32_t>(m_columns[i].size());
+        total += m_columns[i].size();
+    }
+    write(&header, sizeof(header));
+    write(sizes, sizeof(sizes));
+    for (std::string& column : m_columns) {
+        write(column.data(), column.size());
+        column.clear();
+    }
+    std::size_t padding = align8(sizeof(header) + sizeof(sizes) + total) -
+                          (sizeof(header) + sizeof(sizes) + total);
+    static const char zeros[8] = {};
+    write(zeros, padding);
+
+    m_blockRowsUsed = 0;
+    m_previousExchangeTimeNs = 0;
+    m_previousReceiveTimeNs = 0;
+    m_previousBestAsk = 0;
+    m_previousBestBid = 0;
+}
+
+/**
+ * @brief Writes raw bytes and counts them
+ *
+ * @throws std::runtime_error if the write fails
+ */
+void BookStoreWriter::write(const void* data, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (m_file.write(static_cast<const char*>(data), static_cast<qint64>(size)) !=
+        static_cast<qint64>(size)) {
+        throw std::runtime_error("Cannot write book store: " + m_file.errorString().toStdString());
+    }
+    m_bytesWritten += static_cast<int64_t>(size);
+}
+
+/**
+ * @brief Opens and maps a store file
+ *
+ * The footer must be intact, so a file whose writer was not closed is
+ * rejected rather than read partially.
+ *
+ * @param path File written by BookStoreWriter
+ * @throws std::runtime_error if the file cannot be mapped or is not a complete store
+ */
+BookStoreReader::BookStoreReader(const QString& path)
+    : m_file(path)
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Cannot open book store " + path.toStdString() + ": " +
+                                 m_file.errorString().toStdString());
+    }
+    m_size = m_file.size();
+    if (m_size < static_cast<int64_t>(sizeof(FileHeader) + sizeof(Footer)) ||
+        !(m_data = m_file.map(0, m_size))) {
+        throw std::runtime_error("Cannot map book store " + path.toStdString());
+    }
+
+    FileHeader header;
+    Footer footer;
+    std::memcpy(&header, m_data, sizeof(header));
+    std::memcpy(&footer, m_data + m_size - sizeof(footer), sizeof(footer));
+    bool valid = std::memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) == 0 &&
+                 std::memcmp(footer.magic, FOOTER_MAGIC, sizeof(footer.magic)) == 0 &&
+                 header.version == FORMAT_VERSION &&
+                 header.headerSize >= sizeof(header) + header.exchangeLength + header.symbolLength &&
+                 static_cast<int64_t>(header.headerSize) <= m_size &&
+                 footer.indexOffset >= header.headerSize &&
+                 footer.indexOffset + uint64_t(footer.blockCount) * sizeof(IndexEntry) +
+                     sizeof(Footer) == static_cast<uint64_t>(m_size);
+    if (!valid) {
+        throw std::runtime_error("Not a complete book store: " + path.toStdString());
+    }
+
+    const char* names = reinterpret_cast<const char*>(m_data + sizeof(header));
+    m_instrument = InstrumentRegistry::instance().intern(
+        std::string_view(names, header.exchangeLength),
+        std::string_view(names + header.exchangeLength, header.symbolLength));
+    m_spec.price = FixedPointScale(header.priceIncrement);
+    m_spec.quantity = FixedPointScale(header.quantityIncrement);
+    m_rowCount = footer.rowCount;
+    m_blockCount = footer.blockCount;
+    m_headerSize = header.headerSize;
+    m_indexOffset = static_cast<int64_t>(footer.indexOffset);
+}
+
+/**
+ * @brief Unmaps and closes the file
+ */
+BookStoreReader::~BookStoreReader() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+}
+
+/**
+ * @brief Returns the index entry of a block
+ *
+ * @param index Block position, 0 being the first written
+ * @throws std::out_of_range if @p index >= blockCount()
+ */
+BookStoreBlock BookStoreReader::block(std::size_t index) const {
+    if (index >= m_blockCount) {
+        throw std::out_of_range("Book store block out of range");
+    }
+    IndexEntry entry;
+    std::memcpy(&entry, m_data + m_indexOffset + index * sizeof(IndexEntry), sizeof(entry));
+    return {entry.rows, entry.minExchangeTimeNs, entry.maxExchangeTimeNs};
+}
+
+/**
+ * @brief Locates the columns of a block and works out which bands @p depth needs
+ *
+ * @throws std::runtime_error if the block's layout does not fit the file
+ */
+BookStoreReader::BlockCursor::BlockCursor(const BookStoreReader& reader, std::size_t block,
+                                          std::size_t depth)
+    : m_reader(reader)
+    , m_depth(depth)
+    , m_bands(0)
+{
+    IndexEntry entry;
+    std::memcpy(&entry, reader.m_data + reader.m_indexOffset + block * sizeof(IndexEntry),
+                sizeof(entry));
+
+    // The offset is bounded before adding to it, so a corrupt entry cannot
+    // wrap around the end-of-blocks check
+    if (entry.offset < static_cast<uint64_t>(reader.m_headerSize) ||
+        entry.offset > static_cast<uint64_t>(reader.m_indexOffset)) {
+        corrupt();
+    }
+    const int64_t sizesEnd = static_cast<int64_t>(entry.offset) + sizeof(BlockHeader) +
+                             BookStoreFormat::COLUMN_COUNT * sizeof(uint32_t);
+    if (sizesEnd > reader.m_indexOffset) {
+        corrupt();
+    }
+    BlockHeader header;
+    std::memcpy(&header, reader.m_data + entry.offset, sizeof(header));
+    if (header.columns != BookStoreFormat::COLUMN_COUNT || header.rows != entry.rows) {
+        corrupt();
+    }
+    uint32_t sizes[BookStoreFormat::COLUMN_COUNT];
+    std::memcpy(sizes, reader.m_data + entry.offset + sizeof(header), sizeof(sizes));
+
+    const unsigned char* pos = reader.m_data + sizesEnd;
+    const unsigned char* limit = reader.m_data + reader.m_indexOffset;
+    for (std::size_t i = 0; i < BookStoreFormat::COLUMN_COUNT; ++i) {
+        if (sizes[i] > static_cast<std::size_t>(limit - pos)) {
+            corrupt();
+        }
+        m_columns[i].pos = pos;
+        m_columns[i].end = pos + sizes[i];
+        pos += sizes[i];
+    }
+
+    while (m_bands < BookStoreFormat::BAND_COUNT && bandStart(m_bands) < depth) {
+        ++m_bands;
+    }
+    m_rowsLeft = header.rows;
+}
+
+/**
+ * @brief Decodes the next book into @p book
+ *
+ * Bands beyond the requested depth are never read. A band that is only
+ * partly needed is still decoded to the end of each book's run, to keep
+ * its column position in step.
+ *
+ * @return bool False once every book of the block was read
+ */
+bool BookStoreReader::BlockCursor::next(OrderBook& book) {
+    if (m_rowsLeft == 0) {
+        return false;
+    }
+    --m_rowsLeft;
+
+    m_exchangeTimeNs += zigzagDecode(readUnsigned(m_columns[EXCHANGE_TIME]));
+    m_receiveTimeNs += zigzagDecode(readUnsigned(m_columns[RECEIVE_TIME]));
+    std::size_t askCount = static_cast<std::size_t>(readUnsigned(m_columns[ASK_COUNT]));
+    std::size_t bidCount = static_cast<std::size_t>(readUnsigned(m_columns[BID_COUNT]));
+
+    book.instrument = m_reader.m_instrument;
+    book.spec = m_reader.m_spec;
+    book.exchangeTimeNs = m_exchangeTimeNs;
+    book.receiveTimeNs = m_receiveTimeNs;
+    readSide(askCount, true, m_bestAsk, book.asks);
+    readSide(bidCount, false, m_bestBid, book.bids);
+    return true;
+}
+
+/**
+ * @brief Reads one varint from a column
+ *
+ * @throws std::runtime_error if the column ends inside it
+ */
+uint64_t BookStoreReader::BlockCursor::readUnsigned(Column& column) {
+    uint64_t value;
+    if (!readVarint(column.pos, column.end, value)) {
+        corrupt();
+    }
+    return value;
+}
+
+/**
+ * @brief Decodes the needed bands of one side into @p out
+ *
+ * @param levels Levels stored for the side
+ * @param isAsk True for asks, whose prices ascend
+ * @param best Best price of the previous book on this side; updated
+ * @param out Receives the top min(levels, depth) levels
+ */
+void BookStoreReader::BlockCursor::readSide(std::size_t levels, bool isAsk, Ticks& best,
+                                            std::vector<OrderBookLevel>& out) {
+    std::size_t kept = std::min(levels, m_depth);
+    out.resize(kept);
+
+    Ticks price = 0;
+    for (std::size_t band = 0; band < m_bands; ++band) {
+        std::size_t first = bandStart(band);
+        std::size_t last = std::min(levels, BookStoreFormat::BAND_LIMITS[band]);
+        if (first >= last) {
+            break;
+        }
+        Column& prices = m_columns[priceColumn(band, isAsk)];
+        Column& quantities = m_columns[priceColumn(band, isAsk) + 1];
+        for (std::size_t i = first; i < last; ++i) {
+            int64_t delta = zigzagDecode(readUnsigned(prices));
+            uint64_t quantity = readUnsigned(quantities);
+            if (i == 0) {
+                best += delta;
+                price = best;
+            } else {
+                price = isAsk ? price + delta : price - delta;
+            }
+            if (i < kept) {
+                out[i] = {price, static_cast<Lots>(quantity)};
+            }
+        }
+    }
+}
+
+} // namespace GoQuant
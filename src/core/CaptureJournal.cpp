@@ -0,0 +1,303 @@
+/**
+ * @file CaptureJournal.cpp
+ * @brief Implementation of the memory-mapped CaptureJournal
+ *
+ * This file contains the receive-path handoff, the background writer loop
+ * and the creation, rotation and truncation of journal files.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/CaptureJournal.h"
+#include "core/OrderBookParser.h"
+#include "core/Timestamp.h"
+#include <QDateTime>
+#include <QDir>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace GoQuant {
+
+namespace {
+
+/// How long the writer sleeps when the ring is empty
+constexpr std::chrono::milliseconds WRITER_IDLE_SLEEP(1);
+
+} // namespace
+
+/**
+ * @brief Opens the first file and starts the writer thread
+ *
+ * @param config Directory, rotation limits and queue size
+ * @throws std::invalid_argument if the file size limit cannot hold a record
+ * @throws std::runtime_error if the directory or first file cannot be created
+ */
+CaptureJournal::CaptureJournal(const CaptureConfig& config)
+    : m_config(config)
+    , m_ring(config.queueCapacity)
+{
+    if (m_config.maxFileBytes < static_cast<int64_t>(sizeof(Journal::FileHeader) + Journal::recordSize(0))) {
+        throw std::invalid_argument("Capture file size limit is too small");
+    }
+    if (!QDir().mkpath(m_config.directory)) {
+        throw std::runtime_error("Cannot create capture directory: " + m_config.directory.toStdString());
+    }
+
+    openFile(0);
+    m_writer = std::thread([this]() { runWriter(); });
+}
+
+/**
+ * @brief Writes every queued frame, then truncates and closes the file
+ *
+ * The producer must have stopped calling append() before destruction.
+ */
+CaptureJournal::~CaptureJournal() {
+    m_stopping.store(true, std::memory_order_release);
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    closeFile();
+}
+
+/**
+ * @brief Queues a frame for the writer; never blocks
+ *
+ * Costs one copy into the reused buffer of a ring slot. The writer is not
+ * woken: it polls, so the receive path makes no system call. Empty frames
+ * are skipped, as the WebSocket can deliver them and they hold nothing to
+ * replay.
+ *
+ * @param frame Raw frame bytes
+ * @param receiveTimeNs Wall-clock receive time, ns since the epoch
+ * @return bool False if the ring was full and the frame was dropped
+ */
+bool CaptureJournal::append(std::string_view frame, int64_t receiveTimeNs) {
+    if (frame.empty()) {
+        return true;
+    }
+    PendingFrame* slot = m_ring.acquireSlot();
+    if (!slot) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot->bytes.assign(frame.data(), frame.size());
+    slot->receiveTimeNs = receiveTimeNs;
+    m_ring.publish();
+
+    size_t depth = m_ring.size();
+    if (depth > m_queueHighWater.load(std::memory_order_relaxed)) {
+        m_queueHighWater.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the journal counters; safe from any thread
+ */
+CaptureStats CaptureJournal::stats() const {
+    CaptureStats stats{};
+    stats.framesCaptured = m_framesCaptured.load(std::memory_order_relaxed);
+    stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+    stats.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+    stats.filesOpened = m_filesOpened.load(std::memory_order_relaxed);
+    stats.queueHighWater = m_queueHighWater.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_fileNameMutex);
+        stats.currentFile = m_fileName;
+    }
+    return stats;
+}
+
+/**
+ * @brief Writer thread loop: drains the ring into the current file
+ *
+ * While idle it also closes a file that has outlived its age limit, so a
+ * quiet feed does not keep one file open indefinitely; the next frame opens
+ * a new one. The stop flag is read before the ring, so every frame
+ * published before the destructor ran is written.
+ */
+void CaptureJournal::runWriter() {
+    for (;;) {
+        bool stopping = m_stopping.load(std::memory_order_acquire);
+        PendingFrame* frame = m_ring.front();
+        if (!frame) {
+            if (stopping) {
+                return;
+            }
+            if (m_map && m_config.maxFileAgeNs > 0 &&
+                steadyNanoseconds() - m_fileOpenedNs >= m_config.maxFileAgeNs) {
+                closeFile();
+            }
+            std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+            continue;
+        }
+        writeFrame(*frame);
+        m_ring.pop();
+    }
+}
+
+/**
+ * @brief Resolves the frame's instrument and writes it, defining the instrument if new
+ *
+ * Room for an instrument record is reserved whenever the instrument is
+ * known, since a rotation triggered by this frame starts a file in which
+ * nothing is defined yet. Frames that cannot be written because no file
+ * could be opened are counted as dropped.
+ */
+void CaptureJournal::writeFrame(const PendingFrame& frame) {
+    std::string_view bytes(frame.bytes);
+    InstrumentRegistry& registry = InstrumentRegistry::instance();
+
+    InstrumentId instrument = UNKNOWN_INSTRUMENT;
+    std::string_view exchange;
+    std::string_view symbol;
+    if (OrderBookParser::peekInstrument(bytes, exchange, symbol)) {
+        try {
+            instrument = registry.intern(exchange, symbol);
+        } catch (const std::length_error&) {
+            instrument = UNKNOWN_INSTRUMENT;
+        }
+    }
+
+    int64_t needed = static_cast<int64_t>(Journal::recordSize(static_cast<uint32_t>(bytes.size())));
+    if (instrument != UNKNOWN_INSTRUMENT) {
+        needed += static_cast<int64_t>(Journal::recordSize(static_cast<uint32_t>(
+            registry.exchange(instrument).size() + 1 + registry.symbol(instrument).size())));
+    }
+    if (!reserve(needed)) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (instrument != UNKNOWN_INSTRUMENT && m_definedInstruments.insert(instrument).second) {
+        std::string definition = registry.exchange(instrument);
+        definition.push_back('\0');
+        definition.append(registry.symbol(instrument));
+        writeRecord(Journal::InstrumentRecord, instrument, frame.receiveTimeNs, definition);
+    }
+    writeRecord(Journal::FrameRecord, instrument, frame.receiveTimeNs, bytes);
+    m_framesCaptured.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Makes room for @p bytes in the current file, rotating if needed
+ *
+ * The file is rotated when the records would not fit or the file has
+ * reached its age limit.
+ *
+ * @return bool False if a new file was needed and could not be opened
+ */
+bool CaptureJournal::reserve(int64_t bytes) {
+    if (m_map) {
+        bool full = m_used + bytes > m_capacity;
+        bool expired = m_config.maxFileAgeNs > 0 &&
+                       steadyNanoseconds() - m_fileOpenedNs >= m_config.maxFileAgeNs;
+        if (full || expired) {
+            closeFile();
+        }
+    }
+    if (!m_map) {
+        try {
+            openFile(bytes);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copies one record into the mapping at the write position
+ *
+ * Padding is left as is: the file was zero-filled when it was extended.
+ */
+void CaptureJournal::writeRecord(uint16_t type, InstrumentId instrument, int64_t receiveTimeNs,
+                                 std::string_view payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+
+    Journal::RecordHeader header{};
+    header.length = length;
+    header.type = type;
+    header.receiveTimeNs = receiveTimeNs;
+    header.instrument = instrument;
+
+    uchar* out = m_map + m_used;
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), payload.data(), payload.size());
+
+    int64_t size = static_cast<int64_t>(Journal::recordSize(length));
+    m_used += size;
+    m_bytesWritten.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Creates, preallocates and maps the next file
+ *
+ * Files are named <prefix>-<UTC creation time>-<sequence>.gqj, so they sort
+ * in creation order. A file is normally maxFileBytes long, but grows to hold
+ * a single record larger than that.
+ *
+ * @param minimumBytes Record bytes the file must have room for
+ * @throws std::runtime_error if the file cannot be created, extended or mapped
+ */
+void CaptureJournal::openFile(int64_t minimumBytes) {
+    int64_t capacity = std::max<int64_t>(
+        m_config.maxFileBytes, static_cast<int64_t>(sizeof(Journal::FileHeader)) + minimumBytes);
+    QString name = QDir(m_config.directory).filePath(
+        QString("%1-%2-%3.gqj")
+            .arg(m_config.prefix,
+                 QDateTime::currentDateTimeUtc().toString("yyyyMMdd-HHmmss"))
+            .arg(m_fileSequence, 6, 10, QChar('0')));
+    ++m_fileSequence;
+
+    m_file.setFileName(name);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        throw std::runtime_error("Cannot create capture file " + name.toStdString() + ": " +
+                                 m_file.errorString().toStdString());
+    }
+    if (!m_file.resize(capacity) || !(m_map = m_file.map(0, capacity))) {
+        std::string reason = m_file.errorString().toStdString();
+        m_file.close();
+        m_file.remove();
+        throw std::runtime_error("Cannot map capture file " + name.toStdString() + ": " + reason);
+    }
+    m_capacity = capacity;
+    m_fileOpenedNs = steadyNanoseconds();
+    m_definedInstruments.clear();
+
+    Journal::FileHeader header{};
+    std::memcpy(header.magic, Journal::MAGIC, sizeof(header.magic));
+    header.version = Journal::FORMAT_VERSION;
+    header.headerSize = sizeof(header);
+    header.createdTimeNs = wallClockNanoseconds();
+    std::memcpy(m_map, &header, sizeof(header));
+    m_used = sizeof(header);
+    m_bytesWritten.fetch_add(sizeof(header), std::memory_order_relaxed);
+    m_filesOpened.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_fileNameMutex);
+    m_fileName = name;
+}
+
+/**
+ * @brief Unmaps the current file and truncates it to the bytes written
+ */
+void CaptureJournal::closeFile() {
+    if (!m_map) {
+        return;
+    }
+    m_file.unmap(m_map);
+    m_map = nullptr;
+    m_file.resize(m_used);
+    m_file.close();
+
+    std::lock_guard<std::mutex> lock(m_fileNameMutex);
+    m_fileName.clear();
+}
+
+} // namespace GoQuant
@@ -4,7 +4,8 @@
  * 
  * This file contains the implementation of the FeeCalculator class, which handles
  * calculation of trading fees based on exchange-specific fee tiers and trading volumes.
- * Supports multiple exchanges and dynamic fee tier selection based on trading volume.
+ * Supports multiple exchanges and dynamic fee tier selection based on trading volume,
+ * with the tiers themselves held in a FeeSchedule.
  * 
  * @author GoQuant Team
  * @version 1.0
@@ -12,42 +13,35 @@
  */
 
 #include "core/FeeCalculator.h"
-#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace GoQuant {
 
 /**
  * @brief Constructs a new FeeCalculator instance
  * 
- * Initializes the fee calculator with default fee tiers for supported exchanges.
- * Currently supports OKX exchange with multiple VIP tiers.
+ * Initializes the fee calculator with the built-in OKX spot tiers, starting
+ * at the Regular tier.
  */
-FeeCalculator::FeeCalculator() {
-    initializeFeeTiers();
+FeeCalculator::FeeCalculator()
+    : FeeCalculator(FeeSchedule::builtIn())
+{
 }
 
 /**
- * @brief Initializes fee tiers for supported exchanges
+ * @brief Constructs a fee calculator on a loaded schedule
  * 
- * Sets up the fee structure for different exchanges and their VIP tiers.
- * Each tier includes maker fee, taker fee, and minimum trading volume requirements.
+ * @param schedule Fee schedule, typically from FeeSchedule::loadFile()
+ * @throws std::invalid_argument if @p schedule is null or empty
  */
-void FeeCalculator::initializeFeeTiers() {
-    // OKX fee tiers (as of 2024)
-    std::vector<FeeTier> okxTiers = {
-        {0.0008, 0.0010, 0.0},           // Regular
-        {0.0007, 0.0009, 50000.0},       // VIP1
-        {0.0006, 0.0008, 100000.0},      // VIP2
-        {0.0005, 0.0007, 500000.0},      // VIP3
-        {0.0004, 0.0006, 1000000.0},     // VIP4
-        {0.0003, 0.0005, 5000000.0},     // VIP5
-        {0.0002, 0.0004, 10000000.0}     // VIP6
-    };
-    m_feeTiers["OKX"] = std::move(okxTiers);
-
-    // Set default tier
-    m_currentTier = m_feeTiers["OKX"][0];
+FeeCalculator::FeeCalculator(std::shared_ptr<const FeeSchedule> schedule)
+    : m_schedule(std::move(schedule))
+{
+    if (!m_schedule || m_schedule->scheduleCount() == 0) {
+        throw std::invalid_argument("Fee schedule is empty");
+    }
+    selectTier(0, 0);
 }
 
 /**
@@ -58,25 +52,59 @@ void FeeCalculator::initializeFeeTiers() {
  * 
  * @param exchange Exchange name (e.g., "OKX")
  * @param tradingVolume Total trading volume in base currency
+ * @param product Product type (e.g., "spot" or "swap")
  * @throws std::invalid_argument if exchange is not supported
  */
-void FeeCalculator::setFeeTier(const std::string& exchange, double tradingVolume) {
-    auto it = m_feeTiers.find(exchange);
-    if (it == m_feeTiers.end()) {
-        throw std::invalid_argument("Unsupported exchange: " + exchange);
-    }
+void FeeCalculator::setFeeTier(const std::string& exchange, double tradingVolume,
+                               const std::string& product) {
+    FeeScheduleId schedule = findSchedule(exchange, product);
+    m_tracker.reset();
+    selectTier(schedule, m_schedule->tierForVolume(schedule, tradingVolume));
+}
 
-    const auto& tiers = it->second;
-    auto tierIt = std::find_if(tiers.rbegin(), tiers.rend(),
-        [tradingVolume](const FeeTier& tier) {
-            return tradingVolume >= tier.minVolume;
-        });
+/**
+ * @brief Lets recorded fills set the fee tier from now on
+ * 
+ * The tier starts at the one @p priorVolume qualifies for, and moves as
+ * fills enter and leave the rolling 30-day window.
+ * 
+ * @param exchange Exchange name (e.g., "OKX")
+ * @param timeNs Current time, in nanoseconds since the epoch
+ * @param priorVolume Trading volume of the 30 days before, in USD
+ * @param product Product type (e.g., "spot" or "swap")
+ * @throws std::invalid_argument if exchange is not supported or
+ *         @p priorVolume is negative
+ */
+void FeeCalculator::trackVolume(const std::string& exchange, int64_t timeNs, double priorVolume,
+                                const std::string& product) {
+    FeeScheduleId schedule = findSchedule(exchange, product);
+    VolumeTracker tracker(m_schedule, schedule);
+    tracker.reset(timeNs, priorVolume);
+    m_tracker = std::move(tracker);
+    selectTier(schedule, m_tracker->tier());
+}
 
-    if (tierIt != tiers.rend()) {
-        m_currentTier = *tierIt;
-    } else {
-        m_currentTier = tiers[0];  // Default to lowest tier
+/**
+ * @brief Adds a fill to the tracked volume
+ * 
+ * Only reselects the tier when the tracker reports a change, which happens
+ * at most once a day for fills in time order.
+ * 
+ * @param timeNs Time of the fill, in nanoseconds since the epoch
+ * @param notional Traded value in USD
+ * @return bool True if the fee tier changed
+ * @throws std::logic_error if volume is not being tracked
+ * @throws std::invalid_argument if @p notional is negative
+ */
+bool FeeCalculator::recordFill(int64_t timeNs, double notional) {
+    if (!m_tracker) {
+        throw std::logic_error("Fee tier is not tracking volume");
+    }
+    if (!m_tracker->recordFill(timeNs, notional)) {
+        return false;
     }
+    selectTier(m_tracker->scheduleId(), m_tracker->tier());
+    return true;
 }
 
 /**
@@ -108,4 +136,51 @@ const FeeCalculator::FeeTier& FeeCalculator::getCurrentFeeTier() const {
     return m_currentTier;
 }
 
+/**
+ * @brief Returns the schedule the tiers come from
+ * 
+ * @return const std::shared_ptr<const FeeSchedule>& Shared, immutable schedule
+ */
+const std::shared_ptr<const FeeSchedule>& FeeCalculator::getSchedule() const {
+    return m_schedule;
+}
+
+/**
+ * @brief Returns the volume tracker, or null if the tier is set by volume
+ * 
+ * @return const VolumeTracker* Tracker started by trackVolume()
+ */
+const VolumeTracker* FeeCalculator::getVolumeTracker() const {
+    return m_tracker ? &*m_tracker : nullptr;
+}
+
+/**
+ * @brief Makes a tier of the schedule the current one
+ * 
+ * @param schedule Schedule ID
+ * @param tier Tier index within the schedule
+ */
+void FeeCalculator::selectTier(FeeScheduleId schedule, std::uint32_t tier) {
+    m_currentTier = {m_schedule->rate(schedule, tier, true),
+                     m_schedule->rate(schedule, tier, false),
+                     m_schedule->minVolume(schedule, tier)};
+}
+
+/**
+ * @brief Looks up a schedule, rejecting unknown ones
+ * 
+ * @param exchange Exchange name
+ * @param product Product type
+ * @return FeeScheduleId Schedule ID
+ * @throws std::invalid_argument if exchange is not supported
+ */
+FeeScheduleId FeeCalculator::findSchedule(const std::string& exchange,
+                                          const std::string& product) const {
+    FeeScheduleId schedule = m_schedule->find(exchange, product);
+    if (schedule == INVALID_FEE_SCHEDULE) {
+        throw std::invalid_argument("Unsupported exchange: " + exchange + " " + product);
+    }
+    return schedule;
+}
+
 } // namespace GoQuant 
\ No newline at end of file
@@ -0,0 +1,241 @@
+/**
+ * @file FeeSchedule.cpp
+ * @brief Implementation of the FeeSchedule class
+ *
+ * This file contains the compilation of fee configurations into flat rate
+ * tables, the built-in schedule and the single and batched fee lookups.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/FeeSchedule.h"
+#include <QFile>
+#include <algorithm>
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Compiles a schedule from its JSON configuration
+ *
+ * Tiers of all schedules are appended to the same flat tables, so a tier is
+ * addressed by its schedule's first index plus its rank. Maker rates may be
+ * negative, for venues that pay rebates.
+ *
+ * @param config Configuration object
+ * @return FeeSchedule Compiled schedule
+ * @throws std::invalid_argument if the configuration is invalid
+ */
+FeeSchedule FeeSchedule::fromJson(const nlohmann::json& config) {
+    FeeSchedule schedule;
+    try {
+        for (const nlohmann::json& exchange : config.at("exchanges")) {
+            std::string name = exchange.at("name").get<std::string>();
+            for (const auto& product : exchange.at("products").items()) {
+                const nlohmann::json& tiers = product.value();
+                if (!tiers.is_array() || tiers.empty()) {
+                    throw std::invalid_argument("No tiers for " + name + " " + product.key());
+                }
+
+                auto id = static_cast<FeeScheduleId>(schedule.m_schedules.size());
+                if (!schedule.m_ids.emplace(makeKey(name, product.key()), id).second) {
+                    throw std::invalid_argument("Duplicate fee schedule: " + name + " " + product.key());
+                }
+                schedule.m_schedules.push_back({name, product.key(),
+                    static_cast<std::uint32_t>(schedule.m_tierNames.size()),
+                    static_cast<std::uint32_t>(tiers.size())});
+
+                for (const nlohmann::json& tier : tiers) {
+                    double minVolume = tier.at("minVolume").get<double>();
+                    bool ordered = schedule.m_minVolumes.size() == schedule.m_schedules.back().firstTier ||
+                                   minVolume > schedule.m_minVolumes.back();
+                    if (minVolume < 0.0 || !ordered) {
+                        throw std::invalid_argument("Fee tiers of " + name + " " + product.key() +
+                                                    " must have ascending, non-negative volumes");
+                    }
+                    double taker = tier.at("taker").get<double>();
+                    if (taker < 0.0) {
+                        throw std::invalid_argument("Negative taker fee for " + name + " " + product.key());
+                    }
+                    schedule.m_rates.push_back(taker);
+                    schedule.m_rates.push_back(tier.at("maker").get<double>());
+                    schedule.m_minVolumes.push_back(minVolume);
+                    schedule.m_tierNames.push_back(tier.value("tier", std::string()));
+                }
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        throw std::invalid_argument(std::string("Invalid fee configuration: ") + e.what());
+    }
+    return schedule;
+}
+
+/**
+ * @brief Reads and compiles a configuration file
+ *
+ * @param path JSON configuration file
+ * @return FeeSchedule Compiled schedule
+ * @throws std::runtime_error if the file cannot be read or is not JSON
+ * @throws std::invalid_argument if the configuration is invalid
+ */
+FeeSchedule FeeSchedule::loadFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Cannot open fee configuration " + path.toStdString());
+    }
+    QByteArray data = file.readAll();
+
+    nlohmann::json config;
+    try {
+        config = nlohmann::json::parse(data.constData(), data.constData() + data.size());
+    } catch (const nlohmann::json::parse_error& e) {
+        throw std::runtime_error("Cannot parse fee configuration " + path.toStdString() +
+                                 ": " + e.what());
+    }
+    return fromJson(config);
+}
+
+/**
+ * @brief Returns the built-in schedule: the OKX spot tiers
+ *
+ * These are the tiers FeeCalculator has always used; a configuration file
+ * replaces them.
+ */
+std::shared_ptr<const FeeSchedule> FeeSchedule::builtIn() {
+    static const std::shared_ptr<const FeeSchedule> schedule =
+        std::make_shared<const FeeSchedule>(fromJson(nlohmann::json::parse(R"({
+        "exchanges": [{"name": "OKX", "products": {"spot": [
+            {"tier": "Regular", "minVolume": 0,        "maker": 0.0008, "taker": 0.0010},
+            {"tier": "VIP1",    "minVolume": 50000,    "maker": 0.0007, "taker": 0.0009},
+            {"tier": "VIP2",    "minVolume": 100000,   "maker": 0.0006, "taker": 0.0008},
+            {"tier": "VIP3",    "minVolume": 500000,   "maker": 0.0005, "taker": 0.0007},
+            {"tier": "VIP4",    "minVolume": 1000000,  "maker": 0.0004, "taker": 0.0006},
+            {"tier": "VIP5",    "minVolume": 5000000,  "maker": 0.0003, "taker": 0.0005},
+            {"tier": "VIP6",    "minVolume": 10000000, "maker": 0.0002, "taker": 0.0004}
+        ]}}]
+    })")));
+    return schedule;
+}
+
+/**
+ * @brief Looks up an (exchange, product) schedule
+ *
+ * @return FeeScheduleId Schedule ID, or INVALID_FEE_SCHEDULE if absent
+ */
+FeeScheduleId FeeSchedule::find(std::string_view exchange, std::string_view product) const {
+    auto it = m_ids.find(makeKey(exchange, product));
+    return it != m_ids.end() ? it->second : INVALID_FEE_SCHEDULE;
+}
+
+/**
+ * @brief Name of a tier, as in the configuration
+ */
+const std::string& FeeSchedule::tierName(FeeScheduleId schedule, std::uint32_t tier) const {
+    return m_tierNames[tierIndex(schedule, tier)];
+}
+
+/**
+ * @brief Minimum 30-day volume of a tier, in USD
+ */
+double FeeSchedule::minVolume(FeeScheduleId schedule, std::uint32_t tier) const {
+    return m_minVolumes[tierIndex(schedule, tier)];
+}
+
+/**
+ * @brief Returns the fee rate of a tier
+ *
+ * @throws std::out_of_range if the schedule or tier does not exist
+ */
+double FeeSchedule::rate(FeeScheduleId schedule, std::uint32_t tier, bool isMaker) const {
+    return m_rates[2 * tierIndex(schedule, tier) + isMaker];
+}
+
+/**
+ * @brief Finds the highest tier a 30-day volume qualifies for
+ *
+ * Binary search over the schedule's ascending minimum volumes.
+ *
+ * @param schedule Schedule ID
+ * @param volume 30-day trading volume in USD
+ * @return std::uint32_t Tier index; the first tier if no minimum is met
+ * @throws std::out_of_range if the schedule does not exist
+ */
+std::uint32_t FeeSchedule::tierForVolume(FeeScheduleId schedule, double volume) const {
+    const Schedule& entry = m_schedules.at(schedule);
+    auto begin = m_minVolumes.begin() + entry.firstTier;
+    auto end = begin + entry.tierCount;
+    auto above = std::upper_bound(begin, end, volume);
+    return above == begin ? 0 : static_cast<std::uint32_t>(above - begin - 1);
+}
+
+/**
+ * @brief Prices one order
+ *
+ * @throws std::out_of_range if the query names an unknown schedule or tier
+ */
+double FeeSchedule::calculateFee(const FeeQuery& query) const {
+    return query.size * rate(query.schedule, query.tier, query.isMaker);
+}
+
+/**
+ * @brief Prices a batch of orders in one pass
+ *
+ * @param queries Orders to price
+ * @param count Number of orders
+ * @param fees Receives one fee per order
+ * @throws std::out_of_range if a query names an unknown schedule or tier
+ */
+void FeeSchedule::calculateFees(const FeeQuery* queries, std::size_t count, double* fees) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        tierIndex(queries[i].schedule, queries[i].tier);
+    }
+
+    const Schedule* schedules = m_schedules.data();
+    const double* rates = m_rates.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        const FeeQuery& query = queries[i];
+        std::size_t index = 2 * (schedules[query.schedule].firstTier + query.tier) + query.isMaker;
+        fees[i] = query.size * rates[index];
+    }
+}
+
+/**
+ * @brief Prices a batch of orders in one pass
+ *
+ * @param queries Orders to price
+ * @return std::vector<double> One fee per order, in input order
+ * @throws std::out_of_range if a query names an unknown schedule or tier
+ */
+std::vector<double> FeeSchedule::calculateFees(const std::vector<FeeQuery>& queries) const {
+    std::vector<double> fees(queries.size());
+    calculateFees(queries.data(), queries.size(), fees.data());
+    return fees;
+}
+
+/**
+ * @brief Index of a tier in the flat tables, checking both indices
+ *
+ * @throws std::out_of_range if the schedule or tier does not exist
+ */
+std::uint32_t FeeSchedule::tierIndex(FeeScheduleId schedule, std::uint32_t tier) const {
+    if (schedule >= m_schedules.size() || tier >= m_schedules[schedule].tierCount) {
+        throw std::out_of_range("Unknown fee schedule or tier");
+    }
+    return m_schedules[schedule].firstTier + tier;
+}
+
+/**
+ * @brief Lookup key of an (exchange, product) pair
+ */
+std::string FeeSchedule::makeKey(std::string_view exchange, std::string_view product) {
+    std::string key;
+    key.reserve(exchange.size() + product.size() + 1);
+    key.append(exchange);
+    key.push_back('\0');
+    key.append(product);
+    return key;
+}
+
+} // namespace GoQuant
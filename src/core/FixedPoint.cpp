@@ -0,0 +1,216 @@
+/**
+ * @file FixedPoint.cpp
+ * @brief Implementation of the FixedPointScale conversions
+ *
+ * This file contains the exact decimal-to-integer conversion used when order
+ * book levels are parsed into tick and lot units.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/FixedPoint.h"
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+namespace GoQuant {
+
+namespace {
+
+constexpr int MAX_DECIMALS = 12;
+constexpr int MAX_POW10 = 18;
+
+constexpr std::int64_t POW10[MAX_POW10 + 1] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+    100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+    1000000000000LL, 10000000000000LL, 100000000000000LL,
+    1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL
+};
+
+/**
+ * @brief Divides two non-negative integers, rounding half away from zero
+ */
+std::int64_t roundedDivide(std::int64_t numerator, std::int64_t denominator) {
+    std::int64_t quotient = numerator / denominator;
+    std::int64_t remainder = numerator % denominator;
+    return remainder >= denominator - remainder ? quotient + 1 : quotient;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a scale with a 1e-8 increment
+ *
+ * Eight decimal places cover every price and quantity published by the
+ * supported exchanges, so the default scale never loses precision.
+ */
+FixedPointScale::FixedPointScale()
+    : m_increment(1e-8)
+    , m_decimals(8)
+    , m_step(1)
+{
+}
+
+/**
+ * @brief Constructs a scale for the given increment
+ *
+ * Finds the smallest number of decimal places at which the increment is an
+ * integer, so that e.g. 0.1, 0.01 and 0.5 map to exact (step, decimals) pairs.
+ *
+ * @param increment Smallest representable step
+ * @throws std::invalid_argument if the increment is not positive or has more
+ *         than 12 decimal places
+ */
+FixedPointScale::FixedPointScale(double increment)
+    : m_increment(increment)
+    , m_decimals(0)
+    , m_step(0)
+{
+    if (!(increment > 0.0) || !std::isfinite(increment)) {
+        throw std::invalid_argument("Fixed-point increment must be positive");
+    }
+
+    for (int decimals = 0; decimals <= MAX_DECIMALS; ++decimals) {
+        double scaled = increment * static_cast<double>(POW10[decimals]);
+        double rounded = std::round(scaled);
+        if (rounded >= 1.0 && std::abs(scaled - rounded) <= 1e-9 * scaled) {
+            m_decimals = decimals;
+            m_step = static_cast<std::int64_t>(rounded);
+            return;
+        }
+    }
+
+    throw std::invalid_argument("Fixed-point increment has too many decimal places");
+}
+
+/**
+ * @brief Converts a decimal string to integer units, rounding to nearest
+ *
+ * Digits are accumulated into an integer mantissa and rescaled with integer
+ * arithmetic. Inputs with more than 18 significant digits, or whose rescaling
+ * would overflow, fall back to a double conversion.
+ *
+ * @param text Decimal text such as "95445.5", "-0.25" or "1e-3"
+ * @param units Receives the value in integer units
+ * @return bool False if the text is not a valid decimal number
+ */
+bool FixedPointScale::parse(std::string_view text, std::int64_t& units) const {
+    const char* pos = text.data();
+    const char* end = text.data() + text.size();
+
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+')) {
+        negative = (*pos == '-');
+        ++pos;
+    }
+
+    std::int64_t mantissa = 0;
+    int significantDigits = 0;
+    int fractionDigits = 0;
+    bool sawDigit = false;
+    bool sawPoint = false;
+    bool exact = true;
+
+    for (; pos < end; ++pos) {
+        char c = *pos;
+        if (c >= '0' && c <= '9') {
+            sawDigit = true;
+            if (mantissa == 0 && c == '0') {
+                // Leading zeros carry no significance
+            } else if (significantDigits < MAX_POW10) {
+                mantissa = mantissa * 10 + (c - '0');
+                ++significantDigits;
+            } else {
+                exact = false;
+            }
+            if (sawPoint && exact) {
+                ++fractionDigits;
+            }
+        } else if (c == '.' && !sawPoint) {
+            sawPoint = true;
+        } else {
+            break;
+        }
+    }
+    if (!sawDigit) {
+        return false;
+    }
+
+    int exponent = 0;
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+        ++pos;
+        auto result = std::from_chars(pos + (pos < end && *pos == '+'), end, exponent);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        pos = result.ptr;
+    }
+    if (pos != end) {
+        return false;
+    }
+
+    int shift = m_decimals - fractionDigits + exponent;
+    if (exact && shift >= 0 && shift <= MAX_POW10 &&
+        mantissa <= std::numeric_limits<std::int64_t>::max() / POW10[shift]) {
+        units = roundedDivide(mantissa * POW10[shift], m_step);
+    } else if (exact && shift < 0 && -shift <= MAX_POW10 &&
+               m_step <= std::numeric_limits<std::int64_t>::max() / POW10[-shift]) {
+        units = roundedDivide(mantissa, m_step * POW10[-shift]);
+    } else {
+        double value = 0.0;
+        auto result = std::from_chars(text.data() + (text.front() == '+'), end, value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        units = fromDouble(value);
+        return true;
+    }
+
+    if (negative) {
+        units = -units;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes integer units as the shortest exact decimal text
+ *
+ * The value is units * step scaled by 10^-decimals, so it is printed with
+ * integer arithmetic only and round-trips through parse() exactly.
+ *
+ * @param units Value in integer units
+ * @param buffer Destination of at least MAX_FORMAT_LENGTH bytes
+ * @return std::size_t Number of characters written
+ */
+std::size_t FixedPointScale::format(std::int64_t units, char* buffer) const {
+    char* out = buffer;
+    std::uint64_t scaled = static_cast<std::uint64_t>(units < 0 ? -units : units) *
+                           static_cast<std::uint64_t>(m_step);
+    if (units < 0) {
+        *out++ = '-';
+    }
+
+    std::uint64_t divisor = static_cast<std::uint64_t>(POW10[m_decimals]);
+    out = std::to_chars(out, buffer + MAX_FORMAT_LENGTH, scaled / divisor).ptr;
+
+    std::uint64_t fraction = scaled % divisor;
+    if (fraction != 0) {
+        int digits = m_decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            --digits;
+        }
+        *out++ = '.';
+        for (int i = digits - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        out += digits;
+    }
+    return static_cast<std::size_t>(out - buffer);
+}
+
+} // namespace GoQuant
@@ -0,0 +1,118 @@
+/**
+ * @file InstrumentRegistry.cpp
+ * @brief Implementation of the process-wide instrument registry
+ *
+ * This file contains instrument interning and the lock-free resolution of
+ * instrument IDs back to exchange and symbol names.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/InstrumentRegistry.h"
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Returns the process-wide registry
+ */
+InstrumentRegistry& InstrumentRegistry::instance() {
+    static InstrumentRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief Constructs the registry with UNKNOWN_INSTRUMENT as ID 0
+ */
+InstrumentRegistry::InstrumentRegistry() {
+    m_chunks[0].reset(new Entry[CHUNK_SIZE]);
+    m_ids.emplace(makeKey({}, {}), UNKNOWN_INSTRUMENT);
+    m_size.store(1, std::memory_order_release);
+}
+
+/**
+ * @brief Returns the ID of an instrument, registering it if needed
+ *
+ * A new entry is fully written before the size is published with release
+ * ordering, so lock-free readers never observe a partially built entry.
+ *
+ * @param exchange Exchange name
+ * @param symbol Instrument symbol
+ * @return InstrumentId ID of the pair
+ * @throws std::length_error if MAX_INSTRUMENTS would be exceeded
+ */
+InstrumentId InstrumentRegistry::intern(std::string_view exchange, std::string_view symbol) {
+    std::string key = makeKey(exchange, symbol);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_ids.find(key);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    std::size_t id = m_size.load(std::memory_order_relaxed);
+    if (id >= MAX_INSTRUMENTS) {
+        throw std::length_error("Instrument registry is full");
+    }
+    std::unique_ptr<Entry[]>& chunk = m_chunks[id / CHUNK_SIZE];
+    if (!chunk) {
+        chunk.reset(new Entry[CHUNK_SIZE]);
+    }
+    Entry& entry = chunk[id % CHUNK_SIZE];
+    entry.exchange.assign(exchange);
+    entry.symbol.assign(symbol);
+
+    m_ids.emplace(std::move(key), static_cast<InstrumentId>(id));
+    m_size.store(id + 1, std::memory_order_release);
+    return static_cast<InstrumentId>(id);
+}
+
+/**
+ * @brief Looks up an instrument without registering it
+ *
+ * @return InstrumentId ID of the pair, or UNKNOWN_INSTRUMENT if not registered
+ */
+InstrumentId InstrumentRegistry::find(std::string_view exchange, std::string_view symbol) const {
+    std::string key = makeKey(exchange, symbol);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_ids.find(key);
+    return it != m_ids.end() ? it->second : UNKNOWN_INSTRUMENT;
+}
+
+/**
+ * @brief Tests whether @p id names the given pair; lock-free
+ *
+ * Used by parsers to validate a cached ID against the names in a frame
+ * without going through the interning map.
+ */
+bool InstrumentRegistry::matches(InstrumentId id, std::string_view exchange,
+                                 std::string_view symbol) const {
+    const Entry& named = entry(id);
+    return named.symbol == symbol && named.exchange == exchange;
+}
+
+/**
+ * @brief Resolves an ID to its entry; unknown IDs resolve to UNKNOWN_INSTRUMENT
+ */
+const InstrumentRegistry::Entry& InstrumentRegistry::entry(InstrumentId id) const {
+    if (id >= m_size.load(std::memory_order_acquire)) {
+        id = UNKNOWN_INSTRUMENT;
+    }
+    return m_chunks[id / CHUNK_SIZE][id % CHUNK_SIZE];
+}
+
+/**
+ * @brief Builds the interning key; the separator cannot appear in either name
+ */
+std::string InstrumentRegistry::makeKey(std::string_view exchange, std::string_view symbol) {
+    std::string key;
+    key.reserve(exchange.size() + symbol.size() + 1);
+    key.append(exchange);
+    key.push_back('\0');
+    key.append(symbol);
+    return key;
+}
+
+} // namespace GoQuant
@@ -0,0 +1,145 @@
+/**
+ * @file JournalReader.cpp
+ * @brief Implementation of the memory-mapped JournalReader
+ *
+ * This file contains the header validation, record iteration and
+ * instrument resolution of journal files.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/JournalReader.h"
+#include <QDir>
+#include <QFileInfo>
+#include <cstring>
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Opens and maps a journal file
+ *
+ * @param path Journal file written by CaptureJournal
+ * @throws std::runtime_error if the file cannot be mapped or is not a journal
+ */
+JournalReader::JournalReader(const QString& path)
+    : m_file(path)
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Cannot open journal " + path.toStdString() + ": " +
+                                 m_file.errorString().toStdString());
+    }
+    m_size = m_file.size();
+    if (m_size < static_cast<int64_t>(sizeof(Journal::FileHeader)) ||
+        !(m_data = m_file.map(0, m_size))) {
+        throw std::runtime_error("Cannot map journal " + path.toStdString());
+    }
+
+    Journal::FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if (std::memcmp(header.magic, Journal::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != Journal::FORMAT_VERSION ||
+        header.headerSize < sizeof(header) || header.headerSize > m_size) {
+        throw std::runtime_error("Not a capture journal: " + path.toStdString());
+    }
+    m_createdTimeNs = header.createdTimeNs;
+    m_dataStart = header.headerSize;
+    m_position = m_dataStart;
+}
+
+/**
+ * @brief Unmaps and closes the file
+ */
+JournalReader::~JournalReader() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+}
+
+/**
+ * @brief Reads the next frame
+ *
+ * Instrument records are consumed on the way and records of unknown types
+ * are skipped, so files from a newer writer still replay their frames.
+ *
+ * @param frame Receives the frame
+ * @return bool False at the end of the data
+ */
+bool JournalReader::next(JournalFrame& frame) {
+    while (m_position + static_cast<int64_t>(sizeof(Journal::RecordHeader)) <= m_size) {
+        Journal::RecordHeader header;
+        std::memcpy(&header, m_data + m_position, sizeof(header));
+        if (header.type == 0 ||
+            m_position + static_cast<int64_t>(sizeof(header)) + header.length > m_size) {
+            break;
+        }
+
+        std::string_view payload(reinterpret_cast<const char*>(m_data + m_position + sizeof(header)),
+                                 header.length);
+        m_position += static_cast<int64_t>(Journal::recordSize(header.length));
+
+        if (header.type == Journal::FrameRecord) {
+            auto it = m_instruments.find(header.instrument);
+            frame.bytes = payload;
+            frame.receiveTimeNs = header.receiveTimeNs;
+            frame.instrument = it != m_instruments.end() ? it->second : UNKNOWN_INSTRUMENT;
+            return true;
+        }
+        if (header.type == Journal::InstrumentRecord) {
+            size_t separator = payload.find('\0');
+            if (separator != std::string_view::npos) {
+                m_instruments[header.instrument] = InstrumentRegistry::instance().intern(
+                    payload.substr(0, separator), payload.substr(separator + 1));
+            }
+        }
+    }
+    m_position = m_size;
+    return false;
+}
+
+/**
+ * @brief Returns to the first record
+ */
+void JournalReader::rewind() {
+    m_position = m_dataStart;
+}
+
+/**
+ * @brief Moves to a record position returned earlier by position()
+ *
+ * Frames are skipped without touching their payload, so the cost is one
+ * header read per record before @p position.
+ *
+ * @param position Value of position() from a reader of the same file
+ */
+void JournalReader::seek(int64_t position) {
+    rewind();
+    JournalFrame frame;
+    while (m_position < position && next(frame)) {
+    }
+}
+
+/**
+ * @brief Lists the journal files at a path in the order they were written
+ *
+ * CaptureJournal names files by creation time and sequence number, so
+ * name order is write order.
+ *
+ * @param path A journal file, or a directory of them
+ * @return QStringList The file itself, or the directory's .gqj files sorted by name
+ */
+QStringList JournalReader::listFiles(const QString& path) {
+    if (!QFileInfo(path).isDir()) {
+        return QStringList{path};
+    }
+    QDir directory(path);
+    QStringList files;
+    for (const QString& name : directory.entryList(QStringList{"*.gqj"}, QDir::Files, QDir::Name)) {
+        files.append(directory.filePath(name));
+    }
+    return files;
+}
+
+} // namespace GoQuant
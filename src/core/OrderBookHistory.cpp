@@ -0,0 +1,306 @@
+/**
+ * @file OrderBookHistory.cpp
+ * @brief Implementation of the delta-compressed OrderBookHistory ring
+ *
+ * This file contains the keyframe/delta encoding of order book history and
+ * the reconstruction of past books from it.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/OrderBookHistory.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Constructs a history retaining at least @p capacity entries
+ *
+ * One segment more than strictly needed is allocated so that dropping the
+ * oldest segment never takes the history below @p capacity entries.
+ *
+ * @param capacity Minimum number of books retained once the ring is full
+ * @param keyframeInterval Maximum number of entries per keyframe segment
+ * @throws std::invalid_argument if either argument is zero
+ */
+OrderBookHistory::OrderBookHistory(std::size_t capacity, std::size_t keyframeInterval)
+    : m_keyframeInterval(keyframeInterval)
+{
+    if (capacity == 0 || keyframeInterval == 0) {
+        throw std::invalid_argument("History capacity and keyframe interval must be positive");
+    }
+
+    m_segments.resize((capacity + keyframeInterval - 1) / keyframeInterval + 1);
+    for (auto& segment : m_segments) {
+        segment.entries.reserve(keyframeInterval);
+    }
+}
+
+/**
+ * @brief Appends a book to the history
+ *
+ * @param book Book to record; asks ascending, bids descending
+ */
+void OrderBookHistory::push(const OrderBook& book) {
+    bool needsKeyframe = (m_liveSegments == 0);
+    if (!needsKeyframe) {
+        const Segment& current = segmentAt(m_liveSegments - 1);
+        needsKeyframe = current.entries.size() >= m_keyframeInterval ||
+                        book.instrument != current.keyframe.instrument ||
+                        book.spec != current.keyframe.spec;
+    }
+
+    if (needsKeyframe) {
+        startSegment(book);
+    } else {
+        Segment& segment = segmentAt(m_liveSegments - 1);
+        Entry entry{};
+        entry.deltaBegin = static_cast<std::uint32_t>(segment.deltas.size());
+        appendSideDiff(m_previous.asks, book.asks, true, segment.deltas);
+        entry.askDeltas = static_cast<std::uint32_t>(segment.deltas.size() - entry.deltaBegin);
+        appendSideDiff(m_previous.bids, book.bids, false, segment.deltas);
+        entry.bidDeltas = static_cast<std::uint32_t>(segment.deltas.size() - entry.deltaBegin -
+                                                     entry.askDeltas);
+        entry.exchangeTimeNs = book.exchangeTimeNs;
+        entry.receiveTimeNs = book.receiveTimeNs;
+        segment.entries.push_back(entry);
+        ++m_size;
+    }
+
+    ++m_nextSequence;
+    m_previous.asks.assign(book.asks.begin(), book.asks.end());
+    m_previous.bids.assign(book.bids.begin(), book.bids.end());
+}
+
+/**
+ * @brief Starts a new segment with @p book as its keyframe
+ *
+ * Evicts the oldest segment first if every segment of the ring is live.
+ */
+void OrderBookHistory::startSegment(const OrderBook& book) {
+    if (m_liveSegments == m_segments.size()) {
+        m_size -= segmentAt(0).entries.size();
+        m_firstSegment = (m_firstSegment + 1) % m_segments.size();
+        --m_liveSegments;
+    }
+
+    Segment& segment = segmentAt(m_liveSegments);
+    ++m_liveSegments;
+
+    segment.firstSequence = m_nextSequence;
+    segment.keyframe.asks.assign(book.asks.begin(), book.asks.end());
+    segment.keyframe.bids.assign(book.bids.begin(), book.bids.end());
+    segment.keyframe.instrument = book.instrument;
+    segment.keyframe.exchangeTimeNs = book.exchangeTimeNs;
+    segment.keyframe.receiveTimeNs = book.receiveTimeNs;
+    segment.keyframe.spec = book.spec;
+    segment.deltas.clear();
+    segment.entries.clear();
+    segment.entries.push_back({0, 0, 0, book.exchangeTimeNs, book.receiveTimeNs});
+    ++m_size;
+}
+
+/**
+ * @brief Rebuilds a retained book
+ *
+ * @param index Position in the history, 0 being the oldest retained book
+ * @return OrderBook Reconstructed book
+ * @throws std::out_of_range if @p index >= size()
+ */
+OrderBook OrderBookHistory::at(std::size_t index) const {
+    OrderBook book;
+    reconstruct(index, book);
+    return book;
+}
+
+/**
+ * @brief Rebuilds a retained book into existing storage
+ *
+ * @param index Position in the history, 0 being the oldest retained book
+ * @param out Destination book; its capacity is reused
+ * @throws std::out_of_range if @p index >= size()
+ */
+void OrderBookHistory::reconstruct(std::size_t index, OrderBook& out) const {
+    if (index >= m_size) {
+        throw std::out_of_range("Order book history index out of range");
+    }
+
+    std::uint64_t sequence = segmentAt(0).firstSequence + index;
+    const Segment& segment = segmentAt(findSegment(sequence));
+    std::size_t offset = static_cast<std::size_t>(sequence - segment.firstSequence);
+
+    out.asks.assign(segment.keyframe.asks.begin(), segment.keyframe.asks.end());
+    out.bids.assign(segment.keyframe.bids.begin(), segment.keyframe.bids.end());
+    out.instrument = segment.keyframe.instrument;
+    out.spec = segment.keyframe.spec;
+    for (std::size_t i = 0; i <= offset; ++i) {
+        applyEntry(segment, segment.entries[i], out);
+    }
+}
+
+/**
+ * @brief Copies the segments holding positions [@p first, @p last)
+ *
+ * @param first Position of the first book wanted
+ * @param last Position one past the last book wanted
+ * @param[out] offset Position of book @p first in the copy
+ * @return OrderBookHistory Copy of the covering segments
+ */
+OrderBookHistory OrderBookHistory::copyRange(std::size_t first, std::size_t last,
+                                             std::size_t& offset) const {
+    OrderBookHistory window;
+    window.m_keyframeInterval = m_keyframeInterval;
+    offset = 0;
+    last = std::min(last, m_size);
+    if (first >= last) {
+        return window;
+    }
+
+    std::uint64_t base = segmentAt(0).firstSequence;
+    std::size_t begin = findSegment(base + first);
+    std::size_t end = findSegment(base + last - 1) + 1;
+    window.m_segments.reserve(end - begin);
+    for (std::size_t ordinal = begin; ordinal < end; ++ordinal) {
+        window.m_segments.push_back(segmentAt(ordinal));
+        window.m_size += window.m_segments.back().entries.size();
+    }
+    window.m_liveSegments = window.m_segments.size();
+    window.m_nextSequence = window.m_segments.back().firstSequence +
+                            window.m_segments.back().entries.size();
+    offset = static_cast<std::size_t>(base + first - window.m_segments.front().firstSequence);
+    return window;
+}
+
+/**
+ * @brief Removes all entries, keeping the allocated storage
+ */
+void OrderBookHistory::clear() {
+    m_firstSegment = 0;
+    m_liveSegments = 0;
+    m_size = 0;
+    m_nextSequence = 0;
+    m_previous.asks.clear();
+    m_previous.bids.clear();
+}
+
+/**
+ * @brief Approximate heap memory held by the history, in bytes
+ */
+std::size_t OrderBookHistory::memoryUsage() const {
+    std::size_t bytes = m_segments.capacity() * sizeof(Segment);
+    for (const auto& segment : m_segments) {
+        bytes += (segment.keyframe.asks.capacity() + segment.keyframe.bids.capacity() +
+                  segment.deltas.capacity()) * sizeof(OrderBookLevel);
+        bytes += segment.entries.capacity() * sizeof(Entry);
+    }
+    bytes += (m_previous.asks.capacity() + m_previous.bids.capacity()) * sizeof(OrderBookLevel);
+    return bytes;
+}
+
+/**
+ * @brief Finds the first retained book at or after an exchange time
+ *
+ * @param exchangeTimeNs Exchange time in nanoseconds since the epoch
+ * @return std::size_t Position of the book, or size() if all are earlier
+ */
+std::size_t OrderBookHistory::lowerBound(std::int64_t exchangeTimeNs) const {
+    if (m_liveSegments == 0) {
+        return 0;
+    }
+
+    // Last segment whose keyframe is earlier than the requested time
+    std::size_t low = 0;
+    std::size_t high = m_liveSegments;
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        if (segmentAt(middle).entries.front().exchangeTimeNs < exchangeTimeNs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == 0) {
+        return 0;
+    }
+
+    const Segment& segment = segmentAt(low - 1);
+    auto it = std::lower_bound(segment.entries.begin(), segment.entries.end(), exchangeTimeNs,
+        [](const Entry& entry, std::int64_t time) { return entry.exchangeTimeNs < time; });
+    std::uint64_t sequence = segment.firstSequence +
+                             static_cast<std::uint64_t>(it - segment.entries.begin());
+    return static_cast<std::size_t>(sequence - segmentAt(0).firstSequence);
+}
+
+/**
+ * @brief Finds the live segment holding @p sequence
+ *
+ * Segments are ordered by first sequence number, so a binary search over
+ * their ring ordinals is sufficient.
+ *
+ * @return std::size_t Ordinal of the segment, 0 being the oldest
+ */
+std::size_t OrderBookHistory::findSegment(std::uint64_t sequence) const {
+    std::size_t low = 0;
+    std::size_t high = m_liveSegments;
+    while (high - low > 1) {
+        std::size_t middle = low + (high - low) / 2;
+        if (segmentAt(middle).firstSequence <= sequence) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Appends the level changes from @p previous to @p current
+ *
+ * Both sides are walked in book order in a single merge pass. A level that
+ * is new or whose quantity changed is emitted with its new quantity; a level
+ * that disappeared is emitted with a zero quantity.
+ */
+void OrderBookHistory::appendSideDiff(const std::vector<OrderBookLevel>& previous,
+                                      const std::vector<OrderBookLevel>& current, bool isAsk,
+                                      std::vector<OrderBookLevel>& deltas) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < previous.size() || j < current.size()) {
+        if (j == current.size()) {
+            deltas.push_back({previous[i++].priceTicks, 0});
+        } else if (i == previous.size()) {
+            deltas.push_back(current[j++]);
+        } else if (previous[i].priceTicks == current[j].priceTicks) {
+            if (previous[i].quantityLots != current[j].quantityLots) {
+                deltas.push_back(current[j]);
+            }
+            ++i;
+            ++j;
+        } else if (isAsk ? previous[i].priceTicks < current[j].priceTicks
+                         : previous[i].priceTicks > current[j].priceTicks) {
+            deltas.push_back({previous[i++].priceTicks, 0});
+        } else {
+            deltas.push_back(current[j++]);
+        }
+    }
+}
+
+/**
+ * @brief Applies one entry's deltas and timestamp to @p book
+ */
+void OrderBookHistory::applyEntry(const Segment& segment, const Entry& entry, OrderBook& book) {
+    const OrderBookLevel* delta = segment.deltas.data() + entry.deltaBegin;
+    for (std::uint32_t i = 0; i < entry.askDeltas; ++i) {
+        applyLevelDelta(book.asks, *delta++, true);
+    }
+    for (std::uint32_t i = 0; i < entry.bidDeltas; ++i) {
+        applyLevelDelta(book.bids, *delta++, false);
+    }
+    book.exchangeTimeNs = entry.exchangeTimeNs;
+    book.receiveTimeNs = entry.receiveTimeNs;
+}
+
+} // namespace GoQuant
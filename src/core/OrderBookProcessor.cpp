@@ -12,132 +12,488 @@
  */
 
 #include "core/OrderBookProcessor.h"
+#include "core/BookChecksum.h"
+#include "core/InstrumentRegistry.h"
+#include "core/Timestamp.h"
 #include "models/RegressionModels.h"
+#include <QThread>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
 
 namespace GoQuant {
 
+namespace {
+
+/**
+ * @brief Converts a JSON price or quantity string to fixed-point units
+ * 
+ * @throws std::invalid_argument if the value is not a decimal string
+ */
+std::int64_t parseFixed(const nlohmann::json& value, const FixedPointScale& scale) {
+    std::int64_t units = 0;
+    if (!scale.parse(value.get_ref<const std::string&>(), units)) {
+        throw std::invalid_argument("Invalid decimal value: " + value.dump());
+    }
+    return units;
+}
+
+} // namespace
+
 /**
  * @brief Constructs a new OrderBookProcessor instance
  * 
- * Initializes the order book processor with a pre-allocated history buffer
- * to store historical order book snapshots for analysis.
+ * Initializes the order book processor with level storage reserved for a
+ * full-depth book, so that snapshots and deltas apply without reallocating.
  * 
  * @param parent Parent QObject for Qt signal/slot system
  */
 OrderBookProcessor::OrderBookProcessor(QObject *parent)
     : QObject(parent)
+    , m_publisher(BookPublisher::DEFAULT_SLOTS, RESERVED_DEPTH)
+    , m_orderBookHistory(HISTORY_CAPACITY)
+    , m_makerTakerWindow(HISTORY_SIZE - 1)
 {
-    m_orderBookHistory.reserve(HISTORY_SIZE);
+    for (OrderBook* book : {&m_currentOrderBook, &m_parseBuffer}) {
+        book->asks.reserve(RESERVED_DEPTH);
+        book->bids.reserve(RESERVED_DEPTH);
+    }
+    m_previousAsks.reserve(RESERVED_DEPTH);
+    m_previousBids.reserve(RESERVED_DEPTH);
+
+    // Readers always find a version, empty until the first message
+    m_publisher.publish(m_currentOrderBook, m_version, 0.5);
 }
 
-OrderBookProcessor::~OrderBookProcessor() = default;
+/**
+ * @brief Deletes the remaining analytics subscriptions
+ * 
+ * A subscription still living on this thread is deleted at once. One moved
+ * to a consumer's thread is deleted there, so that a delivery running on
+ * it is never cut short.
+ */
+OrderBookProcessor::~OrderBookProcessor() {
+    std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+    for (AnalyticsSubscription* subscription : m_subscriptions) {
+        if (subscription->thread() == QThread::currentThread()) {
+            delete subscription;
+        } else {
+            subscription->deleteLater();
+        }
+    }
+    m_subscriptions.clear();
+}
 
 /**
  * @brief Processes incoming order book data
  * 
  * Parses and validates incoming order book data in JSON format, updates the current
- * order book state, and emits signals for various market metrics.
+ * order book state, and notifies analytics subscribers. Messages with
+ * "action": "update" are applied as deltas; all others replace the book.
  * 
  * @param data JSON object containing order book data
  * @throws std::runtime_error if data parsing fails
  */
 void OrderBookProcessor::processOrderBook(const nlohmann::json& data) {
     try {
-        OrderBook newOrderBook;
-        newOrderBook.timestamp = data["timestamp"].get<std::string>();
-        newOrderBook.exchange = data["exchange"].get<std::string>();
-        newOrderBook.symbol = data["symbol"].get<std::string>();
+        OrderBook& newOrderBook = m_parseBuffer;
+        newOrderBook.spec = m_instrumentSpec;
+        if (!parseTimestamp(data["timestamp"].get_ref<const std::string&>(),
+                            newOrderBook.exchangeTimeNs)) {
+            throw std::invalid_argument("Invalid timestamp: " + data["timestamp"].dump());
+        }
+        newOrderBook.receiveTimeNs = wallClockNanoseconds();
+        newOrderBook.instrument = InstrumentRegistry::instance().intern(
+            data["exchange"].get_ref<const std::string&>(),
+            data["symbol"].get_ref<const std::string&>());
 
         // Process asks
         const auto& asks = data["asks"];
+        newOrderBook.asks.clear();
         newOrderBook.asks.reserve(asks.size());
         for (const auto& ask : asks) {
             OrderBookLevel level;
-            level.price = std::stod(ask[0].get<std::string>());
-            level.quantity = std::stod(ask[1].get<std::string>());
+            level.priceTicks = parseFixed(ask[0], m_instrumentSpec.price);
+            level.quantityLots = parseFixed(ask[1], m_instrumentSpec.quantity);
             newOrderBook.asks.push_back(level);
         }
 
         // Process bids
         const auto& bids = data["bids"];
+        newOrderBook.bids.clear();
         newOrderBook.bids.reserve(bids.size());
         for (const auto& bid : bids) {
             OrderBookLevel level;
-            level.price = std::stod(bid[0].get<std::string>());
-            level.quantity = std::stod(bid[1].get<std::string>());
+            level.priceTicks = parseFixed(bid[0], m_instrumentSpec.price);
+            level.quantityLots = parseFixed(bid[1], m_instrumentSpec.quantity);
             newOrderBook.bids.push_back(level);
         }
 
-        // Update order book
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_currentOrderBook = std::move(newOrderBook);
-            m_orderBookHistory.push_back(m_currentOrderBook);
-            maintainHistory();
-        }
+        BookAction action = data.value("action", std::string()) == "update"
+                                ? BookAction::Update : BookAction::Snapshot;
+        commitOrderBook(action);
 
-        // Emit signals
-        emit orderBookUpdated(m_currentOrderBook);
-        emit marketImpactUpdated(calculateMarketImpact(100.0, true));
-        emit slippageUpdated(calculateSlippage(100.0, true));
-        emit makerTakerProportionUpdated(calculateMakerTakerProportion());
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Error processing order book: " + std::string(e.what()));
+    }
+}
 
+/**
+ * @brief Processes a raw order book frame without building a JSON DOM
+ * 
+ * Parses the frame with OrderBookParser straight into the reusable parse
+ * buffer, so steady-state updates do not allocate per level.
+ * 
+ * @param frame Raw UTF-8 frame as received from the exchange
+ * @param receiveTimeNs Local receive time in nanoseconds since the epoch;
+ *                      0 stamps the frame with the current wall clock
+ * @throws std::runtime_error if the frame is malformed
+ */
+void OrderBookProcessor::processRawMessage(std::string_view frame, int64_t receiveTimeNs) {
+    try {
+        processFrame(frame, receiveTimeNs != 0 ? receiveTimeNs : wallClockNanoseconds());
     } catch (const std::exception& e) {
         throw std::runtime_error("Error processing order book: " + std::string(e.what()));
     }
 }
 
+/**
+ * @brief Parses a frame, checks its sequence and applies or buffers it
+ * 
+ * An update is applied only if its prevSeqId continues the book's last
+ * seqId. Updates that are entirely older than the book, such as those
+ * buffered before a resync snapshot, are skipped. Frames without sequence
+ * numbers are always applied. Frames that carry no book, such as
+ * subscription acks and error events, are ignored before any sequencing.
+ * 
+ * @param frame Raw UTF-8 frame
+ * @param receiveTimeNs Local receive time in nanoseconds since the epoch
+ */
+void OrderBookProcessor::processFrame(std::string_view frame, int64_t receiveTimeNs) {
+    int64_t stageStart = m_stageLatency ? steadyNanoseconds() : 0;
+    BookAction action = m_parser.parse(frame, m_instrumentSpec, m_parseBuffer, &m_frameSequence);
+    endStage(&ProcessingStageLatency::parse, stageStart);
+    if (action == BookAction::None) {
+        return;
+    }
+    m_parseBuffer.receiveTimeNs = receiveTimeNs;
+    const FrameSequence& sequence = m_frameSequence;
+
+    bool sequenced = sequence.prevSeqId >= 0 && m_lastSeqId >= 0;
+    if (action == BookAction::Update) {
+        if (m_awaitingSnapshot.load(std::memory_order_relaxed)) {
+            bufferFrame(frame, receiveTimeNs);
+            return;
+        }
+        if (sequenced && sequence.prevSeqId < m_lastSeqId && sequence.seqId <= m_lastSeqId) {
+            return;
+        }
+        if (sequenced && sequence.prevSeqId != m_lastSeqId) {
+            m_sequenceGaps.fetch_add(1, std::memory_order_relaxed);
+            beginResync();
+            bufferFrame(frame, receiveTimeNs);
+            return;
+        }
+    }
+
+    bool resynced = action == BookAction::Snapshot &&
+                    m_awaitingSnapshot.load(std::memory_order_relaxed);
+    if (!commitOrderBook(action, &sequence)) {
+        m_checksumMismatches.fetch_add(1, std::memory_order_relaxed);
+        m_lastSeqId = -1;
+        if (resynced) {
+            // The resync snapshot itself was bad; ask again
+            emit resyncRequested();
+        } else {
+            beginResync();
+        }
+        return;
+    }
+    m_lastSeqId = sequence.seqId;
+
+    if (resynced) {
+        completeResync();
+    }
+}
+
+/**
+ * @brief Publishes the book held in m_parseBuffer and notifies due subscribers
+ * 
+ * A snapshot is swapped with the current book so that both keep their level
+ * capacity for the next message. An update is applied level by level to the
+ * persistent current book. The result is then published as a new immutable
+ * version; the mutex only guards the history append.
+ * 
+ * If the frame carries a checksum, it is verified before anything is
+ * published, so readers keep the last good version when it fails.
+ * 
+ * @param action Whether m_parseBuffer holds a snapshot or level deltas
+ * @param sequence Sequencing fields of the frame, or nullptr if it has none
+ * @return bool False if the updated book failed the frame's checksum
+ */
+bool OrderBookProcessor::commitOrderBook(BookAction action, const FrameSequence* sequence) {
+    int64_t stageStart = m_stageLatency ? steadyNanoseconds() : 0;
+
+    // Update order book
+    if (action == BookAction::Snapshot) {
+        std::swap(m_currentOrderBook, m_parseBuffer);
+    } else {
+        applyDeltas(m_parseBuffer);
+    }
+    bool valid = !(sequence && sequence->hasChecksum &&
+                   bookChecksum(m_currentOrderBook) != sequence->checksum);
+    stageStart = endStage(&ProcessingStageLatency::apply, stageStart);
+    if (!valid) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_orderBookHistory.push(m_currentOrderBook);
+    }
+    updateMakerTakerCounters();
+    stageStart = endStage(&ProcessingStageLatency::record, stageStart);
+
+    double makerTakerProportion =
+        m_changeCount > 0 ? static_cast<double>(m_makerCount) / m_changeCount : 0.5;
+    m_publisher.publish(m_currentOrderBook, ++m_version, makerTakerProportion);
+
+    publishAnalytics();
+    endStage(&ProcessingStageLatency::publish, stageStart);
+    return true;
+}
+
+/**
+ * @brief Stops applying updates and asks for a fresh snapshot
+ * 
+ * A gap detected while a resync is already pending does not start a new
+ * one; the snapshot that is on its way repairs both.
+ */
+void OrderBookProcessor::beginResync() {
+    if (m_awaitingSnapshot.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    m_resyncStartNs = steadyNanoseconds();
+    emit resyncRequested();
+}
+
+/**
+ * @brief Records the resync time and replays the updates that follow the snapshot
+ * 
+ * Buffered updates older than the snapshot are skipped by processFrame().
+ * If the replay hits another gap, the remaining updates are buffered again
+ * for the next snapshot. Buffered frames that fail to parse are dropped.
+ */
+void OrderBookProcessor::completeResync() {
+    int64_t elapsed = steadyNanoseconds() - m_resyncStartNs;
+    m_awaitingSnapshot.store(false, std::memory_order_relaxed);
+    m_resyncs.fetch_add(1, std::memory_order_relaxed);
+    m_lastResyncNs.store(elapsed, std::memory_order_relaxed);
+    m_totalResyncNs.fetch_add(elapsed, std::memory_order_relaxed);
+    if (elapsed > m_maxResyncNs.load(std::memory_order_relaxed)) {
+        m_maxResyncNs.store(elapsed, std::memory_order_relaxed);
+    }
+
+    std::deque<BufferedFrame> pending;
+    std::swap(pending, m_resyncBuffer);
+    m_bufferedFrames.store(0, std::memory_order_relaxed);
+    for (const BufferedFrame& buffered : pending) {
+        try {
+            processFrame(buffered.frame, buffered.receiveTimeNs);
+        } catch (const std::exception&) {
+            m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Holds an update for replay once the snapshot arrives
+ * 
+ * The buffer is bounded; when it is full the oldest update is dropped,
+ * being the one most likely to predate the snapshot.
+ * 
+ * @param frame Raw UTF-8 frame
+ * @param receiveTimeNs Local receive time in nanoseconds since the epoch
+ */
+void OrderBookProcessor::bufferFrame(std::string_view frame, int64_t receiveTimeNs) {
+    if (m_resyncBuffer.size() == MAX_RESYNC_BUFFER) {
+        m_resyncBuffer.pop_front();
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_resyncBuffer.push_back({std::string(frame), receiveTimeNs});
+    m_bufferedFrames.store(m_resyncBuffer.size(), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records the time since @p start in a stage histogram if stage timing is on
+ * 
+ * @param stage Histogram of the stage that just ended
+ * @param start Steady-clock time the stage began
+ * @return int64_t Current steady-clock time; 0 if timing is off
+ */
+int64_t OrderBookProcessor::endStage(LatencyHistogram ProcessingStageLatency::*stage, int64_t start) {
+    if (!m_stageLatency) {
+        return 0;
+    }
+    int64_t now = steadyNanoseconds();
+    (m_stageLatency->*stage).record(now - start);
+    return now;
+}
+
+/**
+ * @brief Computes analytics for the latest version and emits them to due subscribers
+ * 
+ * Nothing is computed when no subscription is due. Otherwise impact and
+ * slippage come from a single sweep of the latest published version, and
+ * the same BookAnalytics value is emitted to every due subscription.
+ */
+void OrderBookProcessor::publishAnalytics() {
+    int64_t now = steadyNanoseconds();
+
+    std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+
+    BookAnalytics analytics;
+    bool computed = false;
+    for (AnalyticsSubscription* subscription : m_subscriptions) {
+        if (now - subscription->m_lastEmitNs < subscription->m_minIntervalNs) {
+            continue;
+        }
+
+        if (!computed) {
+            analytics.snapshot = m_publisher.acquire();
+            const BookVersion& version = *analytics.snapshot;
+            double quantityLots = static_cast<double>(
+                version.book().spec.quantity.fromDouble(ANALYTICS_QUANTITY));
+            ImpactEstimate estimate = makeEstimate(version, ANALYTICS_QUANTITY, quantityLots, true,
+                                                   version.sweep(true, quantityLots));
+            analytics.version = version.version();
+            analytics.quantity = ANALYTICS_QUANTITY;
+            analytics.marketImpact = estimate.impact;
+            analytics.slippage = estimate.slippage;
+            analytics.makerTakerProportion = version.makerTakerProportion();
+            computed = true;
+        }
+
+        subscription->m_lastEmitNs = now;
+        subscription->offer(analytics, now);
+    }
+}
+
+/**
+ * @brief Applies a parsed delta message to the current book
+ * 
+ * Each level costs one binary search; asks are kept ascending and bids
+ * descending, matching the order of exchange snapshots.
+ * 
+ * @param deltas Parsed update whose levels carry new total quantities
+ */
+void OrderBookProcessor::applyDeltas(const OrderBook& deltas) {
+    for (const auto& level : deltas.asks) {
+        applyLevelDelta(m_currentOrderBook.asks, level, true);
+    }
+    for (const auto& level : deltas.bids) {
+        applyLevelDelta(m_currentOrderBook.bids, level, false);
+    }
+
+    if (deltas.instrument != UNKNOWN_INSTRUMENT) {
+        m_currentOrderBook.instrument = deltas.instrument;
+    }
+    if (deltas.exchangeTimeNs != 0) {
+        m_currentOrderBook.exchangeTimeNs = deltas.exchangeTimeNs;
+    }
+    m_currentOrderBook.receiveTimeNs = deltas.receiveTimeNs;
+}
+
+/**
+ * @brief Sets the tick and lot scales used for incoming levels
+ * 
+ * Not synchronised: the spec is read by every frame on the ingest thread.
+ * 
+ * @param spec Fixed-point scales of the instrument
+ */
+void OrderBookProcessor::setInstrumentSpec(const InstrumentSpec& spec) {
+    m_instrumentSpec = spec;
+}
+
+/**
+ * @brief Starts or stops timing the stages of raw frame processing
+ * 
+ * @param latency Histograms to record into, or nullptr to stop timing
+ */
+void OrderBookProcessor::setStageLatency(ProcessingStageLatency* latency) {
+    m_stageLatency = latency;
+}
+
 /**
  * @brief Retrieves the most recent order book snapshot
  * 
  * @return OrderBook Current order book state
  */
 OrderBook OrderBookProcessor::getLatestOrderBook() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_currentOrderBook;
+    return m_publisher.acquire().book();
+}
+
+/**
+ * @brief Returns a zero-copy handle on the latest published book version
+ * 
+ * @return BookSnapshot Handle tagged with the version number
+ */
+BookSnapshot OrderBookProcessor::acquireSnapshot() const {
+    return m_publisher.acquire();
+}
+
+/**
+ * @brief Number of book versions that could not be published because
+ *        readers held every spare slot
+ */
+uint64_t OrderBookProcessor::getSkippedPublications() const {
+    return m_publisher.skippedPublications();
+}
+
+/**
+ * @brief Returns sequence gap, checksum and resync counters
+ * 
+ * @return SyncStats Current counters
+ */
+SyncStats OrderBookProcessor::getSyncStats() const {
+    SyncStats stats{};
+    stats.synced = !m_awaitingSnapshot.load(std::memory_order_relaxed);
+    stats.sequenceGaps = m_sequenceGaps.load(std::memory_order_relaxed);
+    stats.checksumMismatches = m_checksumMismatches.load(std::memory_order_relaxed);
+    stats.resyncs = m_resyncs.load(std::memory_order_relaxed);
+    stats.lastResyncNs = m_lastResyncNs.load(std::memory_order_relaxed);
+    stats.maxResyncNs = m_maxResyncNs.load(std::memory_order_relaxed);
+    if (stats.resyncs > 0) {
+        stats.meanResyncNs =
+            static_cast<double>(m_totalResyncNs.load(std::memory_order_relaxed)) / stats.resyncs;
+    }
+    stats.bufferedFrames = m_bufferedFrames.load(std::memory_order_relaxed);
+    stats.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+    return stats;
 }
 
 /**
  * @brief Calculates market impact for a given order size
  * 
  * Estimates the price impact of executing an order of specified size by
- * calculating the weighted average price across multiple price levels.
+ * calculating the weighted average price across multiple price levels. The
+ * sweep runs on the structure-of-arrays side of the latest published version
+ * (see BookVersion::sweep()).
  * 
  * @param quantity Order size in base currency
  * @param isBuy True for buy orders, false for sell orders
  * @return double Market impact as a percentage of mid price
  */
 double OrderBookProcessor::calculateMarketImpact(double quantity, bool isBuy) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    BookSnapshot snapshot = m_publisher.acquire();
     
-    const auto& levels = isBuy ? m_currentOrderBook.asks : m_currentOrderBook.bids;
-    if (levels.empty()) {
-        return 0.0;
-    }
-
-    double remainingQuantity = quantity;
-    double weightedPrice = 0.0;
-    double totalQuantity = 0.0;
-
-    for (const auto& level : levels) {
-        if (remainingQuantity <= 0.0) break;
-
-        double executedQuantity = std::min(remainingQuantity, level.quantity);
-        weightedPrice += level.price * executedQuantity;
-        totalQuantity += executedQuantity;
-        remainingQuantity -= executedQuantity;
-    }
-
-    if (totalQuantity == 0.0) {
-        return 0.0;
-    }
-
-    double averagePrice = weightedPrice / totalQuantity;
-    double midPrice = (levels[0].price + levels[0].price) / 2.0;
-    return std::abs(averagePrice - midPrice) / midPrice;
+    // Sweep in integer lots; notional is accumulated in tick*lot units
+    double quantityLots = static_cast<double>(snapshot.book().spec.quantity.fromDouble(quantity));
+    SweepResult sweep = snapshot->sweep(isBuy, quantityLots);
+    return makeEstimate(*snapshot, quantity, quantityLots, isBuy, sweep).impact;
 }
 
 /**
@@ -151,91 +507,398 @@ double OrderBookProcessor::calculateMarketImpact(double quantity, bool isBuy) co
  * @return double Slippage as a percentage of mid price, or infinity if insufficient liquidity
  */
 double OrderBookProcessor::calculateSlippage(double quantity, bool isBuy) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    BookSnapshot snapshot = m_publisher.acquire();
     
-    const auto& levels = isBuy ? m_currentOrderBook.asks : m_currentOrderBook.bids;
-    if (levels.empty()) {
-        return 0.0;
+    double quantityLots = static_cast<double>(snapshot.book().spec.quantity.fromDouble(quantity));
+    SweepResult sweep = snapshot->sweep(isBuy, quantityLots);
+    return makeEstimate(*snapshot, quantity, quantityLots, isBuy, sweep).slippage;
+}
+
+/**
+ * @brief Calculates impact, slippage and VWAP for many order sizes at once
+ * 
+ * All sizes are evaluated against one consistent book version. Ascending sizes are served by one forward sweep of the
+ * side; any other order falls back to the cumulative depth index.
+ * 
+ * @param quantities Order sizes in base currency
+ * @param isBuy True for buy orders, false for sell orders
+ * @return std::vector<ImpactEstimate> One estimate per order size, in input order
+ */
+std::vector<ImpactEstimate> OrderBookProcessor::calculateImpactCurve(
+    const std::vector<double>& quantities, bool isBuy) const {
+    std::vector<ImpactEstimate> estimates;
+    estimates.reserve(quantities.size());
+
+    std::vector<double> quantityLots(quantities.size());
+    std::vector<SweepResult> sweeps(quantities.size());
+
+    BookSnapshot snapshot = m_publisher.acquire();
+
+    const FixedPointScale& lotScale = snapshot.book().spec.quantity;
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        quantityLots[i] = static_cast<double>(lotScale.fromDouble(quantities[i]));
     }
 
-    double remainingQuantity = quantity;
-    double totalCost = 0.0;
+    const BookSideArrays& levels = snapshot->side(isBuy);
+    const CumulativeDepthIndex* index = nullptr;
+    if (std::is_sorted(quantityLots.begin(), quantityLots.end())) {
+        sweepDepthSorted(levels, quantityLots.data(), quantityLots.size(), sweeps.data());
+    } else if ((index = snapshot->depthIndex(isBuy)) != nullptr) {
+        for (size_t i = 0; i < quantityLots.size(); ++i) {
+            sweeps[i] = index->query(levels, quantityLots[i]);
+        }
+    } else {
+        // Another reader is building the index; sweep rather than wait
+        for (size_t i = 0; i < quantityLots.size(); ++i) {
+            sweeps[i] = sweepDepth(levels, quantityLots[i]);
+        }
+    }
 
-    for (const auto& level : levels) {
-        if (remainingQuantity <= 0.0) break;
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        estimates.push_back(makeEstimate(*snapshot, quantities[i], quantityLots[i], isBuy,
+                                         sweeps[i]));
+    }
+    return estimates;
+}
 
-        double executedQuantity = std::min(remainingQuantity, level.quantity);
-        totalCost += level.price * executedQuantity;
-        remainingQuantity -= executedQuantity;
+/**
+ * @brief Calculates an impact curve with a side per order size
+ * 
+ * Both sides are answered from their cumulative depth index, built at most
+ * once per published book version.
+ * 
+ * @param quantities Order sizes in base currency
+ * @param isBuy Side of each order; must have the same length as @p quantities
+ * @return std::vector<ImpactEstimate> One estimate per order size, in input order
+ * @throws std::invalid_argument if the lengths differ
+ */
+std::vector<ImpactEstimate> OrderBookProcessor::calculateImpactCurve(
+    const std::vector<double>& quantities, const std::vector<bool>& isBuy) const {
+    if (quantities.size() != isBuy.size()) {
+        throw std::invalid_argument("Impact curve sizes and sides must have the same length");
     }
 
-    if (remainingQuantity > 0.0) {
-        // Not enough liquidity
-        return std::numeric_limits<double>::infinity();
+    std::vector<ImpactEstimate> estimates;
+    estimates.reserve(quantities.size());
+
+    BookSnapshot snapshot = m_publisher.acquire();
+
+    const FixedPointScale& lotScale = snapshot.book().spec.quantity;
+    for (size_t i = 0; i < quantities.size(); ++i) {
+        double quantityLots = static_cast<double>(lotScale.fromDouble(quantities[i]));
+        const CumulativeDepthIndex* index = snapshot->depthIndex(isBuy[i]);
+        SweepResult sweep = index ? index->query(snapshot->side(isBuy[i]), quantityLots)
+                                  : sweepDepth(snapshot->side(isBuy[i]), quantityLots);
+        estimates.push_back(makeEstimate(*snapshot, quantities[i], quantityLots, isBuy[i], sweep));
     }
+    return estimates;
+}
+
+/**
+ * @brief Converts a sweep of a published book into an ImpactEstimate
+ * 
+ * Impact is measured against the volume actually filled, slippage against the
+ * full requested size, both relative to the best price of the swept side.
+ * 
+ * @param version Book version that was swept
+ * @param quantity Requested order size in base currency
+ * @param quantityLots Requested order size in lots
+ * @param isBuy True if the asks were swept
+ * @param sweep Result of sweeping the side
+ * @return ImpactEstimate Costs converted back to price and quantity units
+ */
+ImpactEstimate OrderBookProcessor::makeEstimate(const BookVersion& version, double quantity,
+                                                double quantityLots, bool isBuy,
+                                                const SweepResult& sweep) {
+    const InstrumentSpec& spec = version.book().spec;
+    const BookSideArrays& levels = version.side(isBuy);
 
-    double averagePrice = totalCost / quantity;
-    double midPrice = (levels[0].price + levels[0].price) / 2.0;
-    return std::abs(averagePrice - midPrice) / midPrice;
+    ImpactEstimate estimate{quantity, isBuy, sweep.filledLots * spec.quantity.increment(),
+                            0.0, 0.0, 0.0, false};
+    if (levels.size() == 0 || quantityLots <= 0.0) {
+        return estimate;
+    }
+
+    // The ratios are scale-free, so they can be taken directly in tick units
+    double midTicks = levels.prices()[0];
+    if (sweep.filledLots > 0.0) {
+        double averageTicks = sweep.notionalTicks / sweep.filledLots;
+        estimate.vwap = averageTicks * spec.price.increment();
+        estimate.impact = std::abs(averageTicks - midTicks) / midTicks;
+    }
+
+    estimate.liquidityExhausted = sweep.filledLots < quantityLots;
+    if (estimate.liquidityExhausted) {
+        // Not enough liquidity
+        estimate.slippage = std::numeric_limits<double>::infinity();
+    } else {
+        double averageTicks = sweep.notionalTicks / quantityLots;
+        estimate.slippage = std::abs(averageTicks - midTicks) / midTicks;
+    }
+    return estimate;
 }
 
 /**
  * @brief Calculates the proportion of maker vs taker orders
  * 
- * Analyzes order book history to estimate the ratio of maker to taker orders
- * based on price movement patterns.
+ * Estimates the ratio of maker to taker orders from price movement patterns
+ * over the most recent HISTORY_SIZE books. The counts are maintained
+ * incrementally as books are committed and the ratio is published with each
+ * book version, so this is O(1). It is 0.5 until there is any history.
  * 
  * @return double Proportion of maker orders (0.0 to 1.0)
  */
 double OrderBookProcessor::calculateMakerTakerProportion() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    if (m_orderBookHistory.empty()) {
-        return 0.5;  // Default to 50/50 if no history
-    }
+    return m_publisher.acquire()->makerTakerProportion();
+}
 
-    // Calculate the proportion of maker orders based on order book changes
-    size_t makerCount = 0;
-    size_t totalCount = 0;
+/**
+ * @brief Folds the newest book change into the running maker/taker counters
+ * 
+ * Compares the current book with the previous one level by level and adds
+ * the result to a ring of per-pair samples; the sample of the pair that
+ * leaves the HISTORY_SIZE window is subtracted. The counters therefore match
+ * a full rescan of the window while each update only costs one comparison of
+ * the two books.
+ */
+void OrderBookProcessor::updateMakerTakerCounters() {
+    const auto& asks = m_currentOrderBook.asks;
+    const auto& bids = m_currentOrderBook.bids;
 
-    for (size_t i = 1; i < m_orderBookHistory.size(); ++i) {
-        const auto& prev = m_orderBookHistory[i-1];
-        const auto& curr = m_orderBookHistory[i];
+    if (m_orderBookHistory.size() > 1) {
+        MakerTakerSample sample{0, 0};
 
         // Compare ask levels
-        for (size_t j = 0; j < std::min(prev.asks.size(), curr.asks.size()); ++j) {
-            if (prev.asks[j].price != curr.asks[j].price) {
-                totalCount++;
-                if (curr.asks[j].price > prev.asks[j].price) {
-                    makerCount++;  // Price increase suggests maker order
+        size_t depth = std::min(m_previousAsks.size(), asks.size());
+        for (size_t j = 0; j < depth; ++j) {
+            if (m_previousAsks[j].priceTicks != asks[j].priceTicks) {
+                sample.changes++;
+                if (asks[j].priceTicks > m_previousAsks[j].priceTicks) {
+                    sample.makers++;  // Price increase suggests maker order
                 }
             }
         }
 
         // Compare bid levels
-        for (size_t j = 0; j < std::min(prev.bids.size(), curr.bids.size()); ++j) {
-            if (prev.bids[j].price != curr.bids[j].price) {
-                totalCount++;
-                if (curr.bids[j].price < prev.bids[j].price) {
-                    makerCount++;  // Price decrease suggests maker order
+        depth = std::min(m_previousBids.size(), bids.size());
+        for (size_t j = 0; j < depth; ++j) {
+            if (m_previousBids[j].priceTicks != bids[j].priceTicks) {
+                sample.changes++;
+                if (bids[j].priceTicks < m_previousBids[j].priceTicks) {
+                    sample.makers++;  // Price decrease suggests maker order
                 }
             }
         }
+
+        MakerTakerSample& slot = m_makerTakerWindow[m_makerTakerNext];
+        if (m_makerTakerSamples == m_makerTakerWindow.size()) {
+            m_makerCount -= slot.makers;
+            m_changeCount -= slot.changes;
+        } else {
+            ++m_makerTakerSamples;
+        }
+        slot = sample;
+        m_makerCount += sample.makers;
+        m_changeCount += sample.changes;
+        m_makerTakerNext = (m_makerTakerNext + 1) % m_makerTakerWindow.size();
     }
 
-    return totalCount > 0 ? static_cast<double>(makerCount) / totalCount : 0.5;
+    m_previousAsks.assign(asks.begin(), asks.end());
+    m_previousBids.assign(bids.begin(), bids.end());
 }
 
 /**
- * @brief Maintains the order book history within size limits
+ * @brief Returns the number of order books retained in the history
  * 
- * Removes oldest entries when history exceeds HISTORY_SIZE to prevent
- * unbounded memory growth.
+ * @return size_t Number of retained books
  */
-void OrderBookProcessor::maintainHistory() {
-    while (m_orderBookHistory.size() > HISTORY_SIZE) {
-        m_orderBookHistory.pop_front();
+size_t OrderBookProcessor::getHistorySize() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_orderBookHistory.size();
+}
+
+/**
+ * @brief Rebuilds a past order book from the history
+ * 
+ * Only the book's segment is copied under the lock; the book is rebuilt
+ * after it is released.
+ * 
+ * @param index Position in the history, 0 being the oldest retained book
+ * @return OrderBook Reconstructed book
+ * @throws std::out_of_range if @p index is not retained
+ */
+OrderBook OrderBookProcessor::getHistoricalOrderBook(size_t index) const {
+    size_t offset = 0;
+    OrderBookHistory window = [&]() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_orderBookHistory.copyRange(index, index + 1, offset);
+    }();
+    return window.at(offset);
+}
+
+/**
+ * @brief Finds the first retained book at or after an exchange time
+ * 
+ * Only binary searches the stored timestamps, so the lock is held briefly.
+ * 
+ * @param exchangeTimeNs Exchange time in nanoseconds since the epoch
+ * @return size_t History position, or getHistorySize() if every book is earlier
+ */
+size_t OrderBookProcessor::findHistoryIndex(int64_t exchangeTimeNs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_orderBookHistory.lowerBound(exchangeTimeNs);
+}
+
+/**
+ * @brief Rebuilds every retained book with exchange time in [@p fromNs, @p toNs)
+ * 
+ * The range is located by binary search on the stored timestamps and its
+ * segments are copied under the lock. The books are replayed from a single
+ * keyframe after the lock is released, so a long range does not hold up
+ * the ingest thread's history appends.
+ * 
+ * @param fromNs Inclusive start, nanoseconds since the epoch
+ * @param toNs Exclusive end, nanoseconds since the epoch
+ * @return std::vector<OrderBook> Reconstructed books, oldest first
+ */
+std::vector<OrderBook> OrderBookProcessor::getHistoricalRange(int64_t fromNs, int64_t toNs) const {
+    size_t count = 0;
+    size_t offset = 0;
+    OrderBookHistory window = [&]() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t first = m_orderBookHistory.lowerBound(fromNs);
+        size_t last = m_orderBookHistory.lowerBound(toNs);
+        count = last > first ? last - first : 0;
+        return m_orderBookHistory.copyRange(first, last, offset);
+    }();
+
+    std::vector<OrderBook> books;
+    books.reserve(count);
+    window.forEach(offset, offset + count,
+        [&books](size_t, const OrderBook& book) { books.push_back(book); });
+    return books;
+}
+
+/**
+ * @brief Subscribes to consolidated analytics updates
+ * 
+ * The subscription has no QObject parent, so that the caller can move it
+ * to the consumer's thread; the processor deletes it on destruction.
+ * 
+ * @param maxRateHz Maximum updates per second; 0 for every book version
+ * @param policy How updates the consumer has not taken yet are absorbed
+ * @return AnalyticsSubscription* Subscription owned by the processor
+ */
+AnalyticsSubscription* OrderBookProcessor::subscribeAnalytics(double maxRateHz,
+                                                              const ConflationPolicy& policy) {
+    auto* subscription = new AnalyticsSubscription(maxRateHz, policy);
+    std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+    m_subscriptions.push_back(subscription);
+    return subscription;
+}
+
+/**
+ * @brief Cancels a subscription
+ * 
+ * Once this returns the ingest thread no longer emits on the subscription;
+ * deletion is deferred so that queued deliveries already posted are safe.
+ * 
+ * @param subscription Subscription returned by subscribeAnalytics()
+ */
+void OrderBookProcessor::unsubscribeAnalytics(AnalyticsSubscription* subscription) {
+    {
+        std::lock_guard<std::mutex> lock(m_subscriptionMutex);
+        auto it = std::find(m_subscriptions.begin(), m_subscriptions.end(), subscription);
+        if (it == m_subscriptions.end()) {
+            return;
+        }
+        m_subscriptions.erase(it);
+    }
+    subscription->deleteLater();
+}
+
+/**
+ * @brief Creates a subscription limited to @p maxRateHz emissions per second
+ * 
+ * @param maxRateHz Maximum rate in Hz; 0 or less means every book version
+ * @param policy How undelivered updates are absorbed
+ */
+AnalyticsSubscription::AnalyticsSubscription(double maxRateHz, const ConflationPolicy& policy)
+    : QObject(nullptr)
+    , m_maxRate(maxRateHz > 0.0 ? maxRateHz : 0.0)
+    , m_minIntervalNs(maxRateHz > 0.0 ? static_cast<int64_t>(1e9 / maxRateHz) : 0)
+    , m_lastEmitNs(std::numeric_limits<int64_t>::min() / 2)
+    , m_policy(policy)
+{
+    if (m_policy.mode == ConflationPolicy::Mode::TimeBucket && m_policy.bucketNs <= 0) {
+        throw std::invalid_argument("Time-bucket conflation needs a positive bucket width");
+    }
+    if (m_policy.mode != ConflationPolicy::Mode::None) {
+        m_policy.depth = std::max<size_t>(m_policy.depth, 1);
+        m_pending.reserve(m_policy.depth);
+        m_delivering.reserve(m_policy.depth);
+    }
+    qRegisterMetaType<GoQuant::BookAnalytics>();
+}
+
+/**
+ * @brief Emits or enqueues an update
+ * 
+ * Without conflation the update is emitted right away. Otherwise it is
+ * merged into the mailbox under a lock that the consumer only ever holds
+ * for a vector swap, and a delivery is queued to the subscription's thread
+ * only when the mailbox goes from empty to non-empty.
+ * 
+ * @param analytics Update to deliver
+ * @param nowNs Steady-clock time of the update
+ */
+void AnalyticsSubscription::offer(const BookAnalytics& analytics, int64_t nowNs) {
+    if (m_policy.mode == ConflationPolicy::Mode::None) {
+        m_delivered.fetch_add(1, std::memory_order_relaxed);
+        emit analyticsUpdated(analytics);
+        return;
+    }
+
+    int64_t bucket = m_policy.mode == ConflationPolicy::Mode::TimeBucket
+                         ? nowNs / m_policy.bucketNs : 0;
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(m_mailboxMutex);
+        wasEmpty = m_pending.empty();
+        if (m_policy.mode == ConflationPolicy::Mode::TimeBucket &&
+            !wasEmpty && m_pending.back().bucket == bucket) {
+            m_pending.back().analytics = analytics;
+            m_merged.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            if (m_pending.size() == m_policy.depth) {
+                m_pending.erase(m_pending.begin());
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_pending.push_back({analytics, bucket});
+        }
+    }
+
+    if (wasEmpty) {
+        QMetaObject::invokeMethod(this, [this]() { deliverPending(); }, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief Emits every pending update, oldest first
+ * 
+ * The mailbox is swapped out in one step, so updates arriving during the
+ * emission start a new batch and queue the next delivery.
+ */
+void AnalyticsSubscription::deliverPending() {
+    {
+        std::lock_guard<std::mutex> lock(m_mailboxMutex);
+        std::swap(m_pending, m_delivering);
+    }
+    for (const PendingUpdate& update : m_delivering) {
+        m_delivered.fetch_add(1, std::memory_order_relaxed);
+        emit analyticsUpdated(update.analytics);
     }
+    m_delivering.clear();
 }
 
-} // namespace GoQuant 
\ No newline at end of file
+} // namespace GoQuant
@@ -0,0 +1,193 @@
+/**
+ * @file ReplayEngine.cpp
+ * @brief Implementation of the journal ReplayEngine
+ *
+ * This file contains the replay loop, its pacing and the collection of
+ * throughput and latency statistics.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/ReplayEngine.h"
+#include "core/JournalReader.h"
+#include "core/Timestamp.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace GoQuant {
+
+namespace {
+
+/// Waits shorter than this are spun rather than slept, for timing accuracy
+constexpr int64_t SPIN_THRESHOLD_NS = 200000;
+
+/// Longest single sleep, so stop() is honoured promptly during long gaps
+constexpr int64_t MAX_SLEEP_NS = 50000000;
+
+/**
+ * @brief Detaches the stage histograms from the processor when a run ends
+ */
+struct StageLatencyScope {
+    OrderBookProcessor& processor;
+    ~StageLatencyScope() { processor.setStageLatency(nullptr); }
+};
+
+} // namespace
+
+/**
+ * @brief Constructs an engine feeding @p processor
+ *
+ * @param processor Processor to replay into; run() is its ingest thread
+ */
+ReplayEngine::ReplayEngine(OrderBookProcessor& processor)
+    : m_processor(processor)
+{
+}
+
+/**
+ * @brief Sets the pacing of later runs
+ */
+void ReplayEngine::setPacing(const ReplayPacing& pacing) {
+    m_pacing = pacing;
+}
+
+/**
+ * @brief Selects the instrument to replay
+ *
+ * @param instrument Registry ID; UNKNOWN_INSTRUMENT replays the first
+ *        instrument met in the journal
+ */
+void ReplayEngine::setInstrument(InstrumentId instrument) {
+    m_instrument = instrument;
+}
+
+/**
+ * @brief Sets a callback for the books the replay produces
+ *
+ * @param callback Callback, or an empty function for none
+ */
+void ReplayEngine::setBookCallback(BookCallback callback) {
+    m_bookCallback = std::move(callback);
+}
+
+/**
+ * @brief Replays journal files in order on the calling thread
+ *
+ * Each frame's latency is measured around processRawMessage(), and the
+ * processor's stage timing is switched on for the duration of the run.
+ * In paced modes frame i is due at the start of the run plus its recorded
+ * offset from the first frame, divided by the speed; a replay that falls
+ * behind catches up without waiting, and how late each frame started is
+ * recorded as schedule lag.
+ *
+ * @param files Journal files, typically from JournalReader::listFiles()
+ * @return ReplayStats Throughput and latency of the run
+ * @throws std::runtime_error if a file is not a readable journal
+ */
+ReplayStats ReplayEngine::run(const QStringList& files) {
+    m_stopping.store(false, std::memory_order_relaxed);
+
+    ReplayStats stats;
+    stats.instrument = m_instrument;
+    bool paced = m_pacing.mode != ReplayPacing::Mode::AsFastAsPossible;
+    double speed = m_pacing.mode == ReplayPacing::Mode::Scaled ? m_pacing.speed : 1.0;
+
+    StageLatencyScope scope{m_processor};
+    m_processor.setStageLatency(&stats.stages);
+
+    int64_t runStartNs = steadyNanoseconds();
+    int64_t firstRecordNs = 0;
+    bool started = false;
+    uint64_t lastVersion = m_processor.acquireSnapshot().version();
+
+    for (const QString& path : files) {
+        if (m_stopping.load(std::memory_order_relaxed)) {
+            break;
+        }
+        JournalReader reader(path);
+        ++stats.files;
+
+        JournalFrame frame;
+        while (!m_stopping.load(std::memory_order_relaxed) && reader.next(frame)) {
+            if (stats.instrument == UNKNOWN_INSTRUMENT) {
+                stats.instrument = frame.instrument;
+            }
+            if (frame.instrument == UNKNOWN_INSTRUMENT || frame.instrument != stats.instrument) {
+                ++stats.framesSkipped;
+                continue;
+            }
+
+            int64_t frameStartNs;
+            if (paced) {
+                if (!started) {
+                    firstRecordNs = frame.receiveTimeNs;
+                    runStartNs = steadyNanoseconds();
+                    started = true;
+                }
+                int64_t dueNs = runStartNs +
+                    static_cast<int64_t>(static_cast<double>(frame.receiveTimeNs - firstRecordNs) / speed);
+                waitUntil(dueNs);
+                frameStartNs = steadyNanoseconds();
+                stats.scheduleLag.record(frameStartNs - dueNs);
+            } else {
+                frameStartNs = steadyNanoseconds();
+            }
+
+            try {
+                m_processor.processRawMessage(frame.bytes, frame.receiveTimeNs);
+                ++stats.framesReplayed;
+                stats.bytesReplayed += frame.bytes.size();
+            } catch (const std::exception&) {
+                ++stats.framesFailed;
+            }
+            stats.frameLatency.record(steadyNanoseconds() - frameStartNs);
+
+            if (m_bookCallback) {
+                BookSnapshot snapshot = m_processor.acquireSnapshot();
+                if (snapshot.version() != lastVersion) {
+                    lastVersion = snapshot.version();
+                    m_bookCallback(snapshot.book());
+                }
+            }
+        }
+    }
+
+    stats.elapsedSeconds = (steadyNanoseconds() - runStartNs) * 1e-9;
+    if (stats.elapsedSeconds > 0.0) {
+        stats.messagesPerSecond = stats.framesReplayed / stats.elapsedSeconds;
+        stats.megabytesPerSecond = stats.bytesReplayed * 1e-6 / stats.elapsedSeconds;
+    }
+    return stats;
+}
+
+/**
+ * @brief Makes a running replay return after its current frame; safe from any thread
+ */
+void ReplayEngine::stop() {
+    m_stopping.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Waits until the steady clock reaches @p dueNs or the replay is stopped
+ *
+ * Sleeps in bounded slices while far from the deadline, then spins for the
+ * last SPIN_THRESHOLD_NS, since sleeps overshoot by tens of microseconds.
+ */
+void ReplayEngine::waitUntil(int64_t dueNs) const {
+    for (;;) {
+        int64_t remaining = dueNs - steadyNanoseconds();
+        if (remaining <= 0 || m_stopping.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (remaining > SPIN_THRESHOLD_NS) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(
+                std::min(remaining - SPIN_THRESHOLD_NS, MAX_SLEEP_NS)));
+        }
+    }
+}
+
+} // namespace GoQuant
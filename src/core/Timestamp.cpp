@@ -0,0 +1,217 @@
+/**
+ * @file Timestamp.cpp
+ * @brief Implementation of exchange timestamp parsing
+ *
+ * This file contains an allocation-free parser for epoch and ISO 8601
+ * timestamps, the wall-clock receive stamp and the steady clock.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/Timestamp.h"
+#include <charconv>
+#include <chrono>
+#include <limits>
+#include <system_error>
+
+namespace GoQuant {
+
+namespace {
+
+constexpr std::int64_t NANOS_PER_SECOND = 1000000000;
+
+/**
+ * @brief Reads exactly @p count digits starting at @p pos
+ */
+bool readDigits(std::string_view text, std::size_t& pos, std::size_t count, int& value) {
+    if (pos + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        char c = text[pos + i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    pos += count;
+    return true;
+}
+
+/**
+ * @brief Days from 1970-01-01 to the given proleptic Gregorian date
+ *
+ * Howard Hinnant's days_from_civil algorithm.
+ */
+std::int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return static_cast<std::int64_t>(era) * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @brief Number of days in a month of the proleptic Gregorian calendar
+ */
+int daysInMonth(int year, int month) {
+    static constexpr int DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    return month == 2 && leap ? 29 : DAYS[month - 1];
+}
+
+/**
+ * @brief Parses an integer epoch time, inferring its unit from its length
+ *
+ * Fails rather than wraps if the time does not fit in int64 nanoseconds.
+ */
+bool parseEpoch(std::string_view text, std::int64_t& nanoseconds) {
+    if (text.empty() || text.size() > 19 || text.front() < '0' || text.front() > '9') {
+        return false;
+    }
+
+    std::int64_t value = 0;
+    const char* end = text.data() + text.size();
+    std::from_chars_result parsed = std::from_chars(text.data(), end, value);
+    if (parsed.ec != std::errc() || parsed.ptr != end) {
+        return false;
+    }
+
+    std::int64_t scale = text.size() <= 10 ? NANOS_PER_SECOND
+                       : text.size() <= 13 ? 1000000
+                       : text.size() <= 16 ? 1000 : 1;
+    if (value > std::numeric_limits<std::int64_t>::max() / scale) {
+        return false;
+    }
+    nanoseconds = value * scale;
+    return true;
+}
+
+/**
+ * @brief Parses an ISO 8601 date-time with optional fraction and offset
+ *
+ * Rejects dates that do not exist, such as 02-31, and times that do not
+ * fit in int64 nanoseconds (after 2262-04-11).
+ */
+bool parseIso8601(std::string_view text, std::int64_t& nanoseconds) {
+    std::size_t pos = 0;
+    int year, month, day, hour, minute, second;
+    if (!readDigits(text, pos, 4, year) || pos >= text.size() || text[pos++] != '-' ||
+        !readDigits(text, pos, 2, month) || pos >= text.size() || text[pos++] != '-' ||
+        !readDigits(text, pos, 2, day) || pos >= text.size() ||
+        (text[pos] != 'T' && text[pos] != 't' && text[pos] != ' ')) {
+        return false;
+    }
+    ++pos;
+    if (!readDigits(text, pos, 2, hour) || pos >= text.size() || text[pos++] != ':' ||
+        !readDigits(text, pos, 2, minute) || pos >= text.size() || text[pos++] != ':' ||
+        !readDigits(text, pos, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) || hour > 23 ||
+        minute > 59 || second > 60) {
+        return false;
+    }
+
+    std::int64_t fraction = 0;
+    if (pos < text.size() && (text[pos] == '.' || text[pos] == ',')) {
+        ++pos;
+        std::int64_t scale = NANOS_PER_SECOND;
+        std::size_t digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += (text[pos] - '0') * scale;
+            }
+            ++pos;
+            ++digits;
+        }
+        if (digits == 0) {
+            return false;
+        }
+    }
+
+    std::int64_t offsetSeconds = 0;
+    if (pos < text.size()) {
+        char sign = text[pos++];
+        if (sign == 'Z' || sign == 'z') {
+            // UTC
+        } else if (sign == '+' || sign == '-') {
+            int offsetHours, offsetMinutes = 0;
+            if (!readDigits(text, pos, 2, offsetHours)) {
+                return false;
+            }
+            if (pos < text.size() && text[pos] == ':') {
+                ++pos;
+            }
+            if (pos < text.size() && !readDigits(text, pos, 2, offsetMinutes)) {
+                return false;
+            }
+            offsetSeconds = (offsetHours * 3600 + offsetMinutes * 60) * (sign == '+' ? 1 : -1);
+        } else {
+            return false;
+        }
+    }
+    if (pos != text.size()) {
+        return false;
+    }
+
+    std::int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 +
+                           minute * 60 + second - offsetSeconds;
+    constexpr std::int64_t MAX = std::numeric_limits<std::int64_t>::max();
+    constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+    if (seconds > MAX / NANOS_PER_SECOND || seconds < MIN / NANOS_PER_SECOND ||
+        (seconds == MAX / NANOS_PER_SECOND && fraction > MAX % NANOS_PER_SECOND)) {
+        return false;
+    }
+    nanoseconds = seconds * NANOS_PER_SECOND + fraction;
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Parses an exchange timestamp into nanoseconds since the Unix epoch
+ *
+ * @param text Timestamp text, without surrounding quotes
+ * @param nanoseconds Receives the time in nanoseconds since the epoch
+ * @return bool False if the text is not a supported timestamp
+ */
+bool parseTimestamp(std::string_view text, std::int64_t& nanoseconds) {
+    if (text.size() > 4 && text[4] == '-') {
+        return parseIso8601(text, nanoseconds);
+    }
+    return parseEpoch(text, nanoseconds);
+}
+
+/**
+ * @brief UTC day of a time, in days since the Unix epoch, rounding down
+ *
+ * @param timeNs Nanoseconds since the epoch
+ */
+std::int64_t utcDay(std::int64_t timeNs) {
+    std::int64_t day = timeNs / NS_PER_DAY;
+    return timeNs % NS_PER_DAY < 0 ? day - 1 : day;
+}
+
+/**
+ * @brief Current wall-clock time in nanoseconds since the Unix epoch
+ */
+std::int64_t wallClockNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Current steady-clock time in nanoseconds
+ */
+std::int64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace GoQuant
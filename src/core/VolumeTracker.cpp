@@ -0,0 +1,168 @@
+/**
+ * @file VolumeTracker.cpp
+ * @brief Implementation of the VolumeTracker class
+ *
+ * This file contains the day-bucketed rolling volume window and the
+ * incremental fee tier update on rollover.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "core/VolumeTracker.h"
+#include "core/Timestamp.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace GoQuant {
+
+namespace {
+
+/// @p usd in whole cents
+int64_t toCents(double usd) {
+    return std::llround(usd * 100.0);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a tracker with an empty window at day 0
+ *
+ * @param schedule Fee schedule the tiers come from
+ * @param id (Exchange, product) schedule of the account
+ * @param windowDays Completed days that set the tier
+ * @throws std::invalid_argument if @p schedule is null, @p id is not one of
+ *         its schedules or @p windowDays is not positive
+ */
+VolumeTracker::VolumeTracker(std::shared_ptr<const FeeSchedule> schedule, FeeScheduleId id,
+                             int windowDays)
+    : m_schedule(std::move(schedule))
+    , m_id(id)
+    , m_windowDays(windowDays)
+{
+    if (!m_schedule || id >= m_schedule->scheduleCount()) {
+        throw std::invalid_argument("Volume tracker needs a valid fee schedule");
+    }
+    if (windowDays <= 0) {
+        throw std::invalid_argument("Volume window must be at least one day");
+    }
+    m_buckets.assign(static_cast<std::size_t>(windowDays) + 1, 0);
+}
+
+/**
+ * @brief Restarts the window at the day of @p timeNs
+ *
+ * This is the one place the tier is found by search rather than stepped.
+ *
+ * @param timeNs Current time, in nanoseconds since the epoch
+ * @param priorVolume Volume of the window before that day, in USD
+ * @throws std::invalid_argument if @p priorVolume is negative
+ */
+void VolumeTracker::reset(int64_t timeNs, double priorVolume) {
+    if (priorVolume < 0.0) {
+        throw std::invalid_argument("Trading volume cannot be negative");
+    }
+    m_day = utcDay(timeNs);
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+
+    int64_t cents = toCents(priorVolume);
+    int64_t perDay = cents / m_windowDays;
+    int64_t remainder = cents % m_windowDays;
+    for (int back = 1; back <= m_windowDays; ++back) {
+        // The oldest days take the remainder and roll off first
+        m_buckets[slot(m_day - back)] = perDay + (m_windowDays - back < remainder ? 1 : 0);
+    }
+    m_windowCents = cents;
+    m_tier = m_schedule->tierForVolume(m_id, windowVolume());
+}
+
+/**
+ * @brief Moves the clock to the day of @p timeNs, rolling the window
+ *
+ * Each new day moves the day before it into the window total and clears
+ * the bucket it reuses, which holds the day leaving the window. A gap
+ * longer than the window empties it.
+ *
+ * @param timeNs Current time, in nanoseconds since the epoch
+ * @return bool True if the tier changed
+ */
+bool VolumeTracker::advanceTo(int64_t timeNs) {
+    int64_t day = utcDay(timeNs);
+    if (day <= m_day) {
+        return false;
+    }
+
+    if (day - m_day > m_windowDays) {
+        std::fill(m_buckets.begin(), m_buckets.end(), 0);
+        m_windowCents = 0;
+    } else {
+        for (int64_t next = m_day + 1; next <= day; ++next) {
+            int64_t& reused = m_buckets[slot(next)];
+            m_windowCents += m_buckets[slot(next - 1)] - reused;
+            reused = 0;
+        }
+    }
+    m_day = day;
+    return updateTier();
+}
+
+/**
+ * @brief Adds an executed or simulated fill
+ *
+ * @param timeNs Time of the fill, in nanoseconds since the epoch
+ * @param notional Traded value in USD
+ * @return bool True if the tier changed
+ * @throws std::invalid_argument if @p notional is negative
+ */
+bool VolumeTracker::recordFill(int64_t timeNs, double notional) {
+    if (notional < 0.0) {
+        throw std::invalid_argument("Fill notional cannot be negative");
+    }
+    bool changed = advanceTo(timeNs);
+
+    int64_t day = utcDay(timeNs);
+    int64_t cents = toCents(notional);
+    if (day == m_day) {
+        m_buckets[slot(day)] += cents;
+    } else if (day >= m_day - m_windowDays) {
+        m_buckets[slot(day)] += cents;
+        m_windowCents += cents;
+        changed = updateTier() || changed;
+    }
+    return changed;
+}
+
+/**
+ * @brief Bucket of @p day in the ring
+ */
+std::size_t VolumeTracker::slot(int64_t day) const {
+    int64_t size = static_cast<int64_t>(m_buckets.size());
+    int64_t index = day % size;
+    return static_cast<std::size_t>(index < 0 ? index + size : index);
+}
+
+/**
+ * @brief Steps the tier to match the window total
+ *
+ * A day's volume rarely crosses more than one threshold, so walking from the
+ * current tier takes a step or two where a search would take several.
+ *
+ * @return bool True if the tier changed
+ */
+bool VolumeTracker::updateTier() {
+    std::uint32_t previous = m_tier;
+    std::uint32_t count = m_schedule->tierCount(m_id);
+    double volume = windowVolume();
+    while (m_tier + 1 < count && volume >= m_schedule->minVolume(m_id, m_tier + 1)) {
+        ++m_tier;
+    }
+    while (m_tier > 0 && volume < m_schedule->minVolume(m_id, m_tier)) {
+        --m_tier;
+    }
+    return m_tier != previous;
+}
+
+} // namespace GoQuant
@@ -12,40 +12,71 @@
  */
 
 #include "core/WebSocketClient.h"
+#include "core/Timestamp.h"
 #include <QDebug>
+#include <algorithm>
 
 namespace GoQuant {
 
+namespace {
+
+/// Number of empty polls before the processing thread goes to sleep
+constexpr int SPIN_POLLS = 256;
+
+} // namespace
+
 /**
  * @brief Constructs a new WebSocketClient instance
  * 
- * Initializes the WebSocket client and sets up signal/slot connections for
- * handling connection events and message reception.
+ * Creates the socket, moves it to the I/O thread and starts both the I/O and
+ * processing threads. Socket signals are connected with the socket itself
+ * as context, so the handlers run on the I/O thread.
  * 
  * @param parent Parent QObject for Qt signal/slot system
+ * @param queueCapacity Frames the handoff ring can hold; rounded up to a power of two
  */
-WebSocketClient::WebSocketClient(QObject *parent)
+WebSocketClient::WebSocketClient(QObject *parent, size_t queueCapacity)
     : QObject(parent)
     , m_webSocket(new QWebSocket())
+    , m_encoder(QStringEncoder::Utf8)
     , m_isConnected(false)
+    , m_ring(queueCapacity)
 {
-    connect(m_webSocket.get(), &QWebSocket::connected, this, &WebSocketClient::onConnected);
-    connect(m_webSocket.get(), &QWebSocket::disconnected, this, &WebSocketClient::onDisconnected);
-    connect(m_webSocket.get(), QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
-            this, &WebSocketClient::onError);
-    connect(m_webSocket.get(), &QWebSocket::textMessageReceived,
-            this, &WebSocketClient::onTextMessageReceived);
+    m_ioThread.setObjectName("WebSocketIO");
+    m_webSocket->moveToThread(&m_ioThread);
+    QObject::connect(&m_ioThread, &QThread::finished, m_webSocket, &QObject::deleteLater);
+
+    QObject::connect(m_webSocket, &QWebSocket::connected, m_webSocket, [this]() { onConnected(); });
+    QObject::connect(m_webSocket, &QWebSocket::disconnected, m_webSocket, [this]() { onDisconnected(); });
+    QObject::connect(m_webSocket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+                     m_webSocket, [this](QAbstractSocket::SocketError error) { onError(error); });
+    QObject::connect(m_webSocket, &QWebSocket::textMessageReceived, m_webSocket,
+                     [this](const QString &message) { onTextMessageReceived(message); });
+    QObject::connect(m_webSocket, &QWebSocket::binaryMessageReceived, m_webSocket,
+                     [this](const QByteArray &message) { onBinaryMessageReceived(message); });
+
+    m_ioThread.start();
+    m_processingThread = std::thread([this]() { runProcessing(); });
 }
 
 /**
  * @brief Destructor for WebSocketClient
  * 
- * Ensures proper cleanup by disconnecting from the WebSocket server
- * before destruction.
+ * Closes the connection, stops the I/O thread (which deletes the socket),
+ * then lets the processing thread drain the frames already queued.
  */
 WebSocketClient::~WebSocketClient()
 {
     disconnect();
+    m_ioThread.quit();
+    m_ioThread.wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeupMutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_one();
+    m_processingThread.join();
 }
 
 /**
@@ -55,8 +86,10 @@ WebSocketClient::~WebSocketClient()
  */
 void WebSocketClient::connect(const QString &url)
 {
+    m_url = url;
     if (!m_isConnected) {
-        m_webSocket->open(QUrl(url));
+        QWebSocket* socket = m_webSocket;
+        QMetaObject::invokeMethod(socket, [socket, url]() { socket->open(QUrl(url)); });
     }
 }
 
@@ -68,10 +101,30 @@ void WebSocketClient::connect(const QString &url)
 void WebSocketClient::disconnect()
 {
     if (m_isConnected) {
-        m_webSocket->close();
+        QWebSocket* socket = m_webSocket;
+        QMetaObject::invokeMethod(socket, [socket]() { socket->close(); });
     }
 }
 
+/**
+ * @brief Reopens the connection to the last URL, so the feed resends its snapshot
+ * 
+ * Close and open are queued together on the I/O thread, so no frame is
+ * read between them.
+ */
+void WebSocketClient::reconnect()
+{
+    if (m_url.isEmpty()) {
+        return;
+    }
+    QWebSocket* socket = m_webSocket;
+    QString url = m_url;
+    QMetaObject::invokeMethod(socket, [socket, url]() {
+        socket->close();
+        socket->open(QUrl(url));
+    });
+}
+
 /**
  * @brief Checks if the client is currently connected
  * 
@@ -83,13 +136,97 @@ bool WebSocketClient::isConnected() const
 }
 
 /**
- * @brief Sets the callback function for handling incoming messages
+ * @brief Sets the callback function for handling incoming frames
+ * 
+ * @param callback Function to be called on the processing thread for each frame
+ */
+void WebSocketClient::setFrameCallback(FrameCallback callback)
+{
+    m_frameCallback = std::move(callback);
+}
+
+/**
+ * @brief Returns queue depth and handoff latency counters
+ * 
+ * @return FeedStats Current counters
+ */
+FeedStats WebSocketClient::stats() const
+{
+    FeedStats stats{};
+    stats.framesReceived = m_framesReceived.load(std::memory_order_relaxed);
+    stats.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+    stats.framesProcessed = m_framesProcessed.load(std::memory_order_relaxed);
+    stats.framesFailed = m_framesFailed.load(std::memory_order_relaxed);
+    stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+    stats.queueDepth = m_ring.size();
+    stats.queueHighWater = m_queueHighWater.load(std::memory_order_relaxed);
+    stats.queueCapacity = m_ring.capacity();
+    uint64_t handedOff = stats.framesProcessed + stats.framesFailed;
+    if (handedOff > 0) {
+        stats.meanHandoffNs =
+            static_cast<double>(m_handoffTotalNs.load(std::memory_order_relaxed)) / handedOff;
+    }
+    stats.maxHandoffNs = m_handoffMaxNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Starts recording every queued frame to a capture journal
+ * 
+ * The journal is created on the calling thread, so a file error surfaces
+ * here rather than on the I/O thread.
  * 
- * @param callback Function to be called when a message is received
+ * @param config Directory, rotation limits and queue size of the journal
+ */
+void WebSocketClient::startCapture(const CaptureConfig &config)
+{
+    setJournal(std::make_unique<CaptureJournal>(config));
+}
+
+/**
+ * @brief Stops recording and closes the journal
  */
-void WebSocketClient::setMessageCallback(MessageCallback callback)
+void WebSocketClient::stopCapture()
 {
-    m_messageCallback = std::move(callback);
+    setJournal(nullptr);
+}
+
+/**
+ * @brief Checks if capture mode is on
+ */
+bool WebSocketClient::isCapturing() const
+{
+    std::lock_guard<std::mutex> lock(m_captureMutex);
+    return m_journal != nullptr;
+}
+
+/**
+ * @brief Returns the counters of the running journal
+ * 
+ * @return CaptureStats Current counters; all zero if capture is off
+ */
+CaptureStats WebSocketClient::captureStats() const
+{
+    std::lock_guard<std::mutex> lock(m_captureMutex);
+    return m_journal ? m_journal->stats() : CaptureStats{};
+}
+
+/**
+ * @brief Points the I/O thread at a journal and takes ownership of it
+ * 
+ * The I/O thread is the journal's only producer, so the switch is made
+ * there with a blocking call; once it returns the previous journal is no
+ * longer referenced and is destroyed here, off the receive path.
+ * 
+ * @param journal New journal, or nullptr to stop capturing
+ */
+void WebSocketClient::setJournal(std::unique_ptr<CaptureJournal> journal)
+{
+    std::lock_guard<std::mutex> lock(m_captureMutex);
+    CaptureJournal* active = journal.get();
+    QMetaObject::invokeMethod(m_webSocket, [this, active]() { m_activeJournal = active; },
+                              Qt::BlockingQueuedConnection);
+    std::swap(m_journal, journal);
 }
 
 /**
@@ -123,30 +260,157 @@ void WebSocketClient::onDisconnected()
  */
 void WebSocketClient::onError(QAbstractSocket::SocketError error)
 {
+    Q_UNUSED(error);
     QString errorMessage = m_webSocket->errorString();
     qDebug() << "WebSocket error:" << errorMessage;
     emit this->error(errorMessage);
 }
 
 /**
- * @brief Processes incoming WebSocket text messages
+ * @brief Encodes an incoming text message into the ring
  * 
- * Parses received JSON messages and forwards them to the registered callback.
- * Emits error signal if message parsing fails.
+ * QWebSocket has already decoded the wire bytes to UTF-16; they are encoded
+ * back to UTF-8 directly into the string held by the next free slot. Once
+ * the ring has cycled this reuses existing capacity, so a text frame costs
+ * one encode and no allocation, instead of the temporary QByteArray and
+ * std::string that toStdString() builds.
  * 
  * @param message Received text message
  */
 void WebSocketClient::onTextMessageReceived(const QString &message)
 {
-    try {
-        auto json = nlohmann::json::parse(message.toStdString());
-        if (m_messageCallback) {
-            m_messageCallback(json);
+    RawFrame* slot = beginFrame(wallClockNanoseconds());
+    if (!slot) {
+        return;
+    }
+    slot->isBinary = false;
+    slot->binary.clear();
+    slot->text.resize(static_cast<size_t>(m_encoder.requiredSpace(message.size())));
+    char* end = m_encoder.appendToBuffer(slot->text.data(), message);
+    slot->text.resize(static_cast<size_t>(end - slot->text.data()));
+    commitFrame(*slot, slot->text.size());
+}
+
+/**
+ * @brief Queues an incoming binary message without copying
+ * 
+ * Exchanges that send UTF-8 JSON in binary frames skip transcoding
+ * entirely: the slot shares the socket's QByteArray, and the callback's
+ * view points into it.
+ * 
+ * @param message Received binary message
+ */
+void WebSocketClient::onBinaryMessageReceived(const QByteArray &message)
+{
+    RawFrame* slot = beginFrame(wallClockNanoseconds());
+    if (!slot) {
+        return;
+    }
+    slot->isBinary = true;
+    slot->binary = message;
+    commitFrame(*slot, static_cast<size_t>(message.size()));
+}
+
+/**
+ * @brief Claims the next ring slot, counting the frame as received or dropped
+ * 
+ * @param receiveTimeNs Wall-clock receive time of the frame
+ * @return RawFrame* Slot to fill, or nullptr if the ring is full
+ */
+WebSocketClient::RawFrame* WebSocketClient::beginFrame(int64_t receiveTimeNs)
+{
+    m_framesReceived.fetch_add(1, std::memory_order_relaxed);
+
+    RawFrame* slot = m_ring.acquireSlot();
+    if (!slot) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    slot->receiveTimeNs = receiveTimeNs;
+    return slot;
+}
+
+/**
+ * @brief Publishes the slot claimed by beginFrame() and wakes the consumer if needed
+ * 
+ * The processing thread is only woken through the condition variable when
+ * it has announced that it is going to sleep. In capture mode the frame
+ * is copied to the journal first, while the slot still belongs to the
+ * I/O thread.
+ * 
+ * @param slot Slot returned by beginFrame(), now filled
+ * @param bytes Payload size, for the byte counter
+ */
+void WebSocketClient::commitFrame(RawFrame& slot, size_t bytes)
+{
+    m_bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+    if (m_activeJournal) {
+        m_activeJournal->append(slot.view(), slot.receiveTimeNs);
+    }
+    slot.enqueueTicks = steadyNanoseconds();
+    m_ring.publish();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t depth = m_ring.size();
+    if (depth > m_queueHighWater.load(std::memory_order_relaxed)) {
+        m_queueHighWater.store(depth, std::memory_order_relaxed);
+    }
+
+    if (m_consumerSleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wakeupMutex);
+        m_wakeup.notify_one();
+    }
+}
+
+/**
+ * @brief Processing thread loop: drains the ring into the frame callback
+ * 
+ * Polls briefly when the ring runs dry so that bursts are picked up without
+ * a context switch, then sleeps on the condition variable. The sleeping flag
+ * is set before the final emptiness check and the producer reads it after
+ * publishing, each behind a full fence, so a wakeup cannot be missed.
+ * Frames whose callback throws are counted and skipped.
+ */
+void WebSocketClient::runProcessing()
+{
+    int idlePolls = 0;
+    for (;;) {
+        RawFrame* frame = m_ring.front();
+        if (!frame) {
+            if (++idlePolls < SPIN_POLLS) {
+                std::this_thread::yield();
+                continue;
+            }
+            idlePolls = 0;
+
+            std::unique_lock<std::mutex> lock(m_wakeupMutex);
+            m_consumerSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_wakeup.wait(lock, [this]() { return !m_ring.empty() || m_stopping; });
+            m_consumerSleeping.store(false, std::memory_order_relaxed);
+            if (m_ring.empty()) {
+                return;
+            }
+            continue;
+        }
+
+        int64_t handoffNs = steadyNanoseconds() - frame->enqueueTicks;
+        m_handoffTotalNs.fetch_add(handoffNs, std::memory_order_relaxed);
+        if (handoffNs > m_handoffMaxNs.load(std::memory_order_relaxed)) {
+            m_handoffMaxNs.store(handoffNs, std::memory_order_relaxed);
+        }
+
+        try {
+            if (m_frameCallback) {
+                m_frameCallback(frame->view(), frame->receiveTimeNs);
+            }
+            m_framesProcessed.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            m_framesFailed.fetch_add(1, std::memory_order_relaxed);
+            qDebug() << "Error processing WebSocket frame:" << e.what();
         }
-    } catch (const std::exception& e) {
-        qDebug() << "Error parsing WebSocket message:" << e.what();
-        emit error(QString("Error parsing message: %1").arg(e.what()));
+        m_ring.pop();
     }
 }
 
-} // namespace GoQuant 
\ No newline at end of file
+} // namespace GoQuant
@@ -13,13 +13,24 @@
 
 #include "core/OrderBookProcessor.h"
 #include "core/FeeCalculator.h"
+#include "core/BacktestRunner.h"
+#include "core/BookStore.h"
+#include "core/JournalReader.h"
+#include "core/ReplayEngine.h"
+#include "models/ImpactCalibrator.h"
 #include "models/RegressionModels.h"
 #include "utils/PerformanceMonitor.h"
+#include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
 #include <QTimer>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include <chrono>
+#include <utility>
 
 using namespace GoQuant;
 
@@ -52,6 +63,277 @@ void simulateOrderBook(OrderBookProcessor& processor) {
     processor.processOrderBook(orderBookData);
 }
 
+/**
+ * @brief Prints one row of the replay latency table
+ * 
+ * @param stage Stage name
+ * @param histogram Latencies of the stage in nanoseconds
+ */
+void printLatencyRow(const char* stage, const LatencyHistogram& histogram) {
+    std::cout << "  " << std::left << std::setw(10) << stage << std::right
+              << std::setw(12) << histogram.count()
+              << std::setw(10) << histogram.percentile(50.0)
+              << std::setw(10) << histogram.percentile(99.0)
+              << std::setw(10) << histogram.percentile(99.9)
+              << std::setw(12) << histogram.max() << std::endl;
+}
+
+/**
+ * @brief Resolves an --instrument value
+ * 
+ * @param text EXCHANGE:SYMBOL, or empty for none
+ * @param instrument Receives the registry ID; UNKNOWN_INSTRUMENT if @p text is empty
+ * @return bool False, after printing an error, if @p text is malformed
+ */
+bool parseInstrument(const QString& text, InstrumentId& instrument) {
+    instrument = UNKNOWN_INSTRUMENT;
+    if (text.isEmpty()) {
+        return true;
+    }
+    auto separator = text.indexOf(':');
+    if (separator <= 0) {
+        std::cerr << "Invalid --instrument, expected EXCHANGE:SYMBOL: "
+                  << text.toStdString() << std::endl;
+        return false;
+    }
+    instrument = InstrumentRegistry::instance().intern(
+        text.left(separator).toStdString(), text.mid(separator + 1).toStdString());
+    return true;
+}
+
+/**
+ * @brief Replays captured journals into an OrderBookProcessor and prints a report
+ * 
+ * @param path Journal file or directory of journal files
+ * @param pace "fast", "original" or a speed factor such as "10"
+ * @param instrument EXCHANGE:SYMBOL to replay; empty for the first in the journal
+ * @param storePath Book store file receiving every replayed book; empty for none
+ * @return int Process exit code
+ */
+int runReplay(const QString& path, const QString& pace, const QString& instrument,
+              const QString& storePath) {
+    ReplayPacing pacing;
+    if (pace == "fast") {
+        pacing = ReplayPacing::asFastAsPossible();
+    } else if (pace == "original") {
+        pacing = ReplayPacing::original();
+    } else {
+        bool ok = false;
+        double speed = pace.toDouble(&ok);
+        if (!ok || speed <= 0.0) {
+            std::cerr << "Invalid --pace: " << pace.toStdString() << std::endl;
+            return 1;
+        }
+        pacing = ReplayPacing::scaled(speed);
+    }
+
+    OrderBookProcessor processor;
+    ReplayEngine engine(processor);
+    engine.setPacing(pacing);
+    InstrumentId instrumentId = UNKNOWN_INSTRUMENT;
+    if (!parseInstrument(instrument, instrumentId)) {
+        return 1;
+    }
+    engine.setInstrument(instrumentId);
+
+    QStringList files = JournalReader::listFiles(path);
+    if (files.isEmpty()) {
+        std::cerr << "No capture journals in " << path.toStdString() << std::endl;
+        return 1;
+    }
+
+    ReplayStats stats;
+    std::unique_ptr<BookStoreWriter> store;
+    try {
+        if (!storePath.isEmpty()) {
+            store = std::make_unique<BookStoreWriter>(storePath);
+            BookStoreWriter* writer = store.get();
+            engine.setBookCallback([writer](const OrderBook& book) { writer->append(book); });
+        }
+        stats = engine.run(files);
+        if (store) {
+            store->close();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const InstrumentRegistry& registry = InstrumentRegistry::instance();
+    std::cout << "Replayed " << stats.framesReplayed << " frames of "
+              << registry.exchange(stats.instrument) << " " << registry.symbol(stats.instrument)
+              << " from " << stats.files << " file(s) in " << stats.elapsedSeconds << " s"
+              << std::endl;
+    std::cout << "  " << stats.framesFailed << " failed, " << stats.framesSkipped
+              << " skipped" << std::endl;
+    std::cout << "  " << std::fixed << std::setprecision(0) << stats.messagesPerSecond
+              << " msg/s, " << std::setprecision(1) << stats.megabytesPerSecond << " MB/s"
+              << std::endl;
+    std::cout << std::endl << "  " << std::left << std::setw(10) << "stage (ns)" << std::right
+              << std::setw(12) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(12) << "max" << std::endl;
+    printLatencyRow("parse", stats.stages.parse);
+    printLatencyRow("apply", stats.stages.apply);
+    printLatencyRow("record", stats.stages.record);
+    printLatencyRow("publish", stats.stages.publish);
+    printLatencyRow("total", stats.frameLatency);
+    if (pacing.mode != ReplayPacing::Mode::AsFastAsPossible) {
+        printLatencyRow("lag", stats.scheduleLag);
+    }
+    if (store) {
+        std::cout << std::endl << "Stored " << store->rowCount() << " books in "
+                  << storePath.toStdString() << " (" << store->bytesWritten() << " bytes)"
+                  << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief Loads the fee schedule named by --fees
+ * 
+ * Without --fees, fee_schedules.json next to the executable is used if
+ * present, and the built-in OKX spot tiers otherwise.
+ * 
+ * @param path Value of --fees; empty for the default
+ * @return std::shared_ptr<const FeeSchedule> The schedule, or null after
+ *         printing an error
+ */
+std::shared_ptr<const FeeSchedule> loadFeeSchedule(QString path) {
+    if (path.isEmpty()) {
+        path = QCoreApplication::applicationDirPath() + "/fee_schedules.json";
+        if (!QFile::exists(path)) {
+            return FeeSchedule::builtIn();
+        }
+    }
+    try {
+        return std::make_shared<const FeeSchedule>(FeeSchedule::loadFile(path));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Backtests execution costs over captured journals and prints a report
+ * 
+ * @param path Journal file or directory of journal files
+ * @param instrument EXCHANGE:SYMBOL to backtest; empty for every instrument
+ * @param threads Worker thread count; "0" for one per hardware thread
+ * @param quantity Simulated order size in base currency
+ * @param volume 30-day trading volume in USD
+ * @param trackVolume True to let simulated fills move the fee tier
+ * @param feeSchedule Fee tiers to charge
+ * @return int Process exit code
+ */
+int runBacktest(const QString& path, const QString& instrument, const QString& threads,
+                const QString& quantity, const QString& volume, bool trackVolume,
+                std::shared_ptr<const FeeSchedule> feeSchedule) {
+    BacktestConfig config;
+    config.feeSchedule = std::move(feeSchedule);
+    config.trackVolume = trackVolume;
+    if (!parseInstrument(instrument, config.instrument)) {
+        return 1;
+    }
+    bool threadsOk = false;
+    bool quantityOk = false;
+    bool volumeOk = false;
+    config.threadCount = threads.toUInt(&threadsOk);
+    config.orderQuantity = quantity.toDouble(&quantityOk);
+    config.tradingVolume = volume.toDouble(&volumeOk);
+    if (!threadsOk || !quantityOk || !volumeOk) {
+        std::cerr << "Invalid --threads, --quantity or --volume" << std::endl;
+        return 1;
+    }
+
+    QStringList files = JournalReader::listFiles(path);
+    if (files.isEmpty()) {
+        std::cerr << "No capture journals in " << path.toStdString() << std::endl;
+        return 1;
+    }
+
+    BacktestReport report;
+    try {
+        BacktestRunner runner(config);
+        report = runner.run(files);
+    } catch (const std::exception& e) {
+        std::cerr << "Backtest failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const InstrumentRegistry& registry = InstrumentRegistry::instance();
+    const FeeSchedule& schedule = *config.feeSchedule;
+    FeeScheduleId scheduleId = schedule.find(config.feeExchange, config.feeProduct);
+    std::cout << "Backtested " << report.runs.size() << " instrument-days from " << files.size()
+              << " file(s) on " << report.threads << " thread(s): " << report.frames
+              << " frames (plus " << report.warmupFrames << " warm-up) in " << report.elapsedSeconds << " s ("
+              << static_cast<long>(report.framesPerSecond) << " frames/s)" << std::endl;
+    std::cout << std::endl << "  " << std::left << std::setw(28) << "instrument"
+              << std::setw(12) << "day" << std::right << std::setw(10) << "frames"
+              << std::setw(10) << "samples" << std::setw(14) << "slippage bps"
+              << std::setw(10) << "tier" << std::setw(12) << "fee" << std::setw(12) << "total"
+              << std::endl;
+    for (const BacktestRunResult& run : report.runs) {
+        std::string name = registry.exchange(run.instrument) + ":" + registry.symbol(run.instrument);
+        QString day = QDateTime::fromMSecsSinceEpoch(run.day * 86400000LL, Qt::UTC)
+                          .toString("yyyy-MM-dd");
+        std::cout << "  " << std::left << std::setw(28) << name << std::setw(12)
+                  << day.toStdString() << std::right;
+        if (!run.error.empty()) {
+            std::cout << "  failed: " << run.error << std::endl;
+            continue;
+        }
+        std::cout << std::setw(10) << run.frames << std::setw(10) << run.costs.samples
+                  << std::setw(14) << run.costs.slippage.mean() * 1e4
+                  << std::setw(10) << schedule.tierName(scheduleId, run.feeTier)
+                  << std::setw(12) << run.costs.fees.mean()
+                  << std::setw(12) << run.costs.totalCost.mean() << std::endl;
+    }
+    std::cout << "  " << std::left << std::setw(40) << "all" << std::right
+              << std::setw(10) << report.frames << std::setw(10) << report.total.samples
+              << std::setw(14) << report.total.slippage.mean() * 1e4
+              << std::setw(10) << "" << std::setw(12) << report.total.fees.mean()
+              << std::setw(12) << report.total.totalCost.mean() << std::endl;
+    return report.failedRuns == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Calibrates Almgren-Chriss parameters on a book store and prints them
+ * 
+ * @param path Book store file, as written by --replay --store
+ * @param threads Worker thread count; "0" for one per hardware thread
+ * @return int Process exit code
+ */
+int runCalibration(const QString& path, const QString& threads) {
+    CalibrationConfig config;
+    bool threadsOk = false;
+    config.threadCount = threads.toUInt(&threadsOk);
+    if (!threadsOk) {
+        std::cerr << "Invalid --threads" << std::endl;
+        return 1;
+    }
+
+    ImpactCalibration result;
+    try {
+        result = ImpactCalibrator(config).calibrate(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Calibration failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Calibrated on " << result.books << " books (" << result.sweeps << " sweeps, "
+              << result.returns << " one-minute returns) in " << result.elapsedSeconds
+              << " s on " << result.threads << " thread(s)" << std::endl;
+    std::cout << "  volatility:       " << result.parameters.volatility << " per sqrt(day) ("
+              << result.relativeVolatility * 100 << "% of " << result.referencePrice << ")"
+              << std::endl;
+    std::cout << "  temporary impact: " << result.parameters.temporaryImpact
+              << " (R2 " << result.temporaryRSquared << ", spread cost "
+              << result.spreadCost << ")" << std::endl;
+    std::cout << "  permanent impact: " << result.parameters.permanentImpact
+              << " (R2 " << result.permanentRSquared << ")" << std::endl;
+    return 0;
+}
+
 /**
  * @brief Main entry point for the trading system
  * 
@@ -62,6 +344,8 @@ void simulateOrderBook(OrderBookProcessor& processor) {
  * - Regression models for market analysis
  * 
  * Sets up a timer-based update loop that processes market data every second.
+ * With --replay, replays captured journals through the processor instead
+ * and exits after printing throughput and latency.
  * 
  * @param argc Command line argument count
  * @param argv Command line argument values
@@ -70,32 +354,82 @@ void simulateOrderBook(OrderBookProcessor& processor) {
 int main(int argc, char *argv[]) {
     QCoreApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("GoQuant trade simulator");
+    parser.addHelpOption();
+    QCommandLineOption replayOption("replay",
+        "Replay a capture journal file or directory and exit.", "path");
+    QCommandLineOption paceOption("pace",
+        "Replay pacing: fast, original, or a speed factor such as 10.", "pace", "fast");
+    QCommandLineOption instrumentOption("instrument",
+        "Instrument as EXCHANGE:SYMBOL; replay defaults to the first in the journal, "
+        "backtest to all.",
+        "instrument");
+    QCommandLineOption storeOption("store",
+        "With --replay, write every replayed book to this columnar book store.", "file");
+    QCommandLineOption backtestOption("backtest",
+        "Backtest execution costs over a capture journal file or directory and exit.", "path");
+    QCommandLineOption calibrateOption("calibrate",
+        "Fit Almgren-Chriss impact and volatility to a book store and exit.", "file");
+    QCommandLineOption threadsOption("threads",
+        "Backtest and calibration worker threads; 0 for one per hardware thread.", "count", "0");
+    QCommandLineOption quantityOption("quantity",
+        "Backtest order size in base currency.", "quantity", "1");
+    QCommandLineOption volumeOption("volume",
+        "Backtest 30-day trading volume in USD, selecting the fee tier.", "usd", "0");
+    QCommandLineOption trackVolumeOption("track-volume",
+        "Let backtest fills move the fee tier over a rolling 30-day window, "
+        "starting from --volume.");
+    QCommandLineOption feesOption("fees",
+        "Fee schedule configuration; defaults to fee_schedules.json next to the executable.",
+        "file");
+    parser.addOption(replayOption);
+    parser.addOption(paceOption);
+    parser.addOption(instrumentOption);
+    parser.addOption(storeOption);
+    parser.addOption(backtestOption);
+    parser.addOption(calibrateOption);
+    parser.addOption(threadsOption);
+    parser.addOption(quantityOption);
+    parser.addOption(volumeOption);
+    parser.addOption(trackVolumeOption);
+    parser.addOption(feesOption);
+    parser.process(app);
+
+    if (parser.isSet(replayOption)) {
+        return runReplay(parser.value(replayOption), parser.value(paceOption),
+                         parser.value(instrumentOption), parser.value(storeOption));
+    }
+    if (parser.isSet(calibrateOption)) {
+        return runCalibration(parser.value(calibrateOption), parser.value(threadsOption));
+    }
+    std::shared_ptr<const FeeSchedule> feeSchedule = loadFeeSchedule(parser.value(feesOption));
+    if (!feeSchedule) {
+        return 1;
+    }
+    if (parser.isSet(backtestOption)) {
+        return runBacktest(parser.value(backtestOption), parser.value(instrumentOption),
+                           parser.value(threadsOption), parser.value(quantityOption),
+                           parser.value(volumeOption), parser.isSet(trackVolumeOption), feeSchedule);
+    }
+
     // Create instances
     OrderBookProcessor orderBookProcessor;
-    FeeCalculator feeCalculator;
+    FeeCalculator feeCalculator(feeSchedule);
     PerformanceMonitor performanceMonitor;
     RegressionModels::SlippageEstimator slippageEstimator;
     RegressionModels::MakerTakerPredictor makerTakerPredictor;
 
-    // Connect signals
-    QObject::connect(&orderBookProcessor, &OrderBookProcessor::orderBookUpdated,
-        [](const OrderBook& book) {
-            std::cout << "Order book updated for " << book.symbol << std::endl;
-        });
-
-    QObject::connect(&orderBookProcessor, &OrderBookProcessor::marketImpactUpdated,
-        [](double impact) {
-            std::cout << "Market impact: " << impact * 100 << "%" << std::endl;
-        });
-
-    QObject::connect(&orderBookProcessor, &OrderBookProcessor::slippageUpdated,
-        [](double slippage) {
-            std::cout << "Slippage: " << slippage * 100 << "%" << std::endl;
-        });
-
-    QObject::connect(&orderBookProcessor, &OrderBookProcessor::makerTakerProportionUpdated,
-        [](double proportion) {
-            std::cout << "Maker/Taker proportion: " << proportion * 100 << "%" << std::endl;
+    // Subscribe to consolidated analytics updates
+    AnalyticsSubscription* analytics = orderBookProcessor.subscribeAnalytics();
+    QObject::connect(analytics, &AnalyticsSubscription::analyticsUpdated,
+        [](const BookAnalytics& update) {
+            std::cout << "Order book updated for " << update.snapshot.book().symbol()
+                      << " (version " << update.version << ")" << std::endl;
+            std::cout << "Market impact: " << update.marketImpact * 100 << "%" << std::endl;
+            std::cout << "Slippage: " << update.slippage * 100 << "%" << std::endl;
+            std::cout << "Maker/Taker proportion: " << update.makerTakerProportion * 100
+                      << "%" << std::endl;
         });
 
     // Set up periodic updates
@@ -112,9 +446,9 @@ int main(int argc, char *argv[]) {
         std::cout << "  Taker fee: " << takerFee << " BTC" << std::endl;
 
         // Record performance metrics
+        BookSnapshot snapshot = orderBookProcessor.acquireSnapshot();
         performanceMonitor.recordMetric("order_book_depth", 
-            orderBookProcessor.getLatestOrderBook().asks.size() + 
-            orderBookProcessor.getLatestOrderBook().bids.size());
+            snapshot.book().asks.size() + snapshot.book().bids.size());
         performanceMonitor.recordLatency("order_book_update", 50.0); // Simulated latency
     });
 
@@ -1,4 +1,5 @@
 #include "models/AlmgrenChriss.h"
+#include "models/TrajectoryEngine.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -7,6 +8,10 @@ namespace GoQuant {
 AlmgrenChriss::AlmgrenChriss(const Parameters& params)
     : m_params(params)
 {
+    validate(params);
+}
+
+void AlmgrenChriss::validate(const Parameters& params) {
     if (params.volatility <= 0 || params.permanentImpact <= 0 || 
         params.temporaryImpact <= 0 || params.riskAversion <= 0 || 
         params.timeHorizon <= 0) {
@@ -19,23 +24,13 @@ std::vector<double> AlmgrenChriss::calculateOptimalTrajectory(
     double targetPosition,
     int numSteps
 ) const {
-    if (numSteps <= 0) {
-        throw std::invalid_argument("Number of steps must be positive");
-    }
-
-    std::vector<double> trajectory(numSteps);
-    double totalPosition = initialPosition - targetPosition;
-    double timeStep = m_params.timeHorizon / numSteps;
-
-    // Calculate optimal trading rate
-    double kappa = std::sqrt(m_params.riskAversion * m_params.volatility * m_params.volatility / 
-                           (2 * m_params.temporaryImpact));
-    
-    for (int i = 0; i < numSteps; ++i) {
-        double t = i * timeStep;
-        trajectory[i] = totalPosition * std::exp(-kappa * t);
-    }
+    // x_j = target + (initial - target) sinh(kappa (T - t_j)) / sinh(kappa T)
+    std::shared_ptr<const TrajectoryProfile> profile =
+        TrajectoryEngine::computeProfile(m_params, numSteps);
 
+    std::vector<double> trajectory(profile->holdings.size());
+    TrajectoryEngine::fillSchedule(*profile, initialPosition, targetPosition,
+                                   trajectory.data(), nullptr);
     return trajectory;
 }
 
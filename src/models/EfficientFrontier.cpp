@@ -0,0 +1,129 @@
+/**
+ * @file EfficientFrontier.cpp
+ * @brief Implementation of the EfficientFrontier class
+ *
+ * This file contains the grid validation, the split of a sweep into pool
+ * tasks and the evaluation of each block of points.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "models/EfficientFrontier.h"
+#include "core/Timestamp.h"
+#include "models/TrajectoryEngine.h"
+#include "utils/WorkStealingPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace GoQuant {
+
+namespace {
+
+/// Risk aversions evaluated per task; enough to amortize queueing
+constexpr std::size_t BLOCK_SIZE = 16;
+
+/// Throws unless @p values is non-empty and positive
+void checkGrid(const std::vector<double>& values, const char* name) {
+    if (values.empty()) {
+        throw std::invalid_argument(std::string("Frontier grid has no ") + name);
+    }
+    for (double value : values) {
+        if (!(value > 0.0)) {
+            throw std::invalid_argument(std::string("Frontier ") + name + " must be positive");
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Starts the worker threads
+ *
+ * @param threadCount Number of workers; 0 for one per hardware thread
+ */
+EfficientFrontier::EfficientFrontier(std::size_t threadCount)
+    : m_pool(std::make_unique<WorkStealingPool>(threadCount))
+{
+}
+
+/**
+ * @brief Joins the worker threads
+ */
+EfficientFrontier::~EfficientFrontier() = default;
+
+/**
+ * @brief Evaluates every point of a grid
+ *
+ * The grid is checked before any task is queued. A combination the model
+ * rejects, such as a permanent impact too large for a horizon's step,
+ * fails its task and is rethrown once the sweep has finished.
+ *
+ * @param grid Parameter grids
+ * @return FrontierResult Expected shortfall and variance per point
+ * @throws std::invalid_argument if the grid or a combination is invalid
+ */
+FrontierResult EfficientFrontier::compute(const FrontierGrid& grid) {
+    int64_t startNs = steadyNanoseconds();
+    checkGrid(grid.riskAversions, "risk aversions");
+    checkGrid(grid.timeHorizons, "time horizons");
+    checkGrid(grid.orderSizes, "order sizes");
+    if (grid.numSteps <= 0) {
+        throw std::invalid_argument("Number of steps must be positive");
+    }
+    AlmgrenChriss::Parameters first = grid.model;
+    first.riskAversion = grid.riskAversions.front();
+    first.timeHorizon = grid.timeHorizons.front();
+    AlmgrenChriss::validate(first);
+
+    FrontierResult result;
+    result.horizonCount = grid.timeHorizons.size();
+    result.sizeCount = grid.orderSizes.size();
+    result.riskAversionCount = grid.riskAversions.size();
+    result.threads = m_pool->threadCount();
+    result.points.resize(result.horizonCount * result.sizeCount * result.riskAversionCount);
+
+    for (std::size_t horizon = 0; horizon < result.horizonCount; ++horizon) {
+        for (std::size_t begin = 0; begin < result.riskAversionCount; begin += BLOCK_SIZE) {
+            std::size_t end = std::min(begin + BLOCK_SIZE, result.riskAversionCount);
+            m_pool->submit([&grid, &result, horizon, begin, end]() {
+                AlmgrenChriss::Parameters params = grid.model;
+                params.timeHorizon = grid.timeHorizons[horizon];
+                for (std::size_t risk = begin; risk < end; ++risk) {
+                    params.riskAversion = grid.riskAversions[risk];
+                    std::shared_ptr<const TrajectoryProfile> profile =
+                        TrajectoryEngine::computeProfile(params, grid.numSteps);
+
+                    for (std::size_t size = 0; size < result.sizeCount; ++size) {
+                        double quantity = grid.orderSizes[size];
+                        FrontierPoint& point =
+                            result.points[(horizon * result.sizeCount + size) *
+                                          result.riskAversionCount + risk];
+                        point.riskAversion = params.riskAversion;
+                        point.timeHorizon = params.timeHorizon;
+                        point.orderSize = quantity;
+                        point.kappa = profile->kappa;
+                        point.expectedCost = profile->costFactor * quantity * quantity;
+                        point.variance = profile->varianceFactor * quantity * quantity;
+                    }
+                }
+            });
+        }
+    }
+    m_pool->wait();
+
+    result.elapsedSeconds = (steadyNanoseconds() - startNs) * 1e-9;
+    return result;
+}
+
+/**
+ * @brief Number of worker threads
+ */
+std::size_t EfficientFrontier::threadCount() const {
+    return m_pool->threadCount();
+}
+
+} // namespace GoQuant
@@ -0,0 +1,371 @@
+/**
+ * @file ImpactCalibrator.cpp
+ * @brief Implementation of the ImpactCalibrator class
+ *
+ * This file contains the per-block sweep, order flow and return statistics,
+ * their merge in file order and the conversion of the fits into
+ * Almgren-Chriss parameters.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "models/ImpactCalibrator.h"
+#include "core/BookStore.h"
+#include "core/DepthSweep.h"
+#include "core/Timestamp.h"
+#include "utils/RunningStatistic.h"
+#include "utils/WorkStealingPool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace GoQuant {
+
+namespace {
+
+/// @p timeNs divided by @p intervalNs, rounding down
+int64_t floorDivide(int64_t timeNs, int64_t intervalNs) {
+    int64_t quotient = timeNs / intervalNs;
+    return timeNs % intervalNs < 0 ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief Least-squares line through (x, y) points
+ *
+ * Keeps means and centered co-moments, updated and merged the way
+ * RunningStatistic is, so partial fits of blocks combine exactly enough to
+ * be independent of how the points were split.
+ */
+class LinearFit {
+public:
+    void add(double x, double y) {
+        ++m_count;
+        double dx = x - m_meanX;
+        double dy = y - m_meanY;
+        m_meanX += dx / static_cast<double>(m_count);
+        m_meanY += dy / static_cast<double>(m_count);
+        m_sxx += dx * (x - m_meanX);
+        m_syy += dy * (y - m_meanY);
+        m_sxy += dx * (y - m_meanY);
+    }
+
+    void merge(const LinearFit& other) {
+        if (other.m_count == 0) {
+            return;
+        }
+        if (m_count == 0) {
+            *this = other;
+            return;
+        }
+        double count = static_cast<double>(m_count);
+        double otherCount = static_cast<double>(other.m_count);
+        double total = count + otherCount;
+        double dx = other.m_meanX - m_meanX;
+        double dy = other.m_meanY - m_meanY;
+        double weight = count * otherCount / total;
+        m_sxx += other.m_sxx + dx * dx * weight;
+        m_syy += other.m_syy + dy * dy * weight;
+        m_sxy += other.m_sxy + dx * dy * weight;
+        m_meanX += dx * otherCount / total;
+        m_meanY += dy * otherCount / total;
+        m_count += other.m_count;
+    }
+
+    uint64_t count() const { return m_count; }
+
+    double slope() const { return m_sxx > 0.0 ? m_sxy / m_sxx : 0.0; }
+
+    double intercept() const { return m_meanY - slope() * m_meanX; }
+
+    double rSquared() const {
+        return m_sxx > 0.0 && m_syy > 0.0 ? m_sxy * m_sxy / (m_sxx * m_syy) : 0.0;
+    }
+
+private:
+    uint64_t m_count = 0;
+    double m_meanX = 0.0;
+    double m_meanY = 0.0;
+    double m_sxx = 0.0;  ///< Sum of squared x deviations
+    double m_syy = 0.0;  ///< Sum of squared y deviations
+    double m_sxy = 0.0;  ///< Sum of products of x and y deviations
+};
+
+/**
+ * @brief Best levels of a book
+ */
+struct Touch {
+    Ticks bidTicks = 0;      ///< Best bid price
+    Ticks askTicks = 0;      ///< Best ask price
+    double bidSize = 0.0;    ///< Quantity at the best bid, base currency
+    double askSize = 0.0;    ///< Quantity at the best ask, base currency
+};
+
+/// Best levels of a two-sided @p book
+Touch touchOf(const OrderBook& book) {
+    return {book.bids.front().priceTicks, book.asks.front().priceTicks,
+            book.quantity(book.bids.front()), book.quantity(book.asks.front())};
+}
+
+/**
+ * @brief Order flow imbalance between two consecutive books
+ *
+ * Quantity added at or above the previous best bid counts as buying
+ * pressure, quantity removed from it as selling pressure, and the reverse
+ * on the ask.
+ */
+double orderFlow(const Touch& previous, const Touch& current) {
+    double flow = 0.0;
+    if (current.bidTicks >= previous.bidTicks) {
+        flow += current.bidSize;
+    }
+    if (current.bidTicks <= previous.bidTicks) {
+        flow -= previous.bidSize;
+    }
+    if (current.askTicks <= previous.askTicks) {
+        flow -= current.askSize;
+    }
+    if (current.askTicks >= previous.askTicks) {
+        flow += previous.askSize;
+    }
+    return flow;
+}
+
+/**
+ * @brief Books of one return bucket
+ */
+struct Bucket {
+    int64_t index;          ///< Exchange time divided by the bucket length
+    double flow;            ///< Order flow imbalance within the bucket
+    double closeMid;        ///< Mid of its last book
+    int64_t closeTimeNs;    ///< Exchange time of its last book
+};
+
+/**
+ * @brief Partial statistics of one block of the store
+ */
+struct BlockStats {
+    bool hasBooks = false;          ///< False if no two-sided book was in range
+    Touch first;                    ///< Best levels of the first book
+    Touch last;                     ///< Best levels of the last book
+    std::vector<Bucket> buckets;    ///< In time order; the first lacks the flow into the block
+    LinearFit concession;           ///< Sweep concession per unit against size
+    RunningStatistic mid;           ///< Mid prices
+    uint64_t books = 0;             ///< Two-sided books
+    uint64_t sweeps = 0;            ///< Fully filled probe sweeps
+};
+
+/**
+ * @brief Sweeps both sides of @p book at the probe sizes
+ *
+ * Probes are fractions of the thinner side, so every one of them fills and
+ * the fit spans the book's own depth whatever its instrument.
+ */
+void sweepBook(const OrderBook& book, const std::vector<double>& fractions,
+               BookSideArrays& asks, BookSideArrays& bids, std::vector<double>& probeLots,
+               std::vector<SweepResult>& results, BlockStats& stats) {
+    double askLots = 0.0;
+    double bidLots = 0.0;
+    for (const OrderBookLevel& level : book.asks) {
+        askLots += static_cast<double>(level.quantityLots);
+    }
+    for (const OrderBookLevel& level : book.bids) {
+        bidLots += static_cast<double>(level.quantityLots);
+    }
+    double thinner = std::min(askLots, bidLots);
+    for (std::size_t i = 0; i < fractions.size(); ++i) {
+        probeLots[i] = std::max(1.0, std::round(fractions[i] * thinner));
+    }
+
+    asks.assign(book.asks);
+    bids.assign(book.bids);
+    double midTicks = (static_cast<double>(book.asks.front().priceTicks) +
+                       static_cast<double>(book.bids.front().priceTicks)) / 2.0;
+    double priceIncrement = book.spec.price.increment();
+    double lotIncrement = book.spec.quantity.increment();
+
+    for (const BookSideArrays* side : {&asks, &bids}) {
+        sweepDepthSorted(*side, probeLots.data(), probeLots.size(), results.data());
+        for (std::size_t i = 0; i < probeLots.size(); ++i) {
+            const SweepResult& sweep = results[i];
+            if (sweep.filledLots < probeLots[i]) {
+                continue;
+            }
+            double concessionTicks = std::abs(sweep.notionalTicks / sweep.filledLots - midTicks);
+            stats.concession.add(sweep.filledLots * lotIncrement, concessionTicks * priceIncrement);
+            ++stats.sweeps;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a calibrator for @p config
+ *
+ * @param config Calibration settings
+ * @throws std::invalid_argument if the settings are invalid
+ */
+ImpactCalibrator::ImpactCalibrator(const CalibrationConfig& config)
+    : m_config(config)
+{
+    if (config.timeUnitNs <= 0 || config.tradeIntervalNs <= 0 || config.bucketNs <= 0) {
+        throw std::invalid_argument("Calibration intervals must be positive");
+    }
+    if (config.sampleEvery == 0) {
+        throw std::invalid_argument("Calibration sampling stride must be positive");
+    }
+    if (config.probeDepthFractions.empty()) {
+        throw std::invalid_argument("Calibration needs at least one probe size");
+    }
+    for (double fraction : config.probeDepthFractions) {
+        if (!(fraction > 0.0 && fraction <= 1.0)) {
+            throw std::invalid_argument("Probe depth fractions must be in (0, 1]");
+        }
+    }
+    // Sorted probes let one pass of the depth kernel answer them all
+    std::sort(m_config.probeDepthFractions.begin(), m_config.probeDepthFractions.end());
+}
+
+/**
+ * @brief Calibrates on an open book store
+ *
+ * One task per block collects partial statistics. The merge then runs in
+ * block order: it adds the order flow between the last book of a block and
+ * the first of the next, joins buckets split across blocks, and fits
+ * returns and flow over the joined buckets.
+ *
+ * @param store Reader of the recorded books
+ * @return ImpactCalibration Fitted parameters
+ * @throws std::runtime_error if the store is corrupt or holds too few books
+ */
+ImpactCalibration ImpactCalibrator::calibrate(const BookStoreReader& store) const {
+    int64_t startNs = steadyNanoseconds();
+    ImpactCalibration result;
+
+    std::vector<BlockStats> blocks(store.blockCount());
+    {
+        WorkStealingPool pool(m_config.threadCount);
+        result.threads = pool.threadCount();
+        for (std::size_t index = 0; index < blocks.size(); ++index) {
+            pool.submit([this, &store, &blocks, index]() {
+                BlockStats& stats = blocks[index];
+                const std::vector<double>& fractions = m_config.probeDepthFractions;
+                OrderBook book;
+                BookSideArrays asks;
+                BookSideArrays bids;
+                std::vector<double> probeLots(fractions.size());
+                std::vector<SweepResult> results(fractions.size());
+                Touch previous;
+                std::size_t sampled = 0;
+
+                store.scanBlock(index, m_config.fromNs, m_config.toNs, m_config.depth, book,
+                    [&](const OrderBook& current) {
+                        if (current.asks.empty() || current.bids.empty()) {
+                            return;
+                        }
+                        Touch touch = touchOf(current);
+                        double flow = stats.hasBooks ? orderFlow(previous, touch) : 0.0;
+                        if (!stats.hasBooks) {
+                            stats.first = touch;
+                            stats.hasBooks = true;
+                        }
+                        previous = touch;
+
+                        double mid = (current.price(current.asks.front()) +
+                                      current.price(current.bids.front())) / 2.0;
+                        ++stats.books;
+                        stats.mid.add(mid);
+
+                        int64_t bucket = floorDivide(current.exchangeTimeNs, m_config.bucketNs);
+                        if (stats.buckets.empty() || stats.buckets.back().index != bucket) {
+                            stats.buckets.push_back({bucket, 0.0, mid, current.exchangeTimeNs});
+                        }
+                        Bucket& last = stats.buckets.back();
+                        last.flow += flow;
+                        last.closeMid = mid;
+                        last.closeTimeNs = current.exchangeTimeNs;
+
+                        if (sampled++ % m_config.sampleEvery == 0) {
+                            sweepBook(current, fractions, asks, bids, probeLots, results, stats);
+                        }
+                    });
+                stats.last = previous;
+            });
+        }
+        pool.wait();
+    }
+
+    LinearFit concession;
+    RunningStatistic mid;
+    std::vector<Bucket> buckets;
+    bool havePrevious = false;
+    Touch previous;
+    for (BlockStats& stats : blocks) {
+        if (!stats.hasBooks) {
+            continue;
+        }
+        if (havePrevious) {
+            stats.buckets.front().flow += orderFlow(previous, stats.first);
+        }
+        for (const Bucket& bucket : stats.buckets) {
+            if (!buckets.empty() && buckets.back().index == bucket.index) {
+                buckets.back().flow += bucket.flow;
+                buckets.back().closeMid = bucket.closeMid;
+                buckets.back().closeTimeNs = bucket.closeTimeNs;
+            } else {
+                buckets.push_back(bucket);
+            }
+        }
+        concession.merge(stats.concession);
+        mid.merge(stats.mid);
+        result.books += stats.books;
+        result.sweeps += stats.sweeps;
+        previous = stats.last;
+        havePrevious = true;
+    }
+    if (buckets.size() < 2) {
+        throw std::runtime_error("Too few books to calibrate: need two buckets of two-sided books");
+    }
+
+    LinearFit flowFit;
+    double realizedVariance = 0.0;
+    for (std::size_t i = 1; i < buckets.size(); ++i) {
+        double logReturn = std::log(buckets[i].closeMid / buckets[i - 1].closeMid);
+        realizedVariance += logReturn * logReturn;
+        flowFit.add(buckets[i].flow, buckets[i].closeMid - buckets[i - 1].closeMid);
+    }
+    double spanUnits = static_cast<double>(buckets.back().closeTimeNs - buckets.front().closeTimeNs) /
+                       static_cast<double>(m_config.timeUnitNs);
+
+    result.returns = buckets.size() - 1;
+    result.referencePrice = mid.mean();
+    result.relativeVolatility = spanUnits > 0.0 ? std::sqrt(realizedVariance / spanUnits) : 0.0;
+    result.spreadCost = concession.intercept();
+    result.temporaryRSquared = concession.rSquared();
+    result.permanentRSquared = flowFit.rSquared();
+
+    result.parameters = m_config.model;
+    result.parameters.volatility = result.relativeVolatility * result.referencePrice;
+    result.parameters.permanentImpact = flowFit.slope();
+    result.parameters.temporaryImpact = concession.slope() *
+        static_cast<double>(m_config.tradeIntervalNs) / static_cast<double>(m_config.timeUnitNs);
+
+    result.elapsedSeconds = (steadyNanoseconds() - startNs) * 1e-9;
+    return result;
+}
+
+/**
+ * @brief Opens a book store and calibrates on it
+ *
+ * @param path Book store file
+ * @return ImpactCalibration Fitted parameters
+ * @throws std::runtime_error if the file is not a readable book store
+ */
+ImpactCalibration ImpactCalibrator::calibrate(const QString& path) const {
+    BookStoreReader store(path);
+    return calibrate(store);
+}
+
+} // namespace GoQuant
@@ -0,0 +1,212 @@
+/**
+ * @file TrajectoryEngine.cpp
+ * @brief Implementation of the TrajectoryEngine class
+ *
+ * This file contains the closed-form Almgren-Chriss profile, the scaling
+ * kernel that turns a profile into a schedule and the profile cache.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "models/TrajectoryEngine.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace GoQuant {
+
+/**
+ * @brief Constructs an engine with an empty cache
+ *
+ * @param cacheCapacity Profiles kept before the cache is emptied
+ */
+TrajectoryEngine::TrajectoryEngine(std::size_t cacheCapacity)
+    : m_capacity(cacheCapacity > 0 ? cacheCapacity : 1)
+{
+}
+
+/**
+ * @brief Computes the profile of a parameter set, without caching
+ *
+ * kappa tau is found as 2 asinh(kappa~ tau / 2), the same root as the
+ * acosh form but without its cancellation near zero. The sinh ratios are
+ * evaluated as exp(a - a0) expm1(-2a) / expm1(-2a0), which neither
+ * overflows for a large kappa T nor loses precision for a small one, and
+ * gives exactly 1 at the start and 0 at the horizon.
+ *
+ * @param params Model parameters; timeHorizon is T
+ * @param numSteps Trading intervals N
+ * @return std::shared_ptr<const TrajectoryProfile> The profile
+ * @throws std::invalid_argument if the parameters or step count are invalid
+ */
+std::shared_ptr<const TrajectoryProfile> TrajectoryEngine::computeProfile(
+    const AlmgrenChriss::Parameters& params, int numSteps) {
+    AlmgrenChriss::validate(params);
+    if (numSteps <= 0) {
+        throw std::invalid_argument("Number of steps must be positive");
+    }
+
+    auto profile = std::make_shared<TrajectoryProfile>();
+    profile->numSteps = numSteps;
+    profile->tau = params.timeHorizon / numSteps;
+    profile->adjustedImpact = params.temporaryImpact - 0.5 * params.permanentImpact * profile->tau;
+    if (profile->adjustedImpact <= 0.0) {
+        throw std::invalid_argument("Permanent impact too large for the step size");
+    }
+
+    double kappaTilde = std::sqrt(params.riskAversion * params.volatility * params.volatility /
+                                  profile->adjustedImpact);
+    double kappaTau = 2.0 * std::asinh(kappaTilde * profile->tau / 2.0);
+    profile->kappa = kappaTau / profile->tau;
+
+    profile->holdings.resize(static_cast<std::size_t>(numSteps) + 1);
+    double* holdings = profile->holdings.data();
+    if (kappaTau > 0.0) {
+        double start = kappaTau * numSteps;
+        double denominator = std::expm1(-2.0 * start);
+        for (int j = 0; j <= numSteps; ++j) {
+            double remaining = kappaTau * (numSteps - j);
+            holdings[j] = std::exp(remaining - start) * std::expm1(-2.0 * remaining) / denominator;
+        }
+    } else {
+        // kappa underflowed: no risk aversion left, so trade evenly
+        for (int j = 0; j <= numSteps; ++j) {
+            holdings[j] = static_cast<double>(numSteps - j) / numSteps;
+        }
+    }
+
+    profile->trades.resize(static_cast<std::size_t>(numSteps));
+    double tradeSquares = 0.0;
+    double holdingSquares = 0.0;
+    for (int j = 1; j <= numSteps; ++j) {
+        double trade = holdings[j - 1] - holdings[j];
+        profile->trades[j - 1] = trade;
+        tradeSquares += trade * trade;
+        holdingSquares += holdings[j] * holdings[j];
+    }
+
+    // E = gamma X^2 / 2 + (eta~ / tau) sum n_j^2,  V = sigma^2 tau sum x_j^2
+    profile->costFactor = 0.5 * params.permanentImpact +
+                          profile->adjustedImpact / profile->tau * tradeSquares;
+    profile->varianceFactor = params.volatility * params.volatility * profile->tau * holdingSquares;
+    return profile;
+}
+
+/**
+ * @brief Writes the schedule of one position from a profile
+ *
+ * Both loops are a single multiply-add over contiguous arrays and
+ * vectorize.
+ *
+ * @param profile Profile of the parameter set
+ * @param initialPosition Position at the start
+ * @param targetPosition Position at the horizon
+ * @param holdings Receives numSteps + 1 holdings; may be null
+ * @param trades Receives numSteps trades; may be null
+ */
+void TrajectoryEngine::fillSchedule(const TrajectoryProfile& profile, double initialPosition,
+                                    double targetPosition, double* holdings, double* trades) {
+    const double quantity = initialPosition - targetPosition;
+    const int steps = profile.numSteps;
+    if (holdings) {
+        const double* unit = profile.holdings.data();
+        for (int j = 0; j <= steps; ++j) {
+            holdings[j] = targetPosition + quantity * unit[j];
+        }
+    }
+    if (trades) {
+        const double* unit = profile.trades.data();
+        for (int j = 0; j < steps; ++j) {
+            trades[j] = quantity * unit[j];
+        }
+    }
+}
+
+/**
+ * @brief Returns the profile of a parameter set, computing it on a miss
+ *
+ * @param params Model parameters
+ * @param numSteps Trading intervals
+ * @return std::shared_ptr<const TrajectoryProfile> The cached profile
+ * @throws std::invalid_argument if the parameters or step count are invalid
+ */
+std::shared_ptr<const TrajectoryProfile> TrajectoryEngine::profile(
+    const AlmgrenChriss::Parameters& params, int numSteps) {
+    Key key = makeKey(params, numSteps);
+    auto it = m_cache.find(key);
+    if (it != m_cache.end()) {
+        ++m_hits;
+        return it->second;
+    }
+
+    ++m_misses;
+    std::shared_ptr<const TrajectoryProfile> computed = computeProfile(params, numSteps);
+    if (m_cache.size() >= m_capacity) {
+        m_cache.clear();
+    }
+    m_cache.emplace(key, computed);
+    return computed;
+}
+
+/**
+ * @brief Builds the optimal schedule from one position to another
+ *
+ * @param params Model parameters
+ * @param initialPosition Position at the start
+ * @param targetPosition Position at the horizon
+ * @param numSteps Trading intervals
+ * @return ExecutionSchedule Holdings, trades, expected cost and variance
+ * @throws std::invalid_argument if the parameters or step count are invalid
+ */
+ExecutionSchedule TrajectoryEngine::schedule(const AlmgrenChriss::Parameters& params,
+                                             double initialPosition, double targetPosition,
+                                             int numSteps) {
+    std::shared_ptr<const TrajectoryProfile> unit = profile(params, numSteps);
+
+    ExecutionSchedule result;
+    result.holdings.resize(unit->holdings.size());
+    result.trades.resize(unit->trades.size());
+    fillSchedule(*unit, initialPosition, targetPosition, result.holdings.data(),
+                 result.trades.data());
+
+    double quantity = initialPosition - targetPosition;
+    result.expectedCost = unit->costFactor * quantity * quantity;
+    result.variance = unit->varianceFactor * quantity * quantity;
+    return result;
+}
+
+/**
+ * @brief Compares two keys bit for bit
+ */
+bool TrajectoryEngine::Key::operator==(const Key& other) const {
+    return numSteps == other.numSteps && std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+}
+
+/**
+ * @brief Hashes a key, FNV-1a over its words
+ */
+std::size_t TrajectoryEngine::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint64_t word : key.bits) {
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    hash = (hash ^ static_cast<uint64_t>(key.numSteps)) * 1099511628211ULL;
+    return static_cast<std::size_t>(hash);
+}
+
+/**
+ * @brief Builds the cache key of a parameter set and step count
+ */
+TrajectoryEngine::Key TrajectoryEngine::makeKey(const AlmgrenChriss::Parameters& params,
+                                                int numSteps) {
+    const double values[5] = {params.volatility, params.permanentImpact, params.temporaryImpact,
+                              params.riskAversion, params.timeHorizon};
+    Key key;
+    std::memcpy(key.bits, values, sizeof(values));
+    key.numSteps = numSteps;
+    return key;
+}
+
+} // namespace GoQuant
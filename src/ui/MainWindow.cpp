@@ -14,8 +14,8 @@ namespace GoQuant {
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , m_webSocket(new WebSocketClient(this))
-    , m_orderBookProcessor(new OrderBookProcessor(this))
+    , m_webSocket(new WebSocketClient())
+    , m_orderBookProcessor(new OrderBookProcessor())
     , m_isConnected(false)
     , m_lastProcessingTime(0.0)
     , m_lastUiUpdateTime(0.0)
@@ -32,11 +32,25 @@ MainWindow::MainWindow(QWidget *parent)
     setupUi();
     setupConnections();
     startPerformanceMonitoring();
+
+    // Record the raw feed when a capture directory is configured
+    QString captureDirectory = qEnvironmentVariable("GOQUANT_CAPTURE_DIR");
+    if (!captureDirectory.isEmpty()) {
+        CaptureConfig capture;
+        capture.directory = captureDirectory;
+        try {
+            m_webSocket->startCapture(capture);
+        } catch (const std::exception& e) {
+            qWarning() << "Feed capture disabled:" << e.what();
+        }
+    }
 }
 
 MainWindow::~MainWindow()
 {
     stopPerformanceMonitoring();
+    // Joins the processing thread before the processor it feeds is destroyed
+    m_webSocket.reset();
 }
 
 void MainWindow::setupUi()
@@ -50,11 +64,9 @@ void MainWindow::setupUi()
     setCentralWidget(centralWidget);
 
     // Create input panel
-    createInputPanel();
     mainLayout->addWidget(createInputPanel());
 
     // Create output panel
-    createOutputPanel();
     mainLayout->addWidget(createOutputPanel());
 
     // Create status bar
@@ -179,21 +191,24 @@ void MainWindow::createStatusBar()
 
 void MainWindow::setupConnections()
 {
-    connect(m_webSocket, &WebSocketClient::connected, this, &MainWindow::onWebSocketConnected);
-    connect(m_webSocket, &WebSocketClient::disconnected, this, &MainWindow::onWebSocketDisconnected);
-    connect(m_webSocket, &WebSocketClient::error, this, &MainWindow::onWebSocketError);
-
-    connect(m_orderBookProcessor, &OrderBookProcessor::orderBookUpdated,
-            this, &MainWindow::onOrderBookUpdated);
-    connect(m_orderBookProcessor, &OrderBookProcessor::marketImpactUpdated,
-            this, &MainWindow::onMarketImpactUpdated);
-    connect(m_orderBookProcessor, &OrderBookProcessor::slippageUpdated,
-            this, &MainWindow::onSlippageUpdated);
-    connect(m_orderBookProcessor, &OrderBookProcessor::makerTakerProportionUpdated,
-            this, &MainWindow::onMakerTakerProportionUpdated);
-
-    m_webSocket->setMessageCallback([this](const nlohmann::json& data) {
-        processOrderBookData(data);
+    connect(m_webSocket.get(), &WebSocketClient::connected, this, &MainWindow::onWebSocketConnected);
+    connect(m_webSocket.get(), &WebSocketClient::disconnected, this, &MainWindow::onWebSocketDisconnected);
+    connect(m_webSocket.get(), &WebSocketClient::error, this, &MainWindow::onWebSocketError);
+
+    // The UI only needs to refresh at display rate, and only ever the latest book
+    AnalyticsSubscription* analytics =
+        m_orderBookProcessor->subscribeAnalytics(30.0, ConflationPolicy::latestOnly());
+    connect(analytics, &AnalyticsSubscription::analyticsUpdated,
+            this, &MainWindow::onAnalyticsUpdated);
+
+    // A sequence gap or checksum mismatch is repaired by a fresh snapshot,
+    // which the gateway sends on every new connection
+    connect(m_orderBookProcessor.get(), &OrderBookProcessor::resyncRequested,
+            this, [this]() { m_webSocket->reconnect(); });
+
+    // Runs on the client's processing thread; analytics reach the UI queued
+    m_webSocket->setFrameCallback([this](std::string_view frame, int64_t receiveTimeNs) {
+        processOrderBookData(frame, receiveTimeNs);
     });
 }
 
@@ -226,35 +241,19 @@ void MainWindow::onWebSocketError(const QString &error)
     QMessageBox::warning(this, "WebSocket Error", error);
 }
 
-void MainWindow::onOrderBookUpdated(const OrderBook& orderBook)
-{
-    // Update UI with new order book data
-    updateMetrics();
-}
-
-void MainWindow::onMarketImpactUpdated(double impact)
-{
-    m_expectedMarketImpact = impact;
-    updateMetrics();
-}
-
-void MainWindow::onSlippageUpdated(double slippage)
-{
-    m_expectedSlippage = slippage;
-    updateMetrics();
-}
-
-void MainWindow::onMakerTakerProportionUpdated(double proportion)
+void MainWindow::onAnalyticsUpdated(const BookAnalytics& analytics)
 {
-    m_makerTakerProportion = proportion;
+    m_expectedMarketImpact = analytics.marketImpact;
+    m_expectedSlippage = analytics.slippage;
+    m_makerTakerProportion = analytics.makerTakerProportion;
     updateMetrics();
 }
 
-void MainWindow::processOrderBookData(const nlohmann::json& data)
+void MainWindow::processOrderBookData(std::string_view frame, int64_t receiveTimeNs)
 {
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    m_orderBookProcessor->processOrderBook(data);
+    m_orderBookProcessor->processRawMessage(frame, receiveTimeNs);
     
     auto endTime = std::chrono::high_resolution_clock::now();
     m_lastProcessingTime = std::chrono::duration<double>(endTime - startTime).count();
@@ -273,7 +272,8 @@ void MainWindow::updateMetrics()
 
 void MainWindow::updatePerformanceMetrics()
 {
-    m_internalLatency = m_lastProcessingTime + m_lastUiUpdateTime;
+    FeedStats feed = m_webSocket->stats();
+    m_internalLatency = feed.meanHandoffNs * 1e-9 + m_lastProcessingTime + m_lastUiUpdateTime;
     // TODO: Update latency display in UI
 }
 
@@ -0,0 +1,109 @@
+/**
+ * @file Crc32.cpp
+ * @brief Implementation of the zlib-compatible CRC-32
+ *
+ * This file contains the table-driven slicing-by-8 implementation and the
+ * ARMv8 instruction path selected at compile time.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "utils/Crc32.h"
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace GoQuant {
+
+namespace {
+
+#if !defined(__ARM_FEATURE_CRC32)
+
+constexpr std::uint32_t POLYNOMIAL = 0xEDB88320u;
+
+/**
+ * @brief Lookup tables for slicing-by-8
+ *
+ * Table 0 is the classic byte-wise table; table k advances a byte that is
+ * followed by k further bytes, so eight bytes are folded with eight
+ * independent lookups instead of a serial chain of eight.
+ */
+struct Crc32Tables {
+    std::uint32_t table[8][256];
+
+    Crc32Tables() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (POLYNOMIAL & (0u - (crc & 1u)));
+            }
+            table[0][i] = crc;
+        }
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFFu];
+            }
+        }
+    }
+};
+
+const Crc32Tables& tables() {
+    static const Crc32Tables instance;
+    return instance;
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Computes or extends a CRC-32 (polynomial 0xEDB88320)
+ *
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Checksum of the preceding bytes; 0 to start a new checksum
+ * @return std::uint32_t Checksum of everything passed so far
+ */
+std::uint32_t crc32(const void* data, std::size_t length, std::uint32_t crc) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+#if defined(__ARM_FEATURE_CRC32)
+    for (; length >= 8; length -= 8, bytes += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    for (; length > 0; --length, ++bytes) {
+        crc = __crc32b(crc, *bytes);
+    }
+#else
+    const auto& t = tables().table;
+    for (; length >= 8; length -= 8, bytes += 8) {
+        std::uint32_t low;
+        std::uint32_t high;
+        std::memcpy(&low, bytes, sizeof(low));
+        std::memcpy(&high, bytes + 4, sizeof(high));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        low = __builtin_bswap32(low);
+        high = __builtin_bswap32(high);
+#endif
+        low ^= crc;
+        crc = t[7][low & 0xFFu] ^ t[6][(low >> 8) & 0xFFu] ^
+              t[5][(low >> 16) & 0xFFu] ^ t[4][low >> 24] ^
+              t[3][high & 0xFFu] ^ t[2][(high >> 8) & 0xFFu] ^
+              t[1][(high >> 16) & 0xFFu] ^ t[0][high >> 24];
+    }
+    for (; length > 0; --length, ++bytes) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *bytes) & 0xFFu];
+    }
+#endif
+
+    return ~crc;
+}
+
+} // namespace GoQuant
@@ -0,0 +1,185 @@
+/**
+ * @file WorkStealingPool.cpp
+ * @brief Implementation of the WorkStealingPool class
+ *
+ * This file contains task submission, the worker loop and the stealing
+ * order of the pool.
+ *
+ * @author GoQuant Team
+ * @version 1.0
+ * @date 2024
+ */
+
+#include "utils/WorkStealingPool.h"
+#include <algorithm>
+#include <utility>
+
+namespace GoQuant {
+
+namespace {
+
+/// Pool the current thread works for, if any
+thread_local const WorkStealingPool* t_pool = nullptr;
+
+/// Worker index of the current thread in t_pool
+thread_local std::size_t t_workerIndex = 0;
+
+} // namespace
+
+/**
+ * @brief Starts the worker threads
+ *
+ * @param threadCount Number of workers; 0 for one per hardware thread
+ */
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Runs the tasks still queued, then joins the workers
+ */
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Queues a task; safe from any thread, including pool workers
+ *
+ * The queued count changes under the deque's mutex together with the deque
+ * itself, so it never exceeds the tasks actually queued and a woken worker
+ * always finds one unless another took it first.
+ *
+ * @param task Task to run; an exception it throws is rethrown by wait()
+ */
+void WorkStealingPool::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_pending;
+    }
+
+    std::size_t index = t_pool == this
+        ? t_workerIndex
+        : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    Worker& worker = *m_workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+        m_queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Taking the mutex orders the notification after a sleeping worker's check
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wake.notify_one();
+}
+
+/**
+ * @brief Blocks until every submitted task has finished
+ *
+ * @throws The first exception thrown by a task since the last wait()
+ */
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_pending == 0; });
+    if (m_error) {
+        std::exception_ptr error = std::move(m_error);
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief Takes a task from worker @p self's deque or steals one
+ *
+ * Victims are tried in order starting after @p self, so concurrent thieves
+ * spread over different deques.
+ *
+ * @param self Index of the calling worker
+ * @param task Receives the task
+ * @return bool False if every deque was empty
+ */
+bool WorkStealingPool::takeTask(std::size_t self, Task& task) {
+    {
+        Worker& own = *m_workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < m_workers.size(); ++offset) {
+        Worker& victim = *m_workers[(self + offset) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Body of worker thread @p index
+ *
+ * Runs tasks while any deque has one and sleeps otherwise. Exits once the
+ * pool is stopping and nothing is left to run.
+ *
+ * @param index Worker index
+ */
+void WorkStealingPool::workerLoop(std::size_t index) {
+    t_pool = this;
+    t_workerIndex = index;
+
+    Task task;
+    for (;;) {
+        if (takeTask(index, task)) {
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (error && !m_error) {
+                m_error = error;
+            }
+            if (--m_pending == 0) {
+                m_idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stopping && m_queued.load(std::memory_order_relaxed) <= 0) {
+            return;
+        }
+        m_wake.wait(lock, [this]() {
+            return m_stopping || m_queued.load(std::memory_order_relaxed) > 0;
+        });
+    }
+}
+
+} // namespace GoQuant